@@ -0,0 +1,232 @@
+#!/usr/bin/env python3
+# Copyright 2024 Huawei Cloud Computing Technology Co., Ltd.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import json
+import struct
+import sys
+
+from argparse import ArgumentParser
+from typing import Any, Dict, List, Tuple
+
+# generic JSON type
+Json = Any
+
+MAGIC = b"JUSTBG\0\1"
+
+NULL = 0
+FALSE = 1
+TRUE = 2
+UNSIGNED = 3
+NEGATIVE = 4
+FLOAT = 5
+STRING = 6
+ARRAY = 7
+OBJECT = 8
+
+MIN_DIGEST_LENGTH = 40
+HEX_DIGITS = set("0123456789abcdef")
+
+
+def log(*args: str, **kwargs: Any) -> None:
+    print(*args, file=sys.stderr, **kwargs)
+
+
+def fail(s: str, exit_code: int = 1):
+    log(f"Error: {s}")
+    sys.exit(exit_code)
+
+
+def is_digest(s: str) -> bool:
+    return (len(s) >= MIN_DIGEST_LENGTH and len(s) % 2 == 0
+            and all(c in HEX_DIGITS for c in s))
+
+
+def write_varint(out: bytearray, value: int) -> None:
+    while value > 0x7f:
+        out.append((value & 0x7f) | 0x80)
+        value >>= 7
+    out.append(value)
+
+
+class Encoder:
+    def __init__(self) -> None:
+        self.index: Dict[str, int] = {}
+        self.table: List[bytes] = []
+        self.body = bytearray()
+
+    def string(self, s: str) -> None:
+        if is_digest(s):
+            raw = bytes.fromhex(s)
+            write_varint(self.body, (len(raw) << 1) | 1)
+            self.body.extend(raw)
+            return
+        if s not in self.index:
+            self.index[s] = len(self.table)
+            self.table.append(s.encode("utf-8"))
+        write_varint(self.body, self.index[s] << 1)
+
+    def value(self, v: Json) -> None:
+        if v is None:
+            self.body.append(NULL)
+        elif isinstance(v, bool):
+            self.body.append(TRUE if v else FALSE)
+        elif isinstance(v, int):
+            if v >= 0:
+                self.body.append(UNSIGNED)
+                write_varint(self.body, v)
+            else:
+                self.body.append(NEGATIVE)
+                write_varint(self.body, -(v + 1))
+        elif isinstance(v, float):
+            self.body.append(FLOAT)
+            self.body.extend(struct.pack("<d", v))
+        elif isinstance(v, str):
+            self.body.append(STRING)
+            self.string(v)
+        elif isinstance(v, list):
+            self.body.append(ARRAY)
+            write_varint(self.body, len(v))
+            for entry in v:
+                self.value(entry)
+        elif isinstance(v, dict):
+            self.body.append(OBJECT)
+            write_varint(self.body, len(v))
+            for key in sorted(v.keys()):
+                self.string(key)
+                self.value(v[key])
+        else:
+            fail("Unsupported value %r" % (v, ))
+
+    def finish(self) -> bytes:
+        out = bytearray(MAGIC)
+        out.extend(self.body)
+        table_offset = len(out)
+        write_varint(out, len(self.table))
+        for entry in self.table:
+            write_varint(out, len(entry))
+            out.extend(entry)
+        out.extend(struct.pack("<Q", table_offset))
+        return bytes(out)
+
+
+class Decoder:
+    def __init__(self, data: bytes) -> None:
+        if not data.startswith(MAGIC):
+            fail("Not a binary action graph")
+        if len(data) < len(MAGIC) + 8:
+            fail("Unexpected end of binary action graph")
+        table_end = len(data) - 8
+        table_offset: int = struct.unpack("<Q", data[table_end:])[0]
+        if not len(MAGIC) <= table_offset <= table_end:
+            fail("String table offset %d out of range" % (table_offset, ))
+        # read the string table, then restrict reading to the encoded value
+        self.data = data[:table_end]
+        self.pos = table_offset
+        self.table: List[str] = []
+        for _ in range(self.varint()):
+            length = self.varint()
+            self.table.append(self.take(length).decode("utf-8"))
+        if self.pos != table_end:
+            fail("Trailing data after string table")
+        self.data = data[:table_offset]
+        self.pos = len(MAGIC)
+
+    def take(self, n: int) -> bytes:
+        if self.pos + n > len(self.data):
+            fail("Unexpected end of binary action graph")
+        result = self.data[self.pos:self.pos + n]
+        self.pos += n
+        return result
+
+    def varint(self) -> int:
+        result = 0
+        shift = 0
+        while True:
+            byte = self.take(1)[0]
+            result |= (byte & 0x7f) << shift
+            if byte & 0x80 == 0:
+                return result
+            shift += 7
+
+    def string(self) -> str:
+        ref = self.varint()
+        if ref & 1:
+            return self.take(ref >> 1).hex()
+        if ref >> 1 >= len(self.table):
+            fail("String reference %d out of range" % (ref >> 1, ))
+        return self.table[ref >> 1]
+
+    def value(self) -> Json:
+        tag = self.take(1)[0]
+        if tag == NULL:
+            return None
+        if tag in [FALSE, TRUE]:
+            return tag == TRUE
+        if tag == UNSIGNED:
+            return self.varint()
+        if tag == NEGATIVE:
+            return -self.varint() - 1
+        if tag == FLOAT:
+            return cast_float(self.take(8))
+        if tag == STRING:
+            return self.string()
+        if tag == ARRAY:
+            return [self.value() for _ in range(self.varint())]
+        if tag == OBJECT:
+            result: Dict[str, Json] = {}
+            for _ in range(self.varint()):
+                key = self.string()
+                result[key] = self.value()
+            return result
+        fail("Unknown tag %d at offset %d" % (tag, self.pos - 1))
+
+    def finish(self) -> Json:
+        result = self.value()
+        if self.pos != len(self.data):
+            fail("Trailing data in binary action graph")
+        return result
+
+
+def cast_float(data: bytes) -> float:
+    value: Tuple[float] = struct.unpack("<d", data)
+    return value[0]
+
+
+def main():
+    parser = ArgumentParser(
+        description="Convert action graphs written by just between the JSON"
+        " and the compact binary format")
+    parser.add_argument("input",
+                        help="The action graph to convert; the format is"
+                        " detected from the content")
+    parser.add_argument("output", help="Where to write the converted graph")
+    args = parser.parse_args()
+
+    with open(args.input, "rb") as f:
+        data = f.read()
+    if data.startswith(MAGIC):
+        graph = Decoder(data).finish()
+        with open(args.output, "w", encoding="utf-8") as f:
+            json.dump(graph, f, indent=2, sort_keys=True, ensure_ascii=False)
+            f.write("\n")
+    else:
+        encoder = Encoder()
+        encoder.value(json.loads(data))
+        with open(args.output, "wb") as f:
+            f.write(encoder.finish())
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,295 @@
+// Copyright 2024 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_SRC_BUILDTOOL_BUILD_ENGINE_BASE_MAPS_ANALYSIS_PROFILE_HPP
+#define INCLUDED_SRC_BUILDTOOL_BUILD_ENGINE_BASE_MAPS_ANALYSIS_PROFILE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>  // std::move
+#include <vector>
+
+#include "fmt/core.h"
+#include "nlohmann/json.hpp"
+#include "src/buildtool/build_engine/expression/expression_ptr.hpp"
+
+namespace BuildMaps::Base {
+
+/// \brief Profile of the analysis. For every rule and expression function, the
+/// number of evaluations, their total time (including the time of nested
+/// evaluations), and the number of expression nodes allocated meanwhile are
+/// recorded; for every configured target, the time spent evaluating its rule.
+/// Counters are kept per thread and only merged for the report, which must not
+/// be requested while an analysis is running. Profiling is disabled by
+/// default.
+class AnalysisProfile {
+  public:
+    using clock = std::chrono::steady_clock;
+
+    enum class Kind : std::uint8_t { kRule, kExpression };
+
+    /// \brief What an evaluation is accounted to.
+    struct Subject {
+        Kind kind{};
+        std::string name{};
+    };
+
+    struct Counters {
+        std::size_t evaluations{};
+        clock::duration time{};
+        std::size_t nodes{};
+    };
+
+    /// \brief Records an evaluation from construction until destruction.
+    class ScopedEvaluation {
+      public:
+        explicit ScopedEvaluation(Subject const& subject) noexcept
+            : subject_{&subject},
+              nodes_{ExpressionPtr::AllocatedNodes()},
+              start_{clock::now()} {}
+        ScopedEvaluation(ScopedEvaluation const&) = delete;
+        ScopedEvaluation(ScopedEvaluation&&) = delete;
+        auto operator=(ScopedEvaluation const&) -> ScopedEvaluation& = delete;
+        auto operator=(ScopedEvaluation&&) -> ScopedEvaluation& = delete;
+        ~ScopedEvaluation() noexcept {
+            Instance().RecordEvaluation(
+                *subject_,
+                clock::now() - start_,
+                ExpressionPtr::AllocatedNodes() - nodes_);
+        }
+
+      private:
+        Subject const* subject_;
+        std::size_t nodes_;
+        clock::time_point start_;
+    };
+
+    /// \brief Records the time of a target from construction until
+    /// destruction.
+    class ScopedTarget {
+      public:
+        explicit ScopedTarget(std::string target) noexcept
+            : target_{std::move(target)}, start_{clock::now()} {}
+        ScopedTarget(ScopedTarget const&) = delete;
+        ScopedTarget(ScopedTarget&&) = delete;
+        auto operator=(ScopedTarget const&) -> ScopedTarget& = delete;
+        auto operator=(ScopedTarget&&) -> ScopedTarget& = delete;
+        ~ScopedTarget() noexcept {
+            Instance().RecordTarget(target_, clock::now() - start_);
+        }
+
+      private:
+        std::string target_;
+        clock::time_point start_;
+    };
+
+    [[nodiscard]] static auto Instance() noexcept -> AnalysisProfile& {
+        static AnalysisProfile instance{};
+        return instance;
+    }
+
+    void Enable() noexcept { enabled_ = true; }
+
+    /// \brief Disable profiling and drop everything recorded so far. Must not
+    /// be called while an analysis is running.
+    void Disable() noexcept {
+        enabled_ = false;
+        std::unique_lock lock{mutex_};
+        for (auto const& data : threads_) {
+            data->rules.clear();
+            data->expressions.clear();
+            data->targets.clear();
+        }
+    }
+
+    [[nodiscard]] auto IsEnabled() const noexcept -> bool { return enabled_; }
+
+    void RecordEvaluation(Subject const& subject,
+                          clock::duration time,
+                          std::size_t nodes) noexcept {
+        try {
+            auto& data = Local();
+            auto& counters = subject.kind == Kind::kRule
+                                 ? data.rules[subject.name]
+                                 : data.expressions[subject.name];
+            ++counters.evaluations;
+            counters.time += time;
+            counters.nodes += nodes;
+        } catch (...) {
+            // an incomplete profile is fine
+        }
+    }
+
+    void RecordTarget(std::string const& target,
+                      clock::duration time) noexcept {
+        try {
+            Local().targets[target] += time;
+        } catch (...) {
+            // an incomplete profile is fine
+        }
+    }
+
+    /// \brief The full profile, each part ranked by time.
+    [[nodiscard]] auto ToJson() const -> nlohmann::json {
+        auto merged = Merge();
+        auto counters_to_json = [](auto const& ranked, std::string const& key) {
+            auto result = nlohmann::json::array();
+            for (auto const* entry : ranked) {
+                result.push_back({{key, entry->first},
+                                  {"evaluations", entry->second.evaluations},
+                                  {"time", Seconds(entry->second.time)},
+                                  {"nodes", entry->second.nodes}});
+            }
+            return result;
+        };
+        auto targets = nlohmann::json::array();
+        for (auto const* entry : Ranked(merged.targets)) {
+            targets.push_back(
+                {{"target", entry->first}, {"time", Seconds(entry->second)}});
+        }
+        return nlohmann::json{
+            {"rules", counters_to_json(Ranked(merged.rules), "rule")},
+            {"expressions",
+             counters_to_json(Ranked(merged.expressions), "expression")},
+            {"targets", std::move(targets)}};
+    }
+
+    /// \brief Human-readable tables of the most expensive entries of each part
+    /// of the profile.
+    [[nodiscard]] auto ToTable(std::size_t max_rows) const -> std::string {
+        auto merged = Merge();
+        std::string table{};
+        auto add_counters = [&table, max_rows](auto const& ranked,
+                                               std::string const& title) {
+            table += fmt::format("{} by total evaluation time:\n", title);
+            table += fmt::format("  {:>10}  {:>11}  {:>12}  {}\n",
+                                 "time [s]",
+                                 "evaluations",
+                                 "nodes",
+                                 "name");
+            for (std::size_t i{}; i < ranked.size() and i < max_rows; ++i) {
+                auto const& [name, counters] = *ranked[i];
+                table += fmt::format("  {:>10.3f}  {:>11}  {:>12}  {}\n",
+                                     Seconds(counters.time),
+                                     counters.evaluations,
+                                     counters.nodes,
+                                     name);
+            }
+        };
+        add_counters(Ranked(merged.rules), "Rules");
+        add_counters(Ranked(merged.expressions), "Expressions");
+        table += "Targets by evaluation time:\n";
+        table += fmt::format("  {:>10}  {}\n", "time [s]", "target");
+        auto targets = Ranked(merged.targets);
+        for (std::size_t i{}; i < targets.size() and i < max_rows; ++i) {
+            table += fmt::format("  {:>10.3f}  {}\n",
+                                 Seconds(targets[i]->second),
+                                 targets[i]->first);
+        }
+        return table;
+    }
+
+  private:
+    struct Data {
+        std::unordered_map<std::string, Counters> rules{};
+        std::unordered_map<std::string, Counters> expressions{};
+        std::unordered_map<std::string, clock::duration> targets{};
+    };
+
+    std::atomic<bool> enabled_{false};
+    mutable std::mutex mutex_{};
+    std::vector<std::unique_ptr<Data>> threads_{};
+
+    // The data of the calling thread, registered on first use.
+    [[nodiscard]] auto Local() -> Data& {
+        thread_local Data* data{nullptr};
+        if (data == nullptr) {
+            std::unique_lock lock{mutex_};
+            data = threads_.emplace_back(std::make_unique<Data>()).get();
+        }
+        return *data;
+    }
+
+    [[nodiscard]] auto Merge() const -> Data {
+        Data merged{};
+        std::unique_lock lock{mutex_};
+        for (auto const& data : threads_) {
+            for (auto const& [name, counters] : data->rules) {
+                Add(&merged.rules[name], counters);
+            }
+            for (auto const& [name, counters] : data->expressions) {
+                Add(&merged.expressions[name], counters);
+            }
+            for (auto const& [target, time] : data->targets) {
+                merged.targets[target] += time;
+            }
+        }
+        return merged;
+    }
+
+    static void Add(Counters* sum, Counters const& counters) noexcept {
+        sum->evaluations += counters.evaluations;
+        sum->time += counters.time;
+        sum->nodes += counters.nodes;
+    }
+
+    [[nodiscard]] static auto Time(Counters const& counters) noexcept
+        -> clock::duration {
+        return counters.time;
+    }
+
+    [[nodiscard]] static auto Time(clock::duration time) noexcept
+        -> clock::duration {
+        return time;
+    }
+
+    template <class T>
+    using Entry = typename std::unordered_map<std::string, T>::value_type;
+
+    // Entries of the given map, most expensive first.
+    template <class T>
+    [[nodiscard]] static auto Ranked(
+        std::unordered_map<std::string, T> const& map)
+        -> std::vector<Entry<T> const*> {
+        std::vector<Entry<T> const*> ranked{};
+        ranked.reserve(map.size());
+        for (auto const& entry : map) {
+            ranked.emplace_back(&entry);
+        }
+        std::sort(
+            ranked.begin(), ranked.end(), [](auto const* a, auto const* b) {
+                auto time_a = Time(a->second);
+                auto time_b = Time(b->second);
+                return time_a != time_b ? time_a > time_b
+                                        : a->first < b->first;
+            });
+        return ranked;
+    }
+
+    [[nodiscard]] static auto Seconds(clock::duration time) noexcept
+        -> double {
+        return std::chrono::duration<double>(time).count();
+    }
+};
+
+}  // namespace BuildMaps::Base
+
+#endif  // INCLUDED_SRC_BUILDTOOL_BUILD_ENGINE_BASE_MAPS_ANALYSIS_PROFILE_HPP
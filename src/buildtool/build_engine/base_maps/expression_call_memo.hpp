@@ -0,0 +1,122 @@
+// Copyright 2024 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_SRC_BUILDTOOL_BUILD_ENGINE_BASE_MAPS_EXPRESSION_CALL_MEMO_HPP
+#define INCLUDED_SRC_BUILDTOOL_BUILD_ENGINE_BASE_MAPS_EXPRESSION_CALL_MEMO_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>  // std::move
+
+#include "src/buildtool/build_engine/expression/expression.hpp"
+
+namespace BuildMaps::Base {
+
+/// \brief Memo table for calls of pure expression functions, i.e., functions
+/// only using built-in constructs and calls of other pure functions. Results
+/// are keyed by the identifier of the called function and the hash of the
+/// environment pruned to the variables of that function. Memoisation is
+/// disabled by default; once enabled, results are cached up to the given total
+/// size.
+class ExpressionCallMemo {
+  public:
+    [[nodiscard]] static auto Instance() noexcept -> ExpressionCallMemo& {
+        static ExpressionCallMemo instance{};
+        return instance;
+    }
+
+    /// \brief Enable memoisation, caching results of at most the given total
+    /// size, as measured by their serialization, in bytes.
+    void Enable(std::size_t max_bytes) noexcept {
+        max_bytes_ = max_bytes;
+        enabled_ = true;
+    }
+
+    /// \brief Disable memoisation, dropping all cached results and
+    /// statistics.
+    void Disable() noexcept {
+        enabled_ = false;
+        std::unique_lock lock{mutex_};
+        cache_.clear();
+        bytes_ = 0;
+        hits_ = 0;
+        misses_ = 0;
+    }
+
+    [[nodiscard]] auto IsEnabled() const noexcept -> bool { return enabled_; }
+
+    [[nodiscard]] auto Lookup(std::size_t function_id,
+                              std::string const& env_hash) noexcept
+        -> std::optional<ExpressionPtr> {
+        {
+            std::unique_lock lock{mutex_};
+            auto fun_it = cache_.find(function_id);
+            if (fun_it != cache_.end()) {
+                auto it = fun_it->second.find(env_hash);
+                if (it != fun_it->second.end()) {
+                    ++hits_;
+                    return it->second;
+                }
+            }
+        }
+        ++misses_;
+        return std::nullopt;
+    }
+
+    void Store(std::size_t function_id,
+               std::string env_hash,
+               ExpressionPtr const& result) noexcept {
+        try {
+            auto size = env_hash.size() + result->ToString().size();
+            std::unique_lock lock{mutex_};
+            if (bytes_ + size > max_bytes_) {
+                return;
+            }
+            auto& entries = cache_[function_id];
+            if (entries.emplace(std::move(env_hash), result).second) {
+                bytes_ += size;
+            }
+        } catch (...) {
+            // not caching a result is always fine
+        }
+    }
+
+    [[nodiscard]] auto Hits() const noexcept -> std::size_t { return hits_; }
+    [[nodiscard]] auto Misses() const noexcept -> std::size_t {
+        return misses_;
+    }
+    [[nodiscard]] auto Bytes() const noexcept -> std::size_t {
+        std::unique_lock lock{mutex_};
+        return bytes_;
+    }
+
+  private:
+    std::atomic<bool> enabled_{false};
+    std::size_t max_bytes_{};
+    mutable std::mutex mutex_{};
+    std::unordered_map<std::size_t,
+                       std::unordered_map<std::string, ExpressionPtr>>
+        cache_{};
+    std::size_t bytes_{};
+    std::atomic<std::size_t> hits_{};
+    std::atomic<std::size_t> misses_{};
+};
+
+}  // namespace BuildMaps::Base
+
+#endif  // INCLUDED_SRC_BUILDTOOL_BUILD_ENGINE_BASE_MAPS_EXPRESSION_CALL_MEMO_HPP
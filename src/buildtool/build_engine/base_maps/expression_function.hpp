@@ -15,7 +15,11 @@
 #ifndef INCLUDED_SRC_BUILDTOOL_BUILD_ENGINE_BASE_MAPS_EXPRESSION_FUNCTION_HPP
 #define INCLUDED_SRC_BUILDTOOL_BUILD_ENGINE_BASE_MAPS_EXPRESSION_FUNCTION_HPP
 
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
 #include <memory>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <utility>  // std::move
@@ -23,6 +27,8 @@
 
 #include "fmt/core.h"
 #include "gsl/gsl"
+#include "src/buildtool/build_engine/base_maps/analysis_profile.hpp"
+#include "src/buildtool/build_engine/base_maps/expression_call_memo.hpp"
 #include "src/buildtool/build_engine/expression/configuration.hpp"
 #include "src/buildtool/build_engine/expression/evaluator.hpp"
 #include "src/buildtool/build_engine/expression/expression.hpp"
@@ -37,12 +43,19 @@ class ExpressionFunction {
     using Ptr = std::shared_ptr<ExpressionFunction>;
     using imports_t = std::unordered_map<std::string, gsl::not_null<Ptr>>;
 
-    ExpressionFunction(std::vector<std::string> vars,
-                       imports_t imports,
-                       ExpressionPtr expr) noexcept
+    ExpressionFunction(
+        std::vector<std::string> vars,
+        imports_t imports,
+        ExpressionPtr expr,
+        std::optional<AnalysisProfile::Subject> profile_subject =
+            std::nullopt) noexcept
         : vars_{std::move(vars)},
           imports_{std::move(imports)},
-          expr_{std::move(expr)} {}
+          expr_{std::move(expr)},
+          compiled_{Evaluator::CompiledExpression::Compile(expr_)},
+          pure_{IsPure(compiled_, imports_)},
+          id_{NextId()},
+          profile_subject_{std::move(profile_subject)} {}
 
     [[nodiscard]] auto Evaluate(
         Configuration const& env,
@@ -55,6 +68,10 @@ class ExpressionFunction {
             [](auto const& /*unused*/) { return std::string{}; },
         std::function<void(void)> const& note_user_context =
             []() noexcept -> void {}) const noexcept -> ExpressionPtr {
+        std::optional<AnalysisProfile::ScopedEvaluation> profile{};
+        if (profile_subject_ and AnalysisProfile::Instance().IsEnabled()) {
+            profile.emplace(*profile_subject_);
+        }
         try {  // try-catch to silence clang-tidy's bugprone-exception-escape,
                // only imports_caller can throw but it is not called here.
             auto imports_caller = [this, &functions, &annotate_object](
@@ -65,6 +82,16 @@ class ExpressionFunction {
                 auto const& name = name_expr->String();
                 auto it = imports_.find(name);
                 if (it != imports_.end()) {
+                    auto const* callee = &(*it->second);
+                    auto& memo = ExpressionCallMemo::Instance();
+                    std::optional<std::string> memo_key{};
+                    if (callee->pure_ and memo.IsEnabled()) {
+                        auto pruned = env.Prune(callee->vars_);
+                        memo_key = pruned.Expr()->ToHash();
+                        if (auto cached = memo.Lookup(callee->id_, *memo_key)) {
+                            return *std::move(cached);
+                        }
+                    }
                     std::stringstream ss{};
                     bool user_context = false;
                     auto result = it->second->Evaluate(
@@ -76,6 +103,10 @@ class ExpressionFunction {
 
                     );
                     if (result) {
+                        if (memo_key) {
+                            memo.Store(
+                                callee->id_, *std::move(memo_key), result);
+                        }
                         return result;
                     }
                     if (user_context) {
@@ -92,13 +123,21 @@ class ExpressionFunction {
                     fmt::format("Unknown expression '{}'.", name));
             };
             auto newenv = env.Prune(vars_);
-            return expr_.Evaluate(
-                newenv,
-                FunctionMap::MakePtr(
-                    functions, "CALL_EXPRESSION", imports_caller),
-                logger,
-                annotate_object,
-                note_user_context);
+            auto newfunctions = FunctionMap::MakePtr(
+                functions, "CALL_EXPRESSION", imports_caller);
+            if (compiled_) {
+                return Evaluator::EvaluateExpression(*compiled_,
+                                                     newenv,
+                                                     newfunctions,
+                                                     logger,
+                                                     annotate_object,
+                                                     note_user_context);
+            }
+            return expr_.Evaluate(newenv,
+                                  newfunctions,
+                                  logger,
+                                  annotate_object,
+                                  note_user_context);
         } catch (...) {
             EnsuresAudit(false);  // ensure that the try-block never throws
             return ExpressionPtr{nullptr};
@@ -115,6 +154,38 @@ class ExpressionFunction {
     std::vector<std::string> vars_{};
     imports_t imports_{};
     ExpressionPtr expr_{};
+    // Body with built-in dispatch resolved once, as it is evaluated for
+    // every target using it.
+    Evaluator::CompiledExpression::Ptr compiled_{};
+    // Whether the result only depends on the (pruned) environment, i.e., the
+    // body does not use any constructs provided by the caller.
+    bool pure_{};
+    // Process-wide unique identifier, used to key memoised calls.
+    std::size_t id_{};
+    // What evaluations are accounted to when profiling the analysis.
+    std::optional<AnalysisProfile::Subject> profile_subject_{};
+
+    [[nodiscard]] static auto NextId() noexcept -> std::size_t {
+        static std::atomic<std::size_t> next_id{};
+        return next_id++;
+    }
+
+    [[nodiscard]] static auto IsPure(
+        Evaluator::CompiledExpression::Ptr const& compiled,
+        imports_t const& imports) noexcept -> bool {
+        if (not compiled) {
+            return false;
+        }
+        for (auto const& construct : compiled->UnboundConstructs()) {
+            if (construct != "CALL_EXPRESSION") {
+                return false;
+            }
+        }
+        return std::all_of(
+            imports.begin(), imports.end(), [](auto const& entry) {
+                return entry.second->pure_;
+            });
+    }
 };
 
 using ExpressionFunctionPtr = ExpressionFunction::Ptr;
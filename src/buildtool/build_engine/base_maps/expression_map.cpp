@@ -47,8 +47,8 @@ auto CreateExpressionMap(
              subcaller = std::move(subcaller),
              id](auto json_values) {
                 auto const& target_ = id.GetNamedTarget();
-                auto func_it = json_values[0]->find(target_.name);
-                if (func_it == json_values[0]->end()) {
+                auto const* func_desc = json_values[0]->Find(target_.name);
+                if (func_desc == nullptr) {
                     (*logger)(fmt::format("Cannot find expression {}",
                                           EntityName(target_).ToString()),
                               true);
@@ -56,7 +56,7 @@ auto CreateExpressionMap(
                 }
 
                 auto reader = FieldReader::Create(
-                    func_it.value(), id, "expression", logger);
+                    *func_desc, id, "expression", logger);
                 if (not reader) {
                     return;
                 }
@@ -91,14 +91,20 @@ auto CreateExpressionMap(
                     [setter = std::move(setter),
                      vars = std::move(*vars),
                      names = std::move(names),
-                     expr = std::move(expr)](auto const& expr_funcs) {
+                     expr = std::move(expr),
+                     id](auto const& expr_funcs) {
                         auto imports = ExpressionFunction::imports_t{};
                         imports.reserve(expr_funcs.size());
                         for (std::size_t i{}; i < expr_funcs.size(); ++i) {
                             imports.emplace(names[i], *expr_funcs[i]);
                         }
                         (*setter)(std::make_shared<ExpressionFunction>(
-                            vars, imports, expr));
+                            vars,
+                            imports,
+                            expr,
+                            AnalysisProfile::Subject{
+                                AnalysisProfile::Kind::kExpression,
+                                id.ToString()}));
                     },
                     wrapped_logger);
             },
@@ -31,7 +31,7 @@
 
 namespace BuildMaps::Base {
 
-using ExpressionFileMap = AsyncMapConsumer<ModuleName, nlohmann::json>;
+using ExpressionFileMap = AsyncMapConsumer<ModuleName, LazyJsonObject>;
 
 constexpr auto CreateExpressionFileMap =
     CreateJsonFileMap<&RepositoryConfig::ExpressionRoot,
@@ -18,8 +18,13 @@
 #include <cstddef>
 #include <filesystem>
 #include <fstream>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <unordered_map>
 #include <utility>  // std::move
+#include <vector>
 
 #include "fmt/core.h"
 #include "gsl/gsl"
@@ -27,10 +32,14 @@
 #include "src/buildtool/build_engine/base_maps/module_name.hpp"
 #include "src/buildtool/common/repository_config.hpp"
 #include "src/buildtool/multithreading/async_map_consumer.hpp"
+#include "src/buildtool/multithreading/task_system.hpp"
+#include "src/utils/cpp/lazy_json.hpp"
 
 namespace BuildMaps::Base {
 
-using JsonFileMap = AsyncMapConsumer<ModuleName, nlohmann::json>;
+// JSON files are indexed when read; their entries are parsed only once looked
+// up, so that large files are cheap to read if only a few entries are used.
+using JsonFileMap = AsyncMapConsumer<ModuleName, LazyJsonObject>;
 
 // function pointer type for specifying which root to get from global config
 using RootGetter = auto (RepositoryConfig::*)(std::string const&) const
@@ -40,88 +49,199 @@ using RootGetter = auto (RepositoryConfig::*)(std::string const&) const
 using FileNameGetter = auto (RepositoryConfig::*)(std::string const&) const
                        -> std::string const*;
 
-template <RootGetter get_root, FileNameGetter get_name, bool kMandatory = true>
-auto CreateJsonFileMap(
+// function pointer type for determining the modules a JSON file refers to
+using ReferencedModulesGetter =
+    auto (*)(ModuleName const&,
+             LazyJsonObject const&,
+             gsl::not_null<const RepositoryConfig*> const&)
+        -> std::vector<ModuleName>;
+
+// Read and parse the JSON file of a module. Errors are reported to the logger
+// and result in std::nullopt.
+template <RootGetter get_root, FileNameGetter get_name, bool kMandatory>
+[[nodiscard]] auto ParseJsonFile(
     gsl::not_null<const RepositoryConfig*> const& repo_config,
-    std::size_t jobs) -> JsonFileMap {
-    auto json_file_reader = [repo_config](auto /* unused */,
-                                          auto setter,
-                                          auto logger,
-                                          auto /* unused */,
-                                          auto const& key) {
-        auto const* root = ((*repo_config).*get_root)(key.repository);
-
-        auto const* json_file_name = ((*repo_config).*get_name)(key.repository);
-        if (root == nullptr or json_file_name == nullptr) {
-            (*logger)(fmt::format("Cannot determine root or JSON file name for "
-                                  "repository {}.",
-                                  key.repository),
-                      true);
-            return;
+    ModuleName const& key,
+    AsyncMapConsumerLogger const& logger) -> std::optional<LazyJsonObject> {
+    auto const* root = ((*repo_config).*get_root)(key.repository);
+
+    auto const* json_file_name = ((*repo_config).*get_name)(key.repository);
+    if (root == nullptr or json_file_name == nullptr) {
+        logger(fmt::format("Cannot determine root or JSON file name for "
+                           "repository {}.",
+                           key.repository),
+               true);
+        return std::nullopt;
+    }
+    auto module = std::filesystem::path{key.module}.lexically_normal();
+    if (module.is_absolute() or *module.begin() == "..") {
+        logger(fmt::format("Modules have to live inside their "
+                           "repository, but found {}.",
+                           key.module),
+               true);
+        return std::nullopt;
+    }
+    auto json_file_path = module / *json_file_name;
+
+    if (root->IsAbsent()) {
+        std::string missing_root = "[unknown]";
+        auto absent_tree = root->GetAbsentTreeId();
+        if (absent_tree) {
+            missing_root = *absent_tree;
         }
-        auto module = std::filesystem::path{key.module}.lexically_normal();
-        if (module.is_absolute() or *module.begin() == "..") {
-            (*logger)(fmt::format("Modules have to live inside their "
-                                  "repository, but found {}.",
-                                  key.module),
-                      true);
-            return;
+        logger(fmt::format("Would have to read JSON file {} of absent root {}.",
+                           json_file_path.string(),
+                           missing_root),
+               true);
+        return std::nullopt;
+    }
+
+    if (not root->IsFile(json_file_path)) {
+        if constexpr (kMandatory) {
+            logger(fmt::format("JSON file {} does not exist.",
+                               json_file_path.string()),
+                   true);
+            return std::nullopt;
         }
-        auto json_file_path = module / *json_file_name;
+        else {
+            return LazyJsonObject{};
+        }
+    }
 
-        if (root->IsAbsent()) {
-            std::string missing_root = "[unknown]";
-            auto absent_tree = root->GetAbsentTreeId();
-            if (absent_tree) {
-                missing_root = *absent_tree;
-            }
-            (*logger)(fmt::format(
-                          "Would have to read JSON file {} of absent root {}.",
-                          json_file_path.string(),
-                          missing_root),
-                      true);
-            return;
+    auto file_content = root->ReadContent(json_file_path);
+    if (not file_content) {
+        logger(
+            fmt::format("cannot read JSON file {}.", json_file_path.string()),
+            true);
+        return std::nullopt;
+    }
+    std::optional<LazyJsonObject> json{};
+    try {
+        json = LazyJsonObject::Parse(*std::move(file_content));
+    } catch (std::exception const& e) {
+        logger(fmt::format("JSON file {} does not contain valid JSON:\n{}",
+                           json_file_path.string(),
+                           e.what()),
+               true);
+        return std::nullopt;
+    }
+    if (not json) {
+        logger(fmt::format("JSON in {} is not an object.",
+                           json_file_path.string()),
+               true);
+        return std::nullopt;
+    }
+    return json;
+}
+
+// JSON files read ahead of being requested. Each module is read ahead at most
+// once, and only if it was not requested before.
+class PrefetchedJsonFiles {
+  public:
+    // Claim a module for reading ahead; false if read or claimed before.
+    [[nodiscard]] auto Claim(ModuleName const& key) -> bool {
+        std::unique_lock lock{mutex_};
+        return entries_.try_emplace(key).second;
+    }
+
+    // Keep a JSON file read ahead, unless requested meanwhile.
+    void Store(ModuleName const& key, LazyJsonObject&& json) {
+        std::unique_lock lock{mutex_};
+        auto& entry = entries_[key];
+        if (not entry.requested) {
+            entry.json = std::move(json);
         }
+    }
 
-        if (not root->IsFile(json_file_path)) {
-            if constexpr (kMandatory) {
-                (*logger)(fmt::format("JSON file {} does not exist.",
-                                      json_file_path.string()),
-                          true);
-            }
-            else {
-                (*setter)(nlohmann::json::object());
+    // Mark a module as requested and take its JSON file, if read ahead.
+    [[nodiscard]] auto Take(ModuleName const& key)
+        -> std::optional<LazyJsonObject> {
+        std::unique_lock lock{mutex_};
+        auto& entry = entries_[key];
+        entry.requested = true;
+        return std::exchange(entry.json, std::nullopt);
+    }
+
+  private:
+    struct Entry {
+        bool requested{};
+        std::optional<LazyJsonObject> json{};
+    };
+    std::mutex mutex_;
+    std::unordered_map<ModuleName, Entry> entries_;
+};
+
+// Speculatively read the JSON files of the modules the given JSON file refers
+// to, so that reading and parsing overlaps with the evaluation of the file
+// given. Only files actually requested are scanned for references, so files
+// are read ahead one level deep only. Scanning is done in a task of its own,
+// not to delay the file given.
+template <RootGetter get_root,
+          FileNameGetter get_name,
+          bool kMandatory,
+          ReferencedModulesGetter get_references>
+void PrefetchReferencedJsonFiles(
+    gsl::not_null<TaskSystem*> const& ts,
+    gsl::not_null<const RepositoryConfig*> const& repo_config,
+    std::shared_ptr<PrefetchedJsonFiles> const& prefetched,
+    ModuleName const& key,
+    LazyJsonObject const& json) {
+    ts->QueueTask([ts, repo_config, prefetched, key, json]() {
+        for (auto& module : get_references(key, json, repo_config)) {
+            if (not prefetched->Claim(module)) {
+                continue;
             }
-            return;
+            ts->QueueTask(
+                [repo_config, prefetched, module = std::move(module)]() {
+                    // errors are reported once the file is actually requested
+                    auto json = ParseJsonFile<get_root, get_name, kMandatory>(
+                        repo_config,
+                        module,
+                        [](auto const& /*unused*/, bool /*unused*/) {});
+                    if (json) {
+                        prefetched->Store(module, *std::move(json));
+                    }
+                });
         }
+    });
+}
 
-        auto const file_content = root->ReadContent(json_file_path);
-        if (not file_content) {
-            (*logger)(fmt::format("cannot read JSON file {}.",
-                                  json_file_path.string()),
-                      true);
-            return;
+// Create the map of JSON files. If a getter for referenced modules is given,
+// the JSON files of referenced modules are read ahead.
+template <RootGetter get_root,
+          FileNameGetter get_name,
+          bool kMandatory = true,
+          ReferencedModulesGetter get_references = nullptr>
+auto CreateJsonFileMap(
+    gsl::not_null<const RepositoryConfig*> const& repo_config,
+    std::size_t jobs) -> JsonFileMap {
+    auto prefetched = std::make_shared<PrefetchedJsonFiles>();
+    auto json_file_reader = [repo_config, prefetched](auto ts,
+                                                      auto setter,
+                                                      auto logger,
+                                                      auto /* unused */,
+                                                      auto const& key) {
+        std::optional<LazyJsonObject> json{};
+        if constexpr (get_references != nullptr) {
+            json = prefetched->Take(key);
         }
-        auto json = nlohmann::json();
-        try {
-            json = nlohmann::json::parse(*file_content);
-        } catch (std::exception const& e) {
-            (*logger)(
-                fmt::format("JSON file {} does not contain valid JSON:\n{}",
-                            json_file_path.string(),
-                            e.what()),
-                true);
-            return;
+        if (not json) {
+            json = ParseJsonFile<get_root, get_name, kMandatory>(
+                repo_config, key, *logger);
+            if (not json) {
+                return;
+            }
         }
-        if (!json.is_object()) {
-            (*logger)(fmt::format("JSON in {} is not an object.",
-                                  json_file_path.string()),
-                      true);
-            return;
+        if constexpr (get_references != nullptr) {
+            PrefetchReferencedJsonFiles<get_root,
+                                        get_name,
+                                        kMandatory,
+                                        get_references>(
+                ts, repo_config, prefetched, key, *json);
         }
-        (*setter)(std::move(json));
+        (*setter)(*std::move(json));
     };
-    return AsyncMapConsumer<ModuleName, nlohmann::json>{json_file_reader, jobs};
+    return AsyncMapConsumer<ModuleName, LazyJsonObject>{json_file_reader, jobs};
 }
 
 }  // namespace BuildMaps::Base
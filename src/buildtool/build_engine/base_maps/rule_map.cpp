@@ -261,8 +261,8 @@ auto CreateRuleMap(gsl::not_null<RuleFileMap*> const& rule_file_map,
             [ts, expr_map, repo_config, setter = std::move(setter), logger, id](
                 auto json_values) {
                 const auto& target_ = id.GetNamedTarget();
-                auto rule_it = json_values[0]->find(target_.name);
-                if (rule_it == json_values[0]->end()) {
+                auto const* rule_desc = json_values[0]->Find(target_.name);
+                if (rule_desc == nullptr) {
                     (*logger)(
                         fmt::format("Cannot find rule {} in {}",
                                     nlohmann::json(target_.name).dump(),
@@ -272,7 +272,7 @@ auto CreateRuleMap(gsl::not_null<RuleFileMap*> const& rule_file_map,
                 }
 
                 auto reader =
-                    FieldReader::Create(rule_it.value(), id, "rule", logger);
+                    FieldReader::Create(*rule_desc, id, "rule", logger);
                 if (not reader) {
                     return;
                 }
@@ -299,13 +299,13 @@ auto CreateRuleMap(gsl::not_null<RuleFileMap*> const& rule_file_map,
                 }
 
                 auto implicit_targets = ReadImplicitObject(
-                    id, rule_it.value(), repo_config, logger);
+                    id, *rule_desc, repo_config, logger);
                 if (not implicit_targets) {
                     return;
                 }
 
                 auto anonymous_defs = ReadAnonymousObject(
-                    id, rule_it.value(), repo_config, logger);
+                    id, *rule_desc, repo_config, logger);
                 if (not anonymous_defs) {
                     return;
                 }
@@ -331,7 +331,7 @@ auto CreateRuleMap(gsl::not_null<RuleFileMap*> const& rule_file_map,
                     ts,
                     std::move(ids),
                     [id,
-                     json = rule_it.value(),
+                     json = *rule_desc,
                      expr = std::move(expr),
                      target_fields = std::move(*target_fields),
                      string_fields = std::move(*string_fields),
@@ -367,7 +367,10 @@ auto CreateRuleMap(gsl::not_null<RuleFileMap*> const& rule_file_map,
                             std::make_shared<ExpressionFunction>(
                                 std::move(config_vars),
                                 std::move(imports),
-                                std::move(expr)),
+                                std::move(expr),
+                                AnalysisProfile::Subject{
+                                    AnalysisProfile::Kind::kRule,
+                                    id.ToString()}),
                             [&logger](auto const& msg) {
                                 (*logger)(msg, true);
                             });
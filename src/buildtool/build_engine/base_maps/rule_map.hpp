@@ -31,7 +31,7 @@
 
 namespace BuildMaps::Base {
 
-using RuleFileMap = AsyncMapConsumer<ModuleName, nlohmann::json>;
+using RuleFileMap = AsyncMapConsumer<ModuleName, LazyJsonObject>;
 
 constexpr auto CreateRuleFileMap =
     CreateJsonFileMap<&RepositoryConfig::RuleRoot,
@@ -15,9 +15,11 @@
 #include "src/buildtool/build_engine/base_maps/source_map.hpp"
 
 #include <filesystem>
+#include <optional>
 #include <utility>  // std::move
 
 #include "nlohmann/json.hpp"
+#include "src/buildtool/common/artifact_description.hpp"
 #include "src/buildtool/common/artifact_digest.hpp"
 #include "src/buildtool/file_system/object_type.hpp"
 #include "src/buildtool/multithreading/async_map_consumer.hpp"
@@ -68,15 +70,11 @@ auto CreateSourceTargetMap(
         auto dir = (path(target.module) / name).parent_path();
         auto const* ws_root = repo_config->WorkspaceRoot(target.repository);
 
-        auto src_file_reader = [key, name, setter, logger, dir, ws_root](
-                                   bool exists_in_ws_root) {
-            if (ws_root != nullptr and exists_in_ws_root) {
-                if (auto desc = ws_root->ToArtifactDescription(
-                        path(key.GetNamedTarget().module) / name,
-                        key.GetNamedTarget().repository)) {
-                    (*setter)(as_target(key, ExpressionPtr{std::move(*desc)}));
-                    return;
-                }
+        auto src_file_reader = [key, setter, logger, dir](
+                                   std::optional<ArtifactDescription> desc) {
+            if (desc) {
+                (*setter)(as_target(key, ExpressionPtr{std::move(*desc)}));
+                return;
             }
             (*logger)(
                 fmt::format(
@@ -92,15 +90,20 @@ auto CreateSourceTargetMap(
 
         if (ws_root != nullptr and ws_root->HasFastDirectoryLookup()) {
             // by-pass directory map and directly attempt to read from ws_root
-            src_file_reader(ws_root->IsBlob(path(target.module) / name));
+            src_file_reader(ws_root->ToArtifactDescription(
+                path(target.module) / name, target.repository));
             return;
         }
         dirs->ConsumeAfterKeysReady(
             ts,
             {ModuleName{target.repository, dir.string()}},
-            [key, src_file_reader](auto values) {
-                src_file_reader(values[0]->ContainsBlob(
-                    path(key.GetNamedTarget().name).filename().string()));
+            [key, dir, src_file_reader](auto values) {
+                // the directory entries already know type and, for git
+                // roots, the blob id of the file
+                src_file_reader(values[0]->ToArtifactDescription(
+                    dir,
+                    path(key.GetNamedTarget().name).filename().string(),
+                    key.GetNamedTarget().repository));
             },
             [logger, dir](auto msg, auto fatal) {
                 (*logger)(
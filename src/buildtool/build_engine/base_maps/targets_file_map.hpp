@@ -17,20 +17,89 @@
 
 #include <filesystem>
 #include <string>
+#include <vector>
 
+#include "gsl/gsl"
 #include "nlohmann/json.hpp"
+#include "src/buildtool/build_engine/base_maps/entity_name.hpp"
 #include "src/buildtool/build_engine/base_maps/json_file_map.hpp"
 #include "src/buildtool/build_engine/base_maps/module_name.hpp"
+#include "src/buildtool/common/repository_config.hpp"
 #include "src/buildtool/multithreading/async_map_consumer.hpp"
+#include "src/utils/cpp/lazy_json.hpp"
 
 namespace BuildMaps::Base {
 
-using TargetsFileMap = AsyncMapConsumer<ModuleName, nlohmann::json>;
+using TargetsFileMap = AsyncMapConsumer<ModuleName, LazyJsonObject>;
 
+// Collect the module of the given entity name, if it is a target in another
+// module.
+inline void CollectReferencedModule(
+    nlohmann::json const& value,
+    EntityName const& current,
+    gsl::not_null<const RepositoryConfig*> const& repo_config,
+    gsl::not_null<std::vector<ModuleName>*> const& modules) {
+    if (auto name = ParseEntityNameFromJson(value, current, repo_config);
+        name and not name->IsAnonymousTarget() and
+        name->GetNamedTarget().reference_t == ReferenceType::kTarget) {
+        auto module = name->ToModule();
+        if (not(module == current.ToModule())) {
+            modules->emplace_back(std::move(module));
+        }
+    }
+}
+
+// Modules referred to by the targets defined in a targets file, found
+// syntactically, i.e., without evaluating any field. Only the fields that can
+// hold targets are considered: the "target" of export and configure targets,
+// and the entries of list-valued fields. Targets in the same module are given
+// as plain strings in lists, so only entries that are lists themselves are
+// taken as references to other modules. The file is read field by field,
+// without parsing the targets it defines.
+[[nodiscard]] inline auto TargetsFileReferencedModules(
+    ModuleName const& key,
+    LazyJsonObject const& targets_file,
+    gsl::not_null<const RepositoryConfig*> const& repo_config)
+    -> std::vector<ModuleName> {
+    std::vector<ModuleName> modules{};
+    auto const current = EntityName{key.repository, key.module, ""};
+    auto collect = [&current, &repo_config, &modules](
+                       std::vector<std::string> const& keys,
+                       nlohmann::json&& value) {
+        if (keys.size() != 2) {
+            return true;  // not a field of a target
+        }
+        auto const& field = keys[1];
+        if (field == "target") {
+            CollectReferencedModule(value, current, repo_config, &modules);
+        }
+        else if (field != "type" and value.is_array()) {
+            for (auto const& entry : value) {
+                if (entry.is_array()) {
+                    CollectReferencedModule(
+                        entry, current, repo_config, &modules);
+                }
+            }
+        }
+        return true;
+    };
+    try {
+        // the text was validated already, so reading cannot fail
+        [[maybe_unused]] auto complete =
+            ReadJsonMembers(targets_file.Text(), /*depth=*/2, collect);
+    } catch (...) {
+        return {};
+    }
+    return modules;
+}
+
+// Targets files are read ahead for the modules referred to in targets files
+// already read.
 constexpr auto CreateTargetsFileMap =
     CreateJsonFileMap<&RepositoryConfig::TargetRoot,
                       &RepositoryConfig::TargetFileName,
-                      /*kMandatory=*/true>;
+                      /*kMandatory=*/true,
+                      &TargetsFileReferencedModules>;
 
 }  // namespace BuildMaps::Base
 
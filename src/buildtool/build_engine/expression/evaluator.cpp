@@ -15,16 +15,25 @@
 #include "src/buildtool/build_engine/expression/evaluator.hpp"
 
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <exception>
 #include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>  // std::move
+#include <vector>
 
 #include "fmt/core.h"
+#include "gsl/gsl"
 #include "src/buildtool/build_engine/expression/configuration.hpp"
 #include "src/buildtool/build_engine/expression/function_map.hpp"
+#include "src/buildtool/multithreading/task_system.hpp"
 #include "src/utils/cpp/path.hpp"
 
 namespace {
@@ -797,6 +806,136 @@ auto ToSubdirExpr(SubExprEvaluator&& eval,
     return ExpressionPtr{Expression::map_t{result}};
 }
 
+// Set on the threads evaluating the bodies of a parallel foreach, so that
+// nested loops are evaluated sequentially.
+thread_local bool evaluating_in_parallel{false};
+
+// The effects of the element of a parallel foreach evaluated by this thread,
+// to be carried out once the loop is finished.
+thread_local std::vector<std::function<void()>>* deferred_effects{nullptr};
+
+// Pool of threads helping to evaluate parallel loops, shared by all loops.
+auto ForeachPool() -> TaskSystem& {
+    static TaskSystem pool{Evaluator::GetParallelForeachJobs()};
+    return pool;
+}
+
+// State of a loop evaluated in parallel. Helper tasks may only start once the
+// loop is finished, so they share ownership of it and no longer take part
+// once the loop is closed.
+class ParallelLoop {
+  public:
+    explicit ParallelLoop(std::size_t size)
+        : size_{size},
+          first_error_{size},
+          results_(size),
+          errors_(size),
+          effects_(size) {}
+
+    // Evaluate elements not yet claimed, until none is left or an element
+    // before the next one failed.
+    template <class EvalElement>
+    void Work(EvalElement const& eval_element) noexcept {
+        auto* previous_effects = deferred_effects;
+        evaluating_in_parallel = true;
+        for (auto i = next_++; i < size_ and i < first_error_; i = next_++) {
+            deferred_effects = &effects_[i];
+            try {
+                results_[i] = eval_element(i);
+            } catch (...) {
+                errors_[i] = std::current_exception();
+                auto current = first_error_.load();
+                while (i < current and
+                       not first_error_.compare_exchange_weak(current, i)) {
+                }
+            }
+        }
+        deferred_effects = previous_effects;
+        evaluating_in_parallel = false;
+    }
+
+    // Take part as helper, unless the loop is closed already.
+    [[nodiscard]] auto Enter() -> bool {
+        std::unique_lock lock{mutex_};
+        if (closed_) {
+            return false;
+        }
+        ++helpers_;
+        return true;
+    }
+
+    void Leave() {
+        std::unique_lock lock{mutex_};
+        --helpers_;
+        cv_.notify_all();
+    }
+
+    // Stop helpers from taking part and wait for those that do.
+    void Close() {
+        std::unique_lock lock{mutex_};
+        closed_ = true;
+        cv_.wait(lock, [this]() { return helpers_ == 0; });
+    }
+
+    // Carry out the effects of the elements in order, up to the first error,
+    // which is then rethrown.
+    [[nodiscard]] auto TakeResult() -> list_t {
+        for (std::size_t i{}; i < size_ and i <= first_error_; ++i) {
+            for (auto const& effect : effects_[i]) {
+                Evaluator::Effect(effect);
+            }
+        }
+        if (first_error_ < size_) {
+            std::rethrow_exception(errors_[first_error_]);
+        }
+        return std::move(results_);
+    }
+
+  private:
+    std::size_t size_;
+    std::atomic<std::size_t> next_{};
+    std::atomic<std::size_t> first_error_;
+    list_t results_;
+    std::vector<std::exception_ptr> errors_;
+    std::vector<std::vector<std::function<void()>>> effects_;
+    std::mutex mutex_{};
+    std::condition_variable cv_{};
+    bool closed_{};
+    std::size_t helpers_{};
+};
+
+// Evaluate the body of a loop for all elements of its range, given the
+// evaluation of the body for the element at a position. Large ranges are
+// evaluated in parallel, if enabled. As for sequential evaluation, the error
+// of the first failing element is reported, and only the effects of the
+// elements up to it are carried out.
+template <class EvalElement>
+auto EvaluateEach(std::size_t size, EvalElement const& eval_element)
+    -> list_t {
+    auto threshold = Evaluator::GetParallelForeachThreshold();
+    if (threshold == 0 or size < threshold or evaluating_in_parallel) {
+        auto result = list_t{};
+        result.reserve(size);
+        for (std::size_t i{}; i < size; ++i) {
+            result.emplace_back(eval_element(i));
+        }
+        return result;
+    }
+    auto loop = std::make_shared<ParallelLoop>(size);
+    auto& pool = ForeachPool();
+    for (std::size_t t{}; t < pool.NumberOfThreads(); ++t) {
+        pool.QueueTask([loop, &eval_element]() {
+            if (loop->Enter()) {
+                loop->Work(eval_element);
+                loop->Leave();
+            }
+        });
+    }
+    loop->Work(eval_element);
+    loop->Close();
+    return loop->TakeResult();
+}
+
 auto ForeachExpr(SubExprEvaluator&& eval,
                  ExpressionPtr const& expr,
                  Configuration const& env) -> ExpressionPtr {
@@ -806,15 +945,11 @@ auto ForeachExpr(SubExprEvaluator&& eval,
     }
     auto const& var = expr->Get("var", "_"s);
     auto const& body = expr->Get("body", list_t{});
-    auto result = Expression::list_t{};
-    result.reserve(range_list->List().size());
-    std::transform(range_list->List().begin(),
-                   range_list->List().end(),
-                   std::back_inserter(result),
-                   [&](auto const& x) {
-                       return eval(body, env.Update(var->String(), x));
-                   });
-    return ExpressionPtr{result};
+    auto const& range = range_list->List();
+    return ExpressionPtr{
+        EvaluateEach(range.size(), [&](std::size_t i) {
+            return eval(body, env.Update(var->String(), range[i]));
+        })};
 }
 
 auto ForeachMapExpr(SubExprEvaluator&& eval,
@@ -827,17 +962,14 @@ auto ForeachMapExpr(SubExprEvaluator&& eval,
     auto const& var = expr->Get("var_key", "_"s);
     auto const& var_val = expr->Get("var_val", "$_"s);
     auto const& body = expr->Get("body", list_t{});
-    auto result = Expression::list_t{};
-    result.reserve(range_map->Map().size());
-    std::transform(range_map->Map().begin(),
-                   range_map->Map().end(),
-                   std::back_inserter(result),
-                   [&](auto const& it) {
-                       return eval(body,
-                                   env.Update(var->String(), it.first)
-                                       .Update(var_val->String(), it.second));
-                   });
-    return ExpressionPtr{result};
+    auto const& items = range_map->Map().Items();
+    return ExpressionPtr{
+        EvaluateEach(items.size(), [&](std::size_t i) {
+            auto const& [key, value] = items[i];
+            return eval(body,
+                        env.Update(var->String(), key)
+                            .Update(var_val->String(), value));
+        })};
 }
 
 auto FoldLeftExpr(SubExprEvaluator&& eval,
@@ -1087,52 +1219,99 @@ auto AssertNonEmptyExpr(SubExprEvaluator&& eval,
     throw Evaluator::EvaluationError(ss.str(), false, true);
 }
 
-auto const kBuiltInFunctions =
-    FunctionMap::MakePtr({{"var", VarExpr},
-                          {"if", IfExpr},
-                          {"cond", CondExpr},
-                          {"case", CaseExpr},
-                          {"case*", SeqCaseExpr},
-                          {"fail", FailExpr},
-                          {"assert", AssertExpr},
-                          {"assert_non_empty", AssertNonEmptyExpr},
-                          {"context", ContextExpr},
-                          {"==", EqualExpr},
-                          {"and", AndExpr},
-                          {"or", OrExpr},
-                          {"not", UnaryExpr(Not)},
-                          {"++", UnaryExpr(Flatten)},
-                          {"+", UnaryExpr(Addition)},
-                          {"*", UnaryExpr(Multiplication)},
-                          {"nub_right", UnaryExpr(NubRight)},
-                          {"range", UnaryExpr(Range)},
-                          {"change_ending", ChangeEndingExpr},
-                          {"basename", UnaryExpr(BaseName)},
-                          {"join", JoinExpr},
-                          {"join_cmd", JoinCmdExpr},
-                          {"json_encode", JsonEncodeExpr},
-                          {"escape_chars", EscapeCharsExpr},
-                          {"keys", UnaryExpr(Keys)},
-                          {"enumerate", UnaryExpr(Enumerate)},
-                          {"set", UnaryExpr(Set)},
-                          {"reverse", UnaryExpr(Reverse)},
-                          {"length", UnaryExpr(Length)},
-                          {"values", UnaryExpr(Values)},
-                          {"lookup", LookupExpr},
-                          {"[]", ArrayAccessExpr},
-                          {"empty_map", EmptyMapExpr},
-                          {"singleton_map", SingletonMapExpr},
-                          {"disjoint_map_union", DisjointUnionExpr},
-                          {"map_union", UnaryExpr([](auto const& exp) {
-                               return Union</*kDisjoint=*/false>(exp);
-                           })},
-                          {"to_subdir", ToSubdirExpr},
-                          {"foreach", ForeachExpr},
-                          {"foreach_map", ForeachMapExpr},
-                          {"foldl", FoldLeftExpr},
-                          {"let*", LetExpr},
-                          {"env", EnvExpr},
-                          {"concat_target_name", ConcatTargetNameExpr}});
+// Function-local, as compiled expressions may be created during static
+// initialization of other translation units.
+auto BuiltInFunctions() -> FunctionMapPtr const& {
+    static auto const kBuiltInFunctions =
+        FunctionMap::MakePtr({{"var", VarExpr},
+                              {"if", IfExpr},
+                              {"cond", CondExpr},
+                              {"case", CaseExpr},
+                              {"case*", SeqCaseExpr},
+                              {"fail", FailExpr},
+                              {"assert", AssertExpr},
+                              {"assert_non_empty", AssertNonEmptyExpr},
+                              {"context", ContextExpr},
+                              {"==", EqualExpr},
+                              {"and", AndExpr},
+                              {"or", OrExpr},
+                              {"not", UnaryExpr(Not)},
+                              {"++", UnaryExpr(Flatten)},
+                              {"+", UnaryExpr(Addition)},
+                              {"*", UnaryExpr(Multiplication)},
+                              {"nub_right", UnaryExpr(NubRight)},
+                              {"range", UnaryExpr(Range)},
+                              {"change_ending", ChangeEndingExpr},
+                              {"basename", UnaryExpr(BaseName)},
+                              {"join", JoinExpr},
+                              {"join_cmd", JoinCmdExpr},
+                              {"json_encode", JsonEncodeExpr},
+                              {"escape_chars", EscapeCharsExpr},
+                              {"keys", UnaryExpr(Keys)},
+                              {"enumerate", UnaryExpr(Enumerate)},
+                              {"set", UnaryExpr(Set)},
+                              {"reverse", UnaryExpr(Reverse)},
+                              {"length", UnaryExpr(Length)},
+                              {"values", UnaryExpr(Values)},
+                              {"lookup", LookupExpr},
+                              {"[]", ArrayAccessExpr},
+                              {"empty_map", EmptyMapExpr},
+                              {"singleton_map", SingletonMapExpr},
+                              {"disjoint_map_union", DisjointUnionExpr},
+                              {"map_union", UnaryExpr([](auto const& exp) {
+                                   return Union</*kDisjoint=*/false>(exp);
+                               })},
+                              {"to_subdir", ToSubdirExpr},
+                              {"foreach", ForeachExpr},
+                              {"foreach_map", ForeachMapExpr},
+                              {"foldl", FoldLeftExpr},
+                              {"let*", LetExpr},
+                              {"env", EnvExpr},
+                              {"concat_target_name", ConcatTargetNameExpr}});
+    return kBuiltInFunctions;
+}
+
+using dispatch_t =
+    std::unordered_map<Expression const*,
+                       Evaluator::CompiledExpression::function_t const*>;
+
+// Bind all nodes of the tree naming a built-in function to that function,
+// collecting the names bound; collect the names of all other constructs.
+// NOLINTNEXTLINE(misc-no-recursion)
+void BindBuiltIns(ExpressionPtr const& expr,
+                  gsl::not_null<std::unordered_set<Expression const*>*> const&
+                      visited,
+                  gsl::not_null<dispatch_t*> const& dispatch,
+                  gsl::not_null<std::unordered_set<std::string>*> const& bound,
+                  gsl::not_null<std::unordered_set<std::string>*> const&
+                      unbound) {
+    if (not visited->emplace(&(*expr)).second) {
+        return;
+    }
+    if (expr->IsList()) {
+        for (auto const& entry : expr->List()) {
+            BindBuiltIns(entry, visited, dispatch, bound, unbound);
+        }
+        return;
+    }
+    if (not expr->IsMap()) {
+        return;
+    }
+    auto const type = expr->Map().Find("type");
+    if (type and (**type)->IsString()) {
+        auto const func = BuiltInFunctions()->Find((**type)->String());
+        if (func) {
+            dispatch->emplace(&(*expr), *func);
+            bound->emplace((**type)->String());
+        }
+        else {
+            unbound->emplace((**type)->String());
+        }
+    }
+    for (auto const& [key, value] : expr->Map()) {
+        BindBuiltIns(value, visited, dispatch, bound, unbound);
+    }
+}
 
 auto ExtendedErrorMessage(ExpressionPtr const& expr,
                           Configuration const& env,
@@ -1193,6 +1372,42 @@ auto Evaluator::EvaluationError::WhileEval(const std::string& where,
     return EvaluationError{ss.str(), true, false, ex.InvolvedObjects()};
 }
 
+auto Evaluator::CompiledExpression::Compile(ExpressionPtr const& expr) noexcept
+    -> Ptr {
+    try {
+        auto compiled = std::make_shared<CompiledExpression>();
+        compiled->expr_ = expr;
+        std::unordered_set<Expression const*> visited{};
+        BindBuiltIns(expr,
+                     &visited,
+                     &compiled->dispatch_,
+                     &compiled->bound_,
+                     &compiled->unbound_);
+        return compiled;
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+auto Evaluator::CompiledExpression::IsShadowedBy(
+    FunctionMapPtr const& provider_functions) const -> bool {
+    if (not provider_functions.IsNotNull()) {
+        return false;
+    }
+    return std::any_of(
+        bound_.begin(), bound_.end(), [&provider_functions](auto const& name) {
+            return provider_functions->Find(name).has_value();
+        });
+}
+
+void Evaluator::Effect(std::function<void()> const& effect) {
+    if (deferred_effects != nullptr) {
+        deferred_effects->emplace_back(effect);
+        return;
+    }
+    effect();
+}
+
 auto Evaluator::EvaluateExpression(
     ExpressionPtr const& expr,
     Configuration const& env,
@@ -1201,12 +1416,52 @@ auto Evaluator::EvaluateExpression(
     std::function<std::string(ExpressionPtr)> const& annotate_object,
     std::function<void(void)> const& note_user_context) noexcept
     -> ExpressionPtr {
+    return EvaluateTopLevel(expr,
+                            nullptr,
+                            env,
+                            provider_functions,
+                            logger,
+                            annotate_object,
+                            note_user_context);
+}
+
+auto Evaluator::EvaluateExpression(
+    CompiledExpression const& compiled,
+    Configuration const& env,
+    FunctionMapPtr const& provider_functions,
+    std::function<void(std::string const&)> const& logger,
+    std::function<std::string(ExpressionPtr)> const& annotate_object,
+    std::function<void(void)> const& note_user_context) noexcept
+    -> ExpressionPtr {
+    return EvaluateTopLevel(compiled.Expr(),
+                            &compiled,
+                            env,
+                            provider_functions,
+                            logger,
+                            annotate_object,
+                            note_user_context);
+}
+
+auto Evaluator::EvaluateTopLevel(
+    ExpressionPtr const& expr,
+    CompiledExpression const* compiled,
+    Configuration const& env,
+    FunctionMapPtr const& provider_functions,
+    std::function<void(std::string const&)> const& logger,
+    std::function<std::string(ExpressionPtr)> const& annotate_object,
+    std::function<void(void)> const& note_user_context) noexcept
+    -> ExpressionPtr {
     std::stringstream ss{};
     try {
+        if (compiled != nullptr and
+            compiled->IsShadowedBy(provider_functions)) {
+            compiled = nullptr;
+        }
         return Evaluate(
             expr,
             env,
-            FunctionMap::MakePtr(kBuiltInFunctions, provider_functions));
+            FunctionMap::MakePtr(BuiltInFunctions(), provider_functions),
+            compiled);
     } catch (EvaluationError const& ex) {
         if (ex.UserContext()) {
             try {
@@ -1239,7 +1494,8 @@ auto Evaluator::EvaluateExpression(
 // NOLINTNEXTLINE(misc-no-recursion)
 auto Evaluator::Evaluate(ExpressionPtr const& expr,
                          Configuration const& env,
-                         FunctionMapPtr const& functions) -> ExpressionPtr {
+                         FunctionMapPtr const& functions,
+                         CompiledExpression const* compiled) -> ExpressionPtr {
     try {
         if (expr->IsList()) {
             if (expr->List().empty()) {
@@ -1251,12 +1507,25 @@ auto Evaluator::Evaluate(ExpressionPtr const& expr,
                 expr->List().cend(),
                 std::back_inserter(list),
                 // NOLINTNEXTLINE(misc-no-recursion)
-                [&](auto const& e) { return Evaluate(e, env, functions); });
+                [&](auto const& e) {
+                    return Evaluate(e, env, functions, compiled);
+                });
             return ExpressionPtr{list};
         }
         if (not expr->IsMap()) {
             return expr;
         }
+        // NOLINTNEXTLINE(misc-no-recursion)
+        auto sub_eval = [&functions, compiled](auto const& subexpr,
+                                               auto const& subenv) {
+            return Evaluator::Evaluate(subexpr, subenv, functions, compiled);
+        };
+        if (compiled != nullptr) {
+            auto const* builtin = compiled->Lookup(&(*expr));
+            if (builtin != nullptr) {
+                return (*builtin)(sub_eval, expr, env);
+            }
+        }
         if (not expr->Map().contains("type")) {
             throw EvaluationError{fmt::format(
                 "Object without keyword 'type': {}", expr->ToString())};
@@ -1264,12 +1533,7 @@ auto Evaluator::Evaluate(ExpressionPtr const& expr,
         auto const& type = expr["type"]->String();
         auto func = functions->Find(type);
         if (func) {
-            return (**func)(
-                [&functions](auto const& subexpr, auto const& subenv) {
-                    return Evaluator::Evaluate(subexpr, subenv, functions);
-                },
-                expr,
-                env);
+            return (**func)(sub_eval, expr, env);
         }
         throw EvaluationError{
             fmt::format("Unknown syntactical construct {}", type)};
@@ -17,7 +17,11 @@
 
 #include <cstddef>
 #include <exception>
+#include <functional>
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -29,6 +33,8 @@ class Configuration;
 class Evaluator {
     struct ConfigData {
         std::size_t expression_log_limit{kDefaultExpressionLogLimit};
+        std::size_t parallel_foreach_threshold{};
+        std::size_t parallel_foreach_jobs{};
     };
 
   public:
@@ -42,6 +48,33 @@ class Evaluator {
         return Config().expression_log_limit;
     }
 
+    /// \brief Evaluate the bodies of foreach and foreach_map in parallel,
+    /// if the range has at least the given number of elements. The elements
+    /// are evaluated by the calling thread together with a pool of the given
+    /// number of threads, shared by all loops and created on first use.
+    /// Functions provided by the caller therefore have to be thread safe and
+    /// carry out their side effects via \ref Effect. Results, side effects,
+    /// and errors are the same as for sequential evaluation. A threshold of 0
+    /// disables parallel evaluation, which is the default.
+    static void SetParallelForeach(std::size_t threshold, std::size_t jobs) {
+        Config().parallel_foreach_threshold = threshold;
+        Config().parallel_foreach_jobs = jobs;
+    }
+
+    static auto GetParallelForeachThreshold() -> std::size_t {
+        return Config().parallel_foreach_threshold;
+    }
+
+    static auto GetParallelForeachJobs() -> std::size_t {
+        return Config().parallel_foreach_jobs;
+    }
+
+    /// \brief Carry out a side effect of a function provided to the
+    /// evaluation, e.g., recording an action. Within the body of a loop
+    /// evaluated in parallel, the effects of each element are carried out
+    /// once the loop is finished, in the order of the elements.
+    static void Effect(std::function<void()> const& effect);
+
     class EvaluationError : public std::exception {
       public:
         explicit EvaluationError(std::string const& msg,
@@ -100,6 +133,58 @@ class Evaluator {
         std::vector<ExpressionPtr> involved_objects_;
     };
 
+    /// \brief Expression with the dispatch of its built-in constructs
+    /// resolved ahead of evaluation. Every node of the tree whose "type" names
+    /// a built-in function is bound to that function once, so that evaluating
+    /// the same tree again (e.g., a rule body for many targets) does not need
+    /// to look up the name in the chain of function maps. All other nodes are
+    /// dispatched by name at evaluation time. As provider functions shadow
+    /// built-in ones, the compiled dispatch is only used if none of the bound
+    /// names is provided.
+    class CompiledExpression {
+      public:
+        using Ptr = std::shared_ptr<CompiledExpression const>;
+        using function_t = FunctionMap::underlying_map_t::mapped_type;
+
+        /// \brief Resolve the built-in constructs of an expression tree.
+        /// Returns nullptr on failure, in which case the expression should
+        /// be evaluated directly.
+        [[nodiscard]] static auto Compile(ExpressionPtr const& expr) noexcept
+            -> Ptr;
+
+        [[nodiscard]] auto Expr() const& noexcept -> ExpressionPtr const& {
+            return expr_;
+        }
+
+        /// \brief The built-in function a node of the compiled tree was bound
+        /// to, or nullptr if the node has to be dispatched by name.
+        [[nodiscard]] auto Lookup(Expression const* node) const noexcept
+            -> function_t const* {
+            auto it = dispatch_.find(node);
+            return it != dispatch_.end() ? it->second : nullptr;
+        }
+
+        /// \brief Names of the constructs occurring in the tree that are not
+        /// built in, i.e., have to be provided at evaluation time.
+        [[nodiscard]] auto UnboundConstructs() const& noexcept
+            -> std::unordered_set<std::string> const& {
+            return unbound_;
+        }
+
+        /// \brief Whether any of the built-in constructs the tree is bound to
+        /// is shadowed by the given provider functions.
+        [[nodiscard]] auto IsShadowedBy(
+            FunctionMapPtr const& provider_functions) const -> bool;
+
+      private:
+        // The root keeps all nodes of the tree, and hence the keys of the
+        // dispatch table, alive.
+        ExpressionPtr expr_{};
+        std::unordered_map<Expression const*, function_t const*> dispatch_{};
+        std::unordered_set<std::string> bound_{};
+        std::unordered_set<std::string> unbound_{};
+    };
+
     // Exception-free evaluation of expression
     [[nodiscard]] static auto EvaluateExpression(
         ExpressionPtr const& expr,
@@ -111,12 +196,33 @@ class Evaluator {
         std::function<void(void)> const& note_user_context = []() {}) noexcept
         -> ExpressionPtr;
 
+    // Exception-free evaluation of a compiled expression
+    [[nodiscard]] static auto EvaluateExpression(
+        CompiledExpression const& compiled,
+        Configuration const& env,
+        FunctionMapPtr const& provider_functions,
+        std::function<void(std::string const&)> const& logger,
+        std::function<std::string(ExpressionPtr)> const& annotate_object =
+            [](auto const& /*unused*/) { return std::string{}; },
+        std::function<void(void)> const& note_user_context = []() {}) noexcept
+        -> ExpressionPtr;
+
     constexpr static std::size_t kDefaultExpressionLogLimit = 320;
 
   private:
+    [[nodiscard]] static auto EvaluateTopLevel(
+        ExpressionPtr const& expr,
+        CompiledExpression const* compiled,
+        Configuration const& env,
+        FunctionMapPtr const& provider_functions,
+        std::function<void(std::string const&)> const& logger,
+        std::function<std::string(ExpressionPtr)> const& annotate_object,
+        std::function<void(void)> const& note_user_context) noexcept
+        -> ExpressionPtr;
     [[nodiscard]] static auto Evaluate(ExpressionPtr const& expr,
                                        Configuration const& env,
-                                       FunctionMapPtr const& functions)
+                                       FunctionMapPtr const& functions,
+                                       CompiledExpression const* compiled)
         -> ExpressionPtr;
     [[nodiscard]] static auto Config() noexcept -> ConfigData& {
         static ConfigData instance{};
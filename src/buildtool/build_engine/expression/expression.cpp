@@ -15,17 +15,22 @@
 #include "src/buildtool/build_engine/expression/expression.hpp"
 
 #include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <exception>
 #include <optional>
 #include <sstream>
 #include <string>
 #include <type_traits>
+#include <utility>  // std::move
+#include <vector>
 
 #include "fmt/core.h"
 #include "gsl/gsl"
 #include "src/buildtool/build_engine/expression/evaluator.hpp"
 #include "src/buildtool/logging/logger.hpp"
 #include "src/utils/cpp/gsl.hpp"
+#include "src/utils/cpp/hash_combine.hpp"
 #include "src/utils/cpp/json.hpp"
 
 auto Expression::operator[](
@@ -216,6 +221,118 @@ auto Expression::FromJson(nlohmann::json const& json) noexcept
     return ExpressionPtr{nullptr};
 }
 
+namespace {
+
+/// \brief SAX handler for nlohmann::json::sax_parse, building an expression
+/// directly while parsing. Semantics are the ones of Expression::FromJson
+/// applied to the parsed JSON value; in particular, all numbers are stored as
+/// floating-point values and the last of duplicate keys takes precedence.
+class ExpressionBuilder {
+  public:
+    using number_integer_t = nlohmann::json::number_integer_t;
+    using number_unsigned_t = nlohmann::json::number_unsigned_t;
+    using number_float_t = nlohmann::json::number_float_t;
+    using string_t = nlohmann::json::string_t;
+    using binary_t = nlohmann::json::binary_t;
+
+    [[nodiscard]] auto null() -> bool {
+        return Add(ExpressionPtr{Expression::none_t{}});
+    }
+    [[nodiscard]] auto boolean(bool val) -> bool {
+        return Add(ExpressionPtr{val});
+    }
+    [[nodiscard]] auto number_integer(number_integer_t val) -> bool {
+        return Add(ExpressionPtr{static_cast<Expression::number_t>(val)});
+    }
+    [[nodiscard]] auto number_unsigned(number_unsigned_t val) -> bool {
+        return Add(ExpressionPtr{static_cast<Expression::number_t>(val)});
+    }
+    [[nodiscard]] auto number_float(number_float_t val,
+                                    string_t const& /*unused*/) -> bool {
+        return Add(ExpressionPtr{static_cast<Expression::number_t>(val)});
+    }
+    [[nodiscard]] auto string(string_t& val) -> bool {
+        return Add(ExpressionPtr{std::move(val)});
+    }
+    [[nodiscard]] static auto binary(binary_t& /*unused*/) -> bool {
+        return false;  // not part of JSON text
+    }
+    [[nodiscard]] auto start_object(std::size_t /*unused*/) -> bool {
+        stack_.emplace_back(/*is_map=*/true);
+        return true;
+    }
+    [[nodiscard]] auto key(string_t& val) -> bool {
+        stack_.back().key = std::move(val);
+        return true;
+    }
+    [[nodiscard]] auto end_object() -> bool {
+        auto map = std::move(stack_.back().map);
+        stack_.pop_back();
+        return Add(ExpressionPtr{Expression::map_t{std::move(map)}});
+    }
+    [[nodiscard]] auto start_array(std::size_t /*unused*/) -> bool {
+        stack_.emplace_back(/*is_map=*/false);
+        return true;
+    }
+    [[nodiscard]] auto end_array() -> bool {
+        auto list = std::move(stack_.back().list);
+        stack_.pop_back();
+        return Add(ExpressionPtr{std::move(list)});
+    }
+    template <class Exception>
+    [[nodiscard]] static auto parse_error(std::size_t /*unused*/,
+                                          std::string const& /*unused*/,
+                                          Exception const& ex) -> bool {
+        throw ex;
+    }
+
+    [[nodiscard]] auto Result() && -> ExpressionPtr {
+        return std::move(result_);
+    }
+
+  private:
+    struct Frame {
+        explicit Frame(bool is_map) : is_map{is_map} {}
+        bool is_map;
+        Expression::list_t list{};
+        Expression::map_t::underlying_map_t map{};
+        std::string key{};
+    };
+
+    std::vector<Frame> stack_{};
+    ExpressionPtr result_{nullptr};
+
+    [[nodiscard]] auto Add(ExpressionPtr&& val) -> bool {
+        if (stack_.empty()) {
+            result_ = std::move(val);
+        }
+        else if (auto& top = stack_.back(); top.is_map) {
+            top.map.insert_or_assign(std::move(top.key), std::move(val));
+        }
+        else {
+            top.list.emplace_back(std::move(val));
+        }
+        return true;
+    }
+};
+
+template <class T>
+[[nodiscard]] auto ParseJsonInput(T&& input) -> ExpressionPtr {
+    ExpressionBuilder builder{};
+    nlohmann::json::sax_parse(std::forward<T>(input), &builder);
+    return std::move(builder).Result();
+}
+
+}  // namespace
+
+auto Expression::ParseJson(std::string const& text) -> ExpressionPtr {
+    return ParseJsonInput(text);
+}
+
+auto Expression::ParseJson(std::istream& stream) -> ExpressionPtr {
+    return ParseJsonInput(stream);
+}
+
 template <std::size_t kIndex>
 auto Expression::TypeStringForIndex() const noexcept -> std::string {
     using var_t = decltype(data_);
@@ -268,3 +385,89 @@ auto Expression::ComputeHash() const noexcept -> std::string {
     }
     return hash;
 }
+
+// NOLINTNEXTLINE(misc-no-recursion)
+auto Expression::StructuralHash() const noexcept -> std::size_t {
+    auto hash = structural_hash_.load(std::memory_order_relaxed);
+    if (hash == 0) {
+        hash = ComputeStructuralHash();
+        structural_hash_.store(hash, std::memory_order_relaxed);
+    }
+    return hash;
+}
+
+// NOLINTNEXTLINE(misc-no-recursion)
+auto Expression::ComputeStructuralHash() const noexcept -> std::size_t {
+    auto hash = data_.index();
+    if (auto const* value = std::get_if<bool>(&data_)) {
+        hash_combine<bool>(&hash, *value);
+    }
+    else if (auto const* value = std::get_if<number_t>(&data_)) {
+        // all non-finite numbers are serialized, and hence compared, alike
+        hash_combine<number_t>(&hash, std::isfinite(*value) ? *value : 0.0);
+    }
+    else if (auto const* value = std::get_if<std::string>(&data_)) {
+        hash_combine<std::string>(&hash, *value);
+    }
+    else if (auto const* list = std::get_if<list_t>(&data_)) {
+        for (auto const& el : *list) {
+            hash_combine<std::size_t>(&hash, el->StructuralHash());
+        }
+    }
+    else if (auto const* map = std::get_if<map_t>(&data_)) {
+        for (auto const& [key, value] : *map) {
+            hash_combine<std::string>(&hash, key);
+            hash_combine<std::size_t>(&hash, value->StructuralHash());
+        }
+    }
+    else if (not IsNone()) {
+        // names, artifacts, results, and nodes are compared by their hash
+        auto bytes = ToHash();
+        auto prefix = std::size_t{};
+        std::memcpy(
+            &prefix, bytes.data(), std::min(sizeof(prefix), bytes.size()));
+        hash_combine<std::size_t>(&hash, prefix);
+    }
+    // 0 marks the hash as not computed yet
+    return hash == 0 ? 1 : hash;
+}
+
+// Equality of expressions is equality of their hashes, see ComputeHash. As
+// testing this by the structural hash and the values is cheaper than
+// computing cryptographic hashes, only values compared by their
+// serialization are compared by their hash.
+// NOLINTNEXTLINE(misc-no-recursion)
+auto Expression::IsEqualTo(Expression const& other) const noexcept -> bool {
+    if (data_.index() != other.data_.index() or
+        StructuralHash() != other.StructuralHash()) {
+        return false;
+    }
+    // If both hashes are known already, they decide without walking the trees.
+    if (auto const hash = hash_.GetIfSet()) {
+        if (auto const other_hash = other.hash_.GetIfSet()) {
+            return *hash == *other_hash;
+        }
+    }
+    if (IsNone()) {
+        return true;
+    }
+    if (auto const* value = std::get_if<bool>(&data_)) {
+        return *value == std::get<bool>(other.data_);
+    }
+    if (auto const* value = std::get_if<std::string>(&data_)) {
+        return *value == std::get<std::string>(other.data_);
+    }
+    if (auto const* list = std::get_if<list_t>(&data_)) {
+        auto const& other_list = std::get<list_t>(other.data_);
+        return std::equal(
+            list->begin(), list->end(), other_list.begin(), other_list.end());
+    }
+    if (auto const* map = std::get_if<map_t>(&data_)) {
+        auto const& other_map = std::get<map_t>(other.data_);
+        return std::equal(map->begin(),
+                          map->end(),
+                          other_map.begin(),
+                          other_map.end());
+    }
+    return ToHash() == other.ToHash();
+}
@@ -15,9 +15,11 @@
 #ifndef INCLUDED_SRC_BUILDTOOL_BUILD_ENGINE_EXPRESSION_EXPRESSION_HPP
 #define INCLUDED_SRC_BUILDTOOL_BUILD_ENGINE_EXPRESSION_EXPRESSION_HPP
 
+#include <atomic>
 #include <cstddef>
 #include <exception>
 #include <functional>
+#include <istream>
 #include <memory>
 #include <optional>
 #include <string>
@@ -80,7 +82,11 @@ class Expression {
     Expression() noexcept = default;
     ~Expression() noexcept = default;
     Expression(Expression const& other) noexcept = delete;
-    Expression(Expression&& other) noexcept = default;
+    Expression(Expression&& other) noexcept
+        : data_{std::move(other.data_)},
+          hash_{std::move(other.hash_)},
+          is_cachable_{std::move(other.is_cachable_)},
+          structural_hash_{other.structural_hash_.load()} {}
     auto operator=(Expression const& other) noexcept = delete;
     auto operator=(Expression&& other) noexcept = delete;
 
@@ -199,7 +205,7 @@ class Expression {
     template <class T>
     [[nodiscard]] auto operator==(T const& other) const noexcept -> bool {
         if constexpr (std::is_same_v<T, Expression>) {
-            return (&data_ == &other.data_) or (ToHash() == other.ToHash());
+            return (&data_ == &other.data_) or IsEqualTo(other);
         }
         else {
             return IsValidType<T>() and (GetIndexOf<T>() == data_.index()) and
@@ -235,9 +241,24 @@ class Expression {
         return ToHexString(ToHash());
     }
 
+    /// \brief Cheap, non-cryptographic hash of the structure of the
+    /// expression; cached after the first call. Equal expressions have equal
+    /// structural hashes, so it is used for hashing and as a first, cheap
+    /// test for equality and ordering.
+    [[nodiscard]] auto StructuralHash() const noexcept -> std::size_t;
+
     [[nodiscard]] static auto FromJson(nlohmann::json const& json) noexcept
         -> ExpressionPtr;
 
+    /// \brief Parse JSON text directly into an expression, without building
+    /// an intermediate JSON value first. As for nlohmann::json::parse, an
+    /// exception is thrown if the text is not valid JSON. Only meant for
+    /// text that is used as an expression as a whole; the entries of
+    /// targets, rules, and expression files are parsed on demand instead.
+    [[nodiscard]] static auto ParseJson(std::string const& text)
+        -> ExpressionPtr;
+    [[nodiscard]] static auto ParseJson(std::istream& stream) -> ExpressionPtr;
+
     inline static ExpressionPtr const kNone = Expression::FromJson("null"_json);
     inline static ExpressionPtr const kEmptyMap =
         Expression::FromJson("{}"_json);
@@ -265,6 +286,9 @@ class Expression {
 
     AtomicValue<std::string> hash_{};
     AtomicValue<bool> is_cachable_{};
+    // Structural hash, or 0 if not computed yet. Concurrent computations
+    // store the same value, so no synchronization beyond atomicity is needed.
+    mutable std::atomic<std::size_t> structural_hash_{};
 
     template <class T, std::size_t kIndex = 0>
     requires(IsValidType<T>()) [[nodiscard]] static consteval auto GetIndexOf()
@@ -348,6 +372,9 @@ class Expression {
     [[nodiscard]] auto TypeStringForIndex() const noexcept -> std::string;
     [[nodiscard]] auto TypeString() const noexcept -> std::string;
     [[nodiscard]] auto ComputeHash() const noexcept -> std::string;
+    [[nodiscard]] auto ComputeStructuralHash() const noexcept -> std::size_t;
+    [[nodiscard]] auto IsEqualTo(Expression const& other) const noexcept
+        -> bool;
     [[nodiscard]] auto ComputeIsCacheable() const -> bool;
 };
 
@@ -356,10 +383,7 @@ template <>
 struct hash<Expression> {
     [[nodiscard]] auto operator()(Expression const& e) const noexcept
         -> std::size_t {
-        auto hash = std::size_t{};
-        auto bytes = e.ToHash();
-        std::memcpy(&hash, bytes.data(), std::min(sizeof(hash), bytes.size()));
-        return hash;
+        return e.StructuralHash();
     }
 };
 }  // namespace std
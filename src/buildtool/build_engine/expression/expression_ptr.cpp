@@ -49,7 +49,13 @@ auto ExpressionPtr::operator[](std::size_t pos) && -> ExpressionPtr {
 }
 
 auto ExpressionPtr::operator<(ExpressionPtr const& other) const -> bool {
-    return ptr_->ToHash() < other.ptr_->ToHash();
+    auto hash = ptr_->StructuralHash();
+    auto other_hash = other.ptr_->StructuralHash();
+    if (hash != other_hash) {
+        return hash < other_hash;
+    }
+    // only on collisions of the structural hash, order by the full hash
+    return not(*this == other) and ptr_->ToHash() < other.ptr_->ToHash();
 }
 
 auto ExpressionPtr::operator==(ExpressionPtr const& other) const -> bool {
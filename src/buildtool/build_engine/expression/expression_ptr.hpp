@@ -40,7 +40,9 @@ class ExpressionPtr {
     requires(not std::is_same_v<std::remove_cvref_t<T>, ExpressionPtr>)
         // NOLINTNEXTLINE(bugprone-forwarding-reference-overload)
         explicit ExpressionPtr(T&& data) noexcept
-        : ptr_{std::make_shared<Expression>(std::forward<T>(data))} {}
+        : ptr_{std::make_shared<Expression>(std::forward<T>(data))} {
+        ++allocated_nodes_;
+    }
 
     ExpressionPtr() noexcept;
     ExpressionPtr(ExpressionPtr const&) noexcept = default;
@@ -97,8 +99,14 @@ class ExpressionPtr {
     [[nodiscard]] auto Map() const& -> linked_map_t const&;
     [[nodiscard]] static auto Make(linked_map_t&& map) -> ExpressionPtr;
 
+    // Number of expression nodes allocated by the calling thread so far
+    [[nodiscard]] static auto AllocatedNodes() noexcept -> std::size_t {
+        return allocated_nodes_;
+    }
+
   private:
     std::shared_ptr<Expression> ptr_;
+    inline static thread_local std::size_t allocated_nodes_{};
 };
 
 namespace std {
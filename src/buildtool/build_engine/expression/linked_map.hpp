@@ -22,10 +22,12 @@
 #include <map>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <utility>  // std::move
 #include <vector>
 
 #include "fmt/core.h"
+#include "gsl/gsl"
 #include "src/buildtool/multithreading/atomic_value.hpp"
 #include "src/utils/cpp/atomic.hpp"
 #include "src/utils/cpp/hash_combine.hpp"
@@ -116,13 +118,19 @@ class LinkedMap {
         map_.emplace(std::move(key), std::move(val));
     }
     LinkedMap(Ptr next, Ptr content) noexcept
-        : next_{std::move(next)}, content_{std::move(content)} {}
+        : next_{std::move(next)},
+          content_{std::move(content)},
+          num_maps_{NumMaps(next_, content_)} {}
     LinkedMap(Ptr next, underlying_map_t map) noexcept
-        : next_{std::move(next)}, map_{std::move(map)} {}
-    LinkedMap(Ptr next, item_t item) noexcept : next_{std::move(next)} {
+        : next_{std::move(next)},
+          map_{std::move(map)},
+          num_maps_{NumMaps(next_, content_)} {}
+    LinkedMap(Ptr next, item_t item) noexcept
+        : next_{std::move(next)}, num_maps_{NumMaps(next_, content_)} {
         map_.emplace(std::move(item));
     }
-    LinkedMap(Ptr next, K key, V val) noexcept : next_{std::move(next)} {
+    LinkedMap(Ptr next, K key, V val) noexcept
+        : next_{std::move(next)}, num_maps_{NumMaps(next_, content_)} {
         map_.emplace(std::move(key), std::move(val));
     }
 
@@ -166,6 +174,9 @@ class LinkedMap {
 
     [[nodiscard]] auto Find(K const& key) const& noexcept
         -> std::optional<V const*> {
+        if (UsesIndex()) {
+            return FindInIndex(key);
+        }
         if (content_.IsNotNull()) {
             auto val = content_.Map().Find(key);
             if (val) {
@@ -188,6 +199,13 @@ class LinkedMap {
     }
 
     [[nodiscard]] auto Find(K const& key) && noexcept -> std::optional<V> {
+        if (UsesIndex()) {
+            auto val = FindInIndex(key);
+            if (val) {
+                return **val;
+            }
+            return std::nullopt;
+        }
         if (content_.IsNotNull()) {
             auto val = content_.Map().Find(key);
             if (val) {
@@ -303,11 +321,87 @@ class LinkedMap {
     }
 
   private:
-    Ptr next_{};              // map that is shadowed by this map
-    Ptr content_{};           // content of this map if set
-    underlying_map_t map_{};  // content of this map if content_ is not set
+    // Entries of all linked maps, sorted by key, not containing shadowed
+    // entries; pointers are into the underlying maps, so no copies are made.
+    using index_t = std::vector<std::pair<K const*, V const*>>;
+
+    // Maximum number of underlying maps a lookup visits by following the
+    // links. Beyond that, lookups in the union of two linked maps (where, for
+    // the results of large map unions, a lookup would have to visit every
+    // single united map) use a (cached) sorted index of all entries instead.
+    // Maps extending another one by their own entries, like the chains of
+    // environments built during evaluation, never build an index; each of
+    // them would need its own, of the whole chain.
+    static constexpr std::size_t kMaxMapsPerLookup{16};
+
+    Ptr next_{};               // map that is shadowed by this map
+    Ptr content_{};            // content of this map if set
+    underlying_map_t map_{};   // content of this map if content_ is not set
+    std::size_t num_maps_{1};  // number of underlying maps linked
 
     AtomicValue<items_t> items_{};
+    AtomicValue<index_t> index_{};
+
+    [[nodiscard]] static auto NumMaps(Ptr const& next,
+                                      Ptr const& content) noexcept
+        -> std::size_t {
+        return (content.IsNotNull() ? content.Map().num_maps_ : 1) +
+               (next.IsNotNull() ? next.Map().num_maps_ : 0);
+    }
+
+    // Whether lookups use the index; only unions of linked maps are indexed.
+    [[nodiscard]] auto UsesIndex() const noexcept -> bool {
+        return content_.IsNotNull() and num_maps_ > kMaxMapsPerLookup;
+    }
+
+    [[nodiscard]] auto FindInIndex(K const& key) const& noexcept
+        -> std::optional<V const*> {
+        auto const& index =
+            index_.SetOnceAndGet([this] { return ComputeIndex(); });
+        auto it = std::lower_bound(index.begin(),
+                                   index.end(),
+                                   key,
+                                   [](auto const& entry, auto const& k) {
+                                       return *entry.first < k;
+                                   });
+        if (it != index.end() and *it->first == key) {
+            return it->second;
+        }
+        return std::nullopt;
+    }
+
+    // Collect entries in order of precedence, i.e., shadowing entries first.
+    void CollectEntries(gsl::not_null<index_t*> const& entries) const noexcept {
+        if (content_.IsNotNull()) {
+            content_.Map().CollectEntries(entries);
+        }
+        else {
+            for (auto const& [key, value] : map_) {
+                entries->emplace_back(&key, &value);
+            }
+        }
+        if (next_.IsNotNull()) {
+            next_.Map().CollectEntries(entries);
+        }
+    }
+
+    [[nodiscard]] auto ComputeIndex() const noexcept -> index_t {
+        auto index = index_t{};
+        CollectEntries(&index);
+        // stable sort and unique retain the first, i.e., shadowing, entry
+        std::stable_sort(index.begin(),
+                         index.end(),
+                         [](auto const& lhs, auto const& rhs) {
+                             return *lhs.first < *rhs.first;
+                         });
+        index.erase(std::unique(index.begin(),
+                                index.end(),
+                                [](auto const& lhs, auto const& rhs) {
+                                    return *lhs.first == *rhs.first;
+                                }),
+                    index.end());
+        return index;
+    }
 
     [[nodiscard]] auto ComputeSortedItems() const noexcept -> items_t {
         auto size = content_.IsNotNull() ? content_.Map().size() : map_.size();
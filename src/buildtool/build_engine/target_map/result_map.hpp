@@ -18,10 +18,14 @@
 #include <algorithm>
 #include <cstddef>
 #include <fstream>
+#include <functional>
+#include <memory>
 #include <mutex>
 #include <optional>
+#include <ostream>
 #include <string>
 #include <thread>
+#include <type_traits>
 #include <unordered_set>
 #include <utility>  // std::move
 #include <vector>
@@ -32,6 +36,7 @@
 #include "src/buildtool/build_engine/base_maps/entity_name.hpp"
 #include "src/buildtool/build_engine/expression/expression.hpp"
 #include "src/buildtool/build_engine/target_map/configured_target.hpp"
+#include "src/buildtool/common/binary_graph.hpp"
 #include "src/buildtool/common/statistics.hpp"
 #include "src/buildtool/common/tree.hpp"
 #include "src/buildtool/logging/log_level.hpp"
@@ -64,6 +69,9 @@ class ResultTargetMap {
 
     ResultTargetMap() = default;
 
+    /// \brief Consumer of the blobs of newly added analysed targets.
+    using BlobsConsumer = std::function<void(std::vector<std::string> const&)>;
+
     // \brief Add the analysed target for the given target and
     // configuration, if no entry is present for the given
     // target-configuration pair. \returns the analysed target that is
@@ -86,12 +94,52 @@ class ResultTargetMap {
         if (is_export_target) {
             export_targets_[part].emplace(entry->first);
         }
+        AnalysedTargetPtr target = entry->second;
         if (inserted) {
-            num_actions_[part] += entry->second->Actions().size();
-            num_blobs_[part] += entry->second->Blobs().size();
-            num_trees_[part] += entry->second->Trees().size();
+            RecordEffectiveVars(part, entry->first);
+            num_actions_[part] += target->Actions().size();
+            num_blobs_[part] += target->Blobs().size();
+            num_trees_[part] += target->Trees().size();
+        }
+        lock.unlock();
+        if (inserted and blobs_consumer_ and not target->Blobs().empty()) {
+            blobs_consumer_(target->Blobs());
+        }
+        return target;
+    }
+
+    /// \brief Look up an analysis of the given target under a configuration
+    /// that differs from the given one only in variables the target does
+    /// not depend on. For every set of variables a finished analysis of the
+    /// target depends on, the configuration is pruned to that set and looked
+    /// up. As analysis is deterministic and only reads those variables, any
+    /// hit is the result analysing the target would produce.
+    /// \returns the known analysed target, or nullptr if there is none.
+    [[nodiscard]] auto LookupEffective(BuildMaps::Base::EntityName const& name,
+                                       Configuration const& conf)
+        -> AnalysedTargetPtr {
+        auto part = std::hash<BuildMaps::Base::EntityName>{}(name) % width_;
+        std::unique_lock lock{m_[part]};
+        auto vars = effective_vars_[part].find(name);
+        if (vars == effective_vars_[part].end()) {
+            return nullptr;
+        }
+        for (auto const& vars_set : vars->second) {
+            auto entry = targets_[part].find(ConfiguredTarget{
+                .target = name, .config = conf.Prune(vars_set)});
+            if (entry != targets_[part].end()) {
+                return entry->second;
+            }
         }
-        return entry->second;
+        return nullptr;
+    }
+
+    /// \brief Set a consumer to be called with the blobs of every target
+    /// added from now on, e.g., to start uploading them while the analysis
+    /// is still running. The consumer is called outside of any lock and
+    /// possibly from several threads concurrently.
+    void SetBlobsConsumer(BlobsConsumer consumer) noexcept {
+        blobs_consumer_ = std::move(consumer);
     }
 
     [[nodiscard]] auto ConfiguredTargets() const noexcept
@@ -177,14 +225,211 @@ class ResultTargetMap {
                                 gsl::not_null<Progress*> const& progress,
                                 Logger const* logger = nullptr) const
         -> ResultType<kIncludeOrigins> {
+        return CollectResult<kIncludeOrigins>(
+            this, nullptr, stats, progress, logger);
+    }
+
+    /// \brief Same as \ref ToResult, but release the analysed targets while
+    /// collecting their actions, blobs, and trees, so that the analysis
+    /// results no longer needed are not kept alive alongside the collected
+    /// ones. Each part of the map is handed to the given task system for
+    /// release once collected. Afterwards, only the targets to be cached are
+    /// still available.
+    template <bool kIncludeOrigins = false>
+    [[nodiscard]] auto TakeResult(gsl::not_null<TaskSystem*> const& ts,
+                                  gsl::not_null<Statistics const*> const& stats,
+                                  gsl::not_null<Progress*> const& progress,
+                                  Logger const* logger = nullptr)
+        -> ResultType<kIncludeOrigins> {
+        return CollectResult<kIncludeOrigins>(
+            this, ts.get(), stats, progress, logger);
+    }
+
+    template <bool kIncludeOrigins = false>
+    [[nodiscard]] auto ToJson(gsl::not_null<Statistics const*> const& stats,
+                              gsl::not_null<Progress*> const& progress) const
+        -> nlohmann::json {
+        auto const result = ToResult<kIncludeOrigins>(stats, progress);
+        auto actions = nlohmann::json::object();
+        auto trees = nlohmann::json::object();
+        std::for_each(result.actions.begin(),
+                      result.actions.end(),
+                      [&actions](auto const& action) {
+                          if constexpr (kIncludeOrigins) {
+                              auto const& id = action.desc->GraphAction().Id();
+                              actions[id] = action.desc->ToJson();
+                              actions[id]["origins"] = action.origin;
+                          }
+                          else {
+                              auto const& id = action->GraphAction().Id();
+                              actions[id] = action->ToJson();
+                          }
+                      });
+        std::for_each(
+            result.trees.begin(),
+            result.trees.end(),
+            [&trees](auto const& tree) { trees[tree->Id()] = tree->ToJson(); });
+        return nlohmann::json{
+            {"actions", actions}, {"blobs", result.blobs}, {"trees", trees}};
+    }
+
+    template <bool kIncludeOrigins = true>
+    auto ToFile(std::string const& graph_file,
+                gsl::not_null<Statistics const*> const& stats,
+                gsl::not_null<Progress*> const& progress,
+                int indent = 2) const -> void {
+        Logger::Log(
+            LogLevel::Info, "Dumping action graph to file {}.", graph_file);
+        std::ofstream os(graph_file);
+        ToStream<kIncludeOrigins>(&os, stats, progress, indent);
+        os << std::endl;
+    }
+
+    /// \brief Write the action graph to the given file in the format of
+    /// \ref BinaryGraph. Decoding the file gives the value of \ref ToJson.
+    template <bool kIncludeOrigins = true>
+    [[nodiscard]] auto ToBinaryFile(
+        std::string const& graph_file,
+        gsl::not_null<Statistics const*> const& stats,
+        gsl::not_null<Progress*> const& progress) const -> bool {
+        Logger::Log(LogLevel::Info,
+                    "Dumping binary action graph to file {}.",
+                    graph_file);
+        auto const result = ToResult(stats, progress);
+        auto const& origin_map = progress->OriginMap();
+        std::ofstream os(graph_file, std::ios::binary);
+        BinaryGraph::Writer writer{&os};
+        writer.BeginObject(3);
+        writer.Key("actions");
+        writer.BeginObject(result.actions.size());
+        for (auto const& action : result.actions) {
+            writer.Key(action->GraphAction().Id());
+            auto desc = action->ToJson();
+            if constexpr (kIncludeOrigins) {
+                auto it = origin_map.find(action->Id());
+                desc["origins"] = it != origin_map.end()
+                                      ? OriginsToJson(it->second)
+                                      : nlohmann::json::array();
+            }
+            writer.Value(desc);
+        }
+        writer.Key("blobs");
+        writer.BeginArray(result.blobs.size());
+        for (auto const& blob : result.blobs) {
+            writer.Value(blob);
+        }
+        writer.Key("trees");
+        writer.BeginObject(result.trees.size());
+        for (auto const& tree : result.trees) {
+            writer.Key(tree->Id());
+            writer.Value(tree->ToJson());
+        }
+        auto const written = std::move(writer).Finish();
+        os.close();
+        if (not written or not os.good()) {
+            Logger::Log(LogLevel::Error,
+                        "Failed to write binary action graph to {}.",
+                        graph_file);
+            return false;
+        }
+        return true;
+    }
+
+    /// \brief Write the action graph to the given stream, serializing one
+    /// action, blob, or tree at a time. The output coincides with dumping
+    /// the result of \ref ToJson with the given indentation, but the graph
+    /// is never held in memory as a whole.
+    template <bool kIncludeOrigins = true>
+    void ToStream(gsl::not_null<std::ostream*> const& os,
+                  gsl::not_null<Statistics const*> const& stats,
+                  gsl::not_null<Progress*> const& progress,
+                  int indent = 2) const {
+        // Origins are computed per action from the origin map filled by
+        // ToResult, instead of collecting them for all actions upfront.
+        auto const result = ToResult(stats, progress);
+        auto const& origin_map = progress->OriginMap();
+        GraphWriter writer{os, indent};
+        writer.BeginObject();
+        writer.BeginEntry("actions", /*depth=*/1);
+        writer.BeginObject();
+        for (auto const& action : result.actions) {
+            writer.BeginEntry(action->GraphAction().Id(), /*depth=*/2);
+            auto desc = action->ToJson();
+            if constexpr (kIncludeOrigins) {
+                auto it = origin_map.find(action->Id());
+                desc["origins"] = it != origin_map.end()
+                                      ? OriginsToJson(it->second)
+                                      : nlohmann::json::array();
+            }
+            writer.Value(desc, /*depth=*/2);
+        }
+        writer.EndObject(/*depth=*/1);
+        writer.BeginEntry("blobs", /*depth=*/1);
+        writer.BeginArray();
+        for (auto const& blob : result.blobs) {
+            writer.BeginElement(/*depth=*/2);
+            writer.Value(blob, /*depth=*/2);
+        }
+        writer.EndArray(/*depth=*/1);
+        writer.BeginEntry("trees", /*depth=*/1);
+        writer.BeginObject();
+        for (auto const& tree : result.trees) {
+            writer.BeginEntry(tree->Id(), /*depth=*/2);
+            writer.Value(tree->ToJson(), /*depth=*/2);
+        }
+        writer.EndObject(/*depth=*/1);
+        writer.EndObject(/*depth=*/0);
+    }
+
+    void Clear(gsl::not_null<TaskSystem*> const& ts) {
+        for (std::size_t i = 0; i < width_; ++i) {
+            ts->QueueTask([i, this]() {
+                targets_[i].clear();
+                cache_targets_[i].clear();
+                effective_vars_[i].clear();
+            });
+        }
+    }
+
+  private:
+    constexpr static std::size_t kScalingFactor = 2;
+    std::size_t width_{ComputeWidth(0)};
+    std::vector<std::mutex> m_{width_};
+    std::vector<
+        std::unordered_map<ConfiguredTarget, gsl::not_null<AnalysedTargetPtr>>>
+        targets_{width_};
+    std::vector<
+        std::unordered_map<TargetCacheKey, gsl::not_null<AnalysedTargetPtr>>>
+        cache_targets_{width_};
+    std::vector<std::unordered_set<ConfiguredTarget>> export_targets_{width_};
+    // The distinct sets of variables the analyses of a target depend on,
+    // i.e., the variables of the configurations it is stored under.
+    std::vector<std::unordered_map<BuildMaps::Base::EntityName,
+                                   std::vector<std::vector<std::string>>>>
+        effective_vars_{width_};
+    std::vector<std::size_t> num_actions_{std::vector<std::size_t>(width_)};
+    std::vector<std::size_t> num_blobs_{std::vector<std::size_t>(width_)};
+    std::vector<std::size_t> num_trees_{std::vector<std::size_t>(width_)};
+    BlobsConsumer blobs_consumer_{};
+
+    // Collect the actions, blobs, and trees of all analysed targets; for a
+    // non-const map, the analysed targets are released on the way, by tasks
+    // queued to the given task system.
+    template <bool kIncludeOrigins, class Self>
+    [[nodiscard]] static auto CollectResult(
+        Self* self,
+        TaskSystem* release_ts,
+        gsl::not_null<Statistics const*> const& stats,
+        gsl::not_null<Progress*> const& progress,
+        Logger const* logger) -> ResultType<kIncludeOrigins> {
         ResultType<kIncludeOrigins> result{};
         std::size_t na = 0;
         std::size_t nb = 0;
         std::size_t nt = 0;
-        for (std::size_t i = 0; i < width_; i++) {
-            na += num_actions_[i];
-            nb += num_blobs_[i];
-            nt += num_trees_[i];
+        for (std::size_t i = 0; i < self->width_; i++) {
+            na += self->num_actions_[i];
+            nb += self->num_blobs_[i];
+            nt += self->num_trees_[i];
         }
         result.actions.reserve(na);
         result.blobs.reserve(nb);
@@ -193,7 +438,7 @@ class ResultTargetMap {
         auto& origin_map = progress->OriginMap();
         origin_map.clear();
         origin_map.reserve(na);
-        for (const auto& target : targets_) {
+        for (const auto& target : self->targets_) {
             std::for_each(target.begin(), target.end(), [&](auto const& el) {
                 auto const& actions = el.second->Actions();
                 std::size_t pos{};
@@ -231,7 +476,7 @@ class ResultTargetMap {
             }
         }
 
-        for (const auto& target : targets_) {
+        for (auto& target : self->targets_) {
             std::for_each(target.begin(), target.end(), [&](auto const& el) {
                 auto const& actions = el.second->Actions();
                 if constexpr (kIncludeOrigins) {
@@ -239,16 +484,10 @@ class ResultTargetMap {
                         actions.begin(),
                         actions.end(),
                         [&result, &origin_map](auto const& action) {
-                            auto origins = nlohmann::json::array();
-                            for (auto const& [ct, count] :
-                                 origin_map[action->Id()]) {
-                                origins.push_back(nlohmann::json{
-                                    {"target", ct.target.ToJson()},
-                                    {"subtask", count},
-                                    {"config", ct.config.ToJson()}});
-                            }
                             result.actions.emplace_back(ActionWithOrigin{
-                                .desc = action, .origin = origins});
+                                .desc = action,
+                                .origin =
+                                    OriginsToJson(origin_map[action->Id()])});
                         });
                 }
                 else {
@@ -265,6 +504,14 @@ class ResultTargetMap {
                 result.trees.insert(
                     result.trees.end(), trees.begin(), trees.end());
             });
+            if constexpr (not std::is_const_v<Self>) {
+                // Release the analysed targets of this part, unless still
+                // referenced elsewhere, e.g., as targets to be cached.
+                auto part = std::make_shared<std::decay_t<decltype(target)>>(
+                    std::move(target));
+                target.clear();
+                release_ts->QueueTask([part]() { part->clear(); });
+            }
         }
 
         std::sort(result.blobs.begin(), result.blobs.end());
@@ -311,6 +558,14 @@ class ResultTargetMap {
                         "Analysed {} non-known source trees",
                         trees_traversed);
         }
+        int analyses_collapsed = stats->AnalysesCollapsedCounter();
+        if (analyses_collapsed > 0) {
+            Logger::Log(logger,
+                        LogLevel::Performance,
+                        "Reused {} analyses for configurations differing "
+                        "only in irrelevant variables",
+                        analyses_collapsed);
+        }
         Logger::Log(logger,
                     LogLevel::Info,
                     "Discovered {} actions, {} trees, {} blobs",
@@ -321,69 +576,109 @@ class ResultTargetMap {
         return result;
     }
 
-    template <bool kIncludeOrigins = false>
-    [[nodiscard]] auto ToJson(gsl::not_null<Statistics const*> const& stats,
-                              gsl::not_null<Progress*> const& progress) const
-        -> nlohmann::json {
-        auto const result = ToResult<kIncludeOrigins>(stats, progress);
-        auto actions = nlohmann::json::object();
-        auto trees = nlohmann::json::object();
-        std::for_each(result.actions.begin(),
-                      result.actions.end(),
-                      [&actions](auto const& action) {
-                          if constexpr (kIncludeOrigins) {
-                              auto const& id = action.desc->GraphAction().Id();
-                              actions[id] = action.desc->ToJson();
-                              actions[id]["origins"] = action.origin;
-                          }
-                          else {
-                              auto const& id = action->GraphAction().Id();
-                              actions[id] = action->ToJson();
-                          }
-                      });
-        std::for_each(
-            result.trees.begin(),
-            result.trees.end(),
-            [&trees](auto const& tree) { trees[tree->Id()] = tree->ToJson(); });
-        return nlohmann::json{
-            {"actions", actions}, {"blobs", result.blobs}, {"trees", trees}};
-    }
+    /// \brief Incremental writer of JSON objects and arrays, producing the
+    /// same layout as nlohmann::json::dump for the given indentation; a
+    /// non-positive indentation gives the compact representation.
+    class GraphWriter {
+      public:
+        GraphWriter(gsl::not_null<std::ostream*> const& os, int indent)
+            : os_{os},
+              indent_{indent > 0 ? static_cast<std::size_t>(indent) : 0} {}
 
-    template <bool kIncludeOrigins = true>
-    auto ToFile(std::string const& graph_file,
-                gsl::not_null<Statistics const*> const& stats,
-                gsl::not_null<Progress*> const& progress,
-                int indent = 2) const -> void {
-        Logger::Log(
-            LogLevel::Info, "Dumping action graph to file {}.", graph_file);
-        std::ofstream os(graph_file);
-        os << std::setw(indent) << ToJson<kIncludeOrigins>(stats, progress)
-           << std::endl;
-    }
+        void BeginObject() { Open('{'); }
+        void BeginArray() { Open('['); }
+        void EndObject(std::size_t depth) { Close('}', depth); }
+        void EndArray(std::size_t depth) { Close(']', depth); }
 
-    void Clear(gsl::not_null<TaskSystem*> const& ts) {
-        for (std::size_t i = 0; i < width_; ++i) {
-            ts->QueueTask([i, this]() {
-                targets_[i].clear();
-                cache_targets_[i].clear();
-            });
+        /// \brief Start a new element of the innermost open array.
+        void BeginElement(std::size_t depth) {
+            Separate();
+            Indent(depth);
+        }
+
+        /// \brief Start a new entry of the innermost open object; the value
+        /// has to follow.
+        void BeginEntry(std::string const& key, std::size_t depth) {
+            BeginElement(depth);
+            *os_ << nlohmann::json(key).dump() << (indent_ > 0 ? ": " : ":");
+        }
+
+        /// \brief Write a complete value nested at the given depth.
+        void Value(nlohmann::json const& value, std::size_t depth) {
+            if (indent_ == 0) {
+                *os_ << value.dump();
+                return;
+            }
+            // Strings are dumped escaped, so all line breaks are layout.
+            auto const prefix = "\n" + std::string(depth * indent_, ' ');
+            auto const dumped = value.dump(indent_);
+            std::size_t pos{};
+            for (auto next = dumped.find('\n'); next != std::string::npos;
+                 next = dumped.find('\n', pos)) {
+                os_->write(dumped.data() + pos,
+                           static_cast<std::streamsize>(next - pos));
+                *os_ << prefix;
+                pos = next + 1;
+            }
+            os_->write(dumped.data() + pos,
+                       static_cast<std::streamsize>(dumped.size() - pos));
         }
+
+      private:
+        gsl::not_null<std::ostream*> os_;
+        std::size_t indent_;
+        std::vector<bool> empty_{};  // per open container
+
+        void Open(char bracket) {
+            *os_ << bracket;
+            empty_.push_back(true);
+        }
+
+        void Close(char bracket, std::size_t depth) {
+            if (not empty_.back()) {
+                Indent(depth);
+            }
+            empty_.pop_back();
+            *os_ << bracket;
+        }
+
+        void Separate() {
+            if (not empty_.back()) {
+                *os_ << ',';
+            }
+            empty_.back() = false;
+        }
+
+        void Indent(std::size_t depth) {
+            if (indent_ > 0) {
+                *os_ << '\n' << std::string(depth * indent_, ' ');
+            }
+        }
+    };
+
+    [[nodiscard]] static auto OriginsToJson(
+        std::vector<std::pair<ConfiguredTarget, std::size_t>> const& origins)
+        -> nlohmann::json {
+        auto result = nlohmann::json::array();
+        for (auto const& [ct, count] : origins) {
+            result.push_back(nlohmann::json{{"target", ct.target.ToJson()},
+                                            {"subtask", count},
+                                            {"config", ct.config.ToJson()}});
+        }
+        return result;
     }
 
-  private:
-    constexpr static std::size_t kScalingFactor = 2;
-    std::size_t width_{ComputeWidth(0)};
-    std::vector<std::mutex> m_{width_};
-    std::vector<
-        std::unordered_map<ConfiguredTarget, gsl::not_null<AnalysedTargetPtr>>>
-        targets_{width_};
-    std::vector<
-        std::unordered_map<TargetCacheKey, gsl::not_null<AnalysedTargetPtr>>>
-        cache_targets_{width_};
-    std::vector<std::unordered_set<ConfiguredTarget>> export_targets_{width_};
-    std::vector<std::size_t> num_actions_{std::vector<std::size_t>(width_)};
-    std::vector<std::size_t> num_blobs_{std::vector<std::size_t>(width_)};
-    std::vector<std::size_t> num_trees_{std::vector<std::size_t>(width_)};
+    /// \brief Remember the variables of the configuration a target is
+    /// stored under, for \ref LookupEffective. Caller must hold the lock of
+    /// the given part.
+    void RecordEffectiveVars(std::size_t part,
+                             ConfiguredTarget const& configured) {
+        auto vars = configured.config.Expr()->Map().Keys();
+        auto& known = effective_vars_[part][configured.target];
+        if (std::find(known.begin(), known.end(), vars) == known.end()) {
+            known.emplace_back(std::move(vars));
+        }
+    }
 
     // NOLINTNEXTLINE(misc-no-recursion)
     constexpr static auto ComputeWidth(std::size_t jobs) -> std::size_t {
@@ -15,7 +15,9 @@
 #include "src/buildtool/build_engine/target_map/target_map.hpp"
 
 #include <algorithm>
+#include <filesystem>
 #include <memory>
+#include <optional>
 #include <set>
 #include <sstream>
 #include <string>
@@ -23,13 +25,8 @@
 #include <unordered_set>
 #include <utility>
 
-#ifdef __unix__
-#include <fnmatch.h>
-#else
-#error "Non-unix is not supported yet"
-#endif
-
 #include "fmt/core.h"
+#include "src/buildtool/build_engine/base_maps/analysis_profile.hpp"
 #include "src/buildtool/build_engine/base_maps/field_reader.hpp"
 #include "src/buildtool/build_engine/expression/configuration.hpp"
 #include "src/buildtool/build_engine/expression/evaluator.hpp"
@@ -39,7 +36,9 @@
 #include "src/buildtool/build_engine/target_map/utils.hpp"
 #include "src/buildtool/logging/log_level.hpp"
 #include "src/buildtool/logging/logger.hpp"
+#include "src/utils/cpp/glob_pattern.hpp"
 #include "src/utils/cpp/gsl.hpp"
+#include "src/utils/cpp/lazy_json.hpp"
 #include "src/utils/cpp/path.hpp"
 #include "src/utils/cpp/vector.hpp"
 
@@ -314,6 +313,12 @@ void withDependencies(
     const BuildMaps::Target::TargetMap::SetterPtr& setter,
     const BuildMaps::Target::TargetMap::LoggerPtr& logger,
     const gsl::not_null<BuildMaps::Target::ResultTargetMap*>& result_map) {
+    // Account the time spent evaluating the target when profiling
+    std::optional<BuildMaps::Base::AnalysisProfile::ScopedTarget> profile{};
+    if (BuildMaps::Base::AnalysisProfile::Instance().IsEnabled()) {
+        profile.emplace(key.ToShortString());
+    }
+
     // Associate dependency keys with values
     std::unordered_map<BuildMaps::Target::ConfiguredTarget, AnalysedTargetPtr>
         deps_by_transition;
@@ -702,7 +707,9 @@ void withDependencies(
                   execution_properties,
                   inputs_exp);
               auto action_id = action->Id();
-              actions.emplace_back(std::move(action));
+              Evaluator::Effect([&actions, action = std::move(action)]() {
+                  actions.emplace_back(action);
+              });
               for (auto const& out : outputs) {
                   result.emplace(out,
                                  ExpressionPtr{ArtifactDescription{
@@ -724,7 +731,8 @@ void withDependencies(
                       fmt::format("BLOB data has to be a string, but got {}",
                                   data->ToString())};
               }
-              blobs.emplace_back(data->String());
+              Evaluator::Effect(
+                  [&blobs, data]() { blobs.emplace_back(data->String()); });
               return ExpressionPtr{ArtifactDescription{
                   ArtifactDigest::Create<ObjectType::File>(data->String()),
                   ObjectType::File}};
@@ -743,7 +751,8 @@ void withDependencies(
                       "SYMLINK data has to be non-upwards relative, but got {}",
                       data->ToString())};
               }
-              blobs.emplace_back(data->String());
+              Evaluator::Effect(
+                  [&blobs, data]() { blobs.emplace_back(data->String()); });
 
               return ExpressionPtr{ArtifactDescription{
                   ArtifactDigest::Create<ObjectType::Symlink>(data->String()),
@@ -780,7 +789,9 @@ void withDependencies(
               }
               auto tree = std::make_shared<Tree>(std::move(artifacts));
               auto tree_id = tree->Id();
-              trees.emplace_back(std::move(tree));
+              Evaluator::Effect([&trees, tree = std::move(tree)]() {
+                  trees.emplace_back(tree);
+              });
               return ExpressionPtr{ArtifactDescription{tree_id}};
           }},
          {"VALUE_NODE",
@@ -1020,6 +1031,12 @@ void withRuleDefinition(
     const BuildMaps::Target::TargetMap::SetterPtr& setter,
     const BuildMaps::Target::TargetMap::LoggerPtr& logger,
     const gsl::not_null<BuildMaps::Target::ResultTargetMap*> result_map) {
+    // Account the time spent evaluating the target when profiling
+    std::optional<BuildMaps::Base::AnalysisProfile::ScopedTarget> profile{};
+    if (BuildMaps::Base::AnalysisProfile::Instance().IsEnabled()) {
+        profile.emplace(key.ToShortString());
+    }
+
     auto param_config = key.config.Prune(data->target_vars);
 
     // Evaluate the config_fields
@@ -1375,7 +1392,7 @@ void withTargetsFile(
     const ActiveTargetCache& target_cache,
     const gsl::not_null<Statistics*>& stats,
     const gsl::not_null<Progress*>& exports_progress,
-    const nlohmann::json& targets_file,
+    const LazyJsonObject& targets_file,
     const gsl::not_null<BuildMaps::Base::SourceTargetMap*>& source_target,
     const gsl::not_null<BuildMaps::Base::UserRuleMap*>& rule_map,
     const gsl::not_null<TaskSystem*>& ts,
@@ -1383,8 +1400,9 @@ void withTargetsFile(
     const BuildMaps::Target::TargetMap::SetterPtr& setter,
     const BuildMaps::Target::TargetMap::LoggerPtr& logger,
     const gsl::not_null<BuildMaps::Target::ResultTargetMap*> result_map) {
-    auto desc_it = targets_file.find(key.target.GetNamedTarget().name);
-    if (desc_it == targets_file.end()) {
+    auto const* target_desc =
+        targets_file.Find(key.target.GetNamedTarget().name);
+    if (target_desc == nullptr) {
         // Not a defined taraget, treat as source target
         source_target->ConsumeAfterKeysReady(
             ts,
@@ -1399,7 +1417,7 @@ void withTargetsFile(
             });
     }
     else {
-        nlohmann::json desc = *desc_it;
+        nlohmann::json desc = *target_desc;
         auto rule_it = desc.find("type");
         if (rule_it == desc.end()) {
             (*logger)(
@@ -1725,16 +1743,41 @@ void TreeTarget(
         });
 }
 
-void GlobResult(const std::vector<AnalysedTargetPtr const*>& values,
-                const BuildMaps::Target::TargetMap::SetterPtr& setter) {
+void GlobTargetWithDirEntry(
+    const BuildMaps::Base::EntityName& key,
+    const BuildMaps::Target::TargetMap::SetterPtr& setter,
+    const BuildMaps::Target::TargetMap::LoggerPtr& logger,
+    const FileRoot::DirectoryEntries& dir) {
+    auto const& target = key.GetNamedTarget();
+    auto const pattern = GlobPattern{target.name};
+    auto const& names = dir.SortedBlobNames();
     auto result = Expression::map_t::underlying_map_t{};
-    for (auto const& value : values) {
-        for (auto const& [k, v] : (*value)->Artifacts()->Map()) {
-            result[k] = v;
+    // Only names starting with the literal prefix of the pattern can match;
+    // they are contiguous in the sorted listing. The artifacts of the
+    // matches are taken from the directory entries directly instead of via
+    // the source target map.
+    for (auto it =
+             std::lower_bound(names.begin(), names.end(), pattern.Prefix());
+         it != names.end() and it->starts_with(pattern.Prefix());
+         ++it) {
+        if (not pattern.Matches(*it)) {
+            continue;
         }
+        auto desc = dir.ToArtifactDescription(
+            std::filesystem::path{target.module}, *it, target.repository);
+        if (not desc) {
+            (*logger)(fmt::format("Cannot determine source file {} in "
+                                  "directory {} of repository {}",
+                                  nlohmann::json(*it).dump(),
+                                  nlohmann::json(target.module).dump(),
+                                  nlohmann::json(target.repository).dump()),
+                      true);
+            return;
+        }
+        result.emplace(*it, ExpressionPtr{std::move(*desc)});
     }
     auto stage = ExpressionPtr{Expression::map_t{result}};
-    auto target = std::make_shared<AnalysedTarget const>(
+    auto analysis_result = std::make_shared<AnalysedTarget const>(
         TargetResult{.artifact_stage = stage,
                      .provides = Expression::kEmptyMap,
                      .runfiles = stage},
@@ -1745,46 +1788,7 @@ void GlobResult(const std::vector<AnalysedTargetPtr const*>& values,
         std::set<std::string>{},
         std::set<std::string>{},
         TargetGraphInformation::kSource);
-    (*setter)(std::move(target));
-}
-
-void GlobTargetWithDirEntry(
-    const BuildMaps::Base::EntityName& key,
-    const gsl::not_null<TaskSystem*>& ts,
-    const BuildMaps::Target::TargetMap::SetterPtr& setter,
-    const BuildMaps::Target::TargetMap::LoggerPtr& logger,
-    const gsl::not_null<BuildMaps::Base::SourceTargetMap*>& source_target_map,
-    const FileRoot::DirectoryEntries& dir) {
-    auto const& target = key.GetNamedTarget();
-    auto const& pattern = target.name;
-    std::vector<BuildMaps::Base::EntityName> matches;
-    for (auto const& x : dir.FilesIterator()) {
-        if (fnmatch(pattern.c_str(), x.c_str(), 0) == 0) {
-            matches.emplace_back(BuildMaps::Base::EntityName{
-                target.repository,
-                target.module,
-                x,
-                BuildMaps::Base::ReferenceType::kFile});
-        }
-    }
-    for (auto const& x : dir.SymlinksIterator()) {
-        if (fnmatch(pattern.c_str(), x.c_str(), 0) == 0) {
-            matches.emplace_back(BuildMaps::Base::EntityName{
-                target.repository,
-                target.module,
-                x,
-                BuildMaps::Base::ReferenceType::kSymlink});
-        }
-    }
-    source_target_map->ConsumeAfterKeysReady(
-        ts,
-        matches,
-        [setter](auto values) { GlobResult(values, setter); },
-        [logger](auto const& msg, bool fatal) {
-            (*logger)(
-                fmt::format("While handling matching file targets:\n{}", msg),
-                fatal);
-        });
+    (*setter)(std::move(analysis_result));
 }
 
 }  // namespace
@@ -1817,6 +1821,18 @@ auto CreateTargetMap(
                                             auto logger,
                                             auto subcaller,
                                             auto key) {
+        if (key.target.IsAnonymousTarget() or
+            key.target.GetNamedTarget().reference_t ==
+                BuildMaps::Base::ReferenceType::kTarget) {
+            // Reuse an analysis under a configuration that only differs in
+            // variables the target does not depend on.
+            if (auto known = result_map->LookupEffective(key.target,
+                                                         key.config)) {
+                stats->IncrementAnalysesCollapsedCounter();
+                (*setter)(std::move(known));
+                return;
+            }
+        }
         if (key.target.IsAnonymousTarget()) {
             withTargetNode(key,
                            repo_config,
@@ -1894,14 +1910,9 @@ auto CreateTargetMap(
             directory_entries_map->ConsumeAfterKeysReady(
                 ts,
                 {target.ToModule()},
-                [target, ts, setter, wrapped_logger, source_target_map](
-                    auto values) {
-                    GlobTargetWithDirEntry(target,
-                                           ts,
-                                           setter,
-                                           wrapped_logger,
-                                           source_target_map,
-                                           *values[0]);
+                [target, setter, wrapped_logger](auto values) {
+                    GlobTargetWithDirEntry(
+                        target, setter, wrapped_logger, *values[0]);
                 },
                 [target, logger](auto const& msg, bool fatal) {
                     (*logger)(fmt::format("While reading directory for {}:\n{}",
@@ -15,9 +15,12 @@
 #ifndef INCLUDED_SRC_COMMON_ARTIFACT_DIGEST_HPP
 #define INCLUDED_SRC_COMMON_ARTIFACT_DIGEST_HPP
 
+#include <array>
 #include <cstddef>
+#include <cstdint>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <utility>  // std::move
 
 #include "gsl/gsl"
@@ -31,7 +34,9 @@
 // Provides getter for size with convenient non-protobuf type. Contains a
 // unprefixed hex string as hash. For communication with the execution API it
 // can be cast to bazel_re::Digest which is the wire format that contains
-// prefixed hashes in native mode.
+// prefixed hashes in native mode. Additionally, hashes are kept as raw bytes
+// of fixed maximal size, so that digests are compared and hashed on the raw
+// bytes rather than on the twice as long hex string.
 class ArtifactDigest {
     friend struct std::hash<ArtifactDigest>;
 
@@ -41,6 +46,7 @@ class ArtifactDigest {
     explicit ArtifactDigest(bazel_re::Digest const& digest) noexcept
         : size_{gsl::narrow<std::size_t>(digest.size_bytes())},
           hash_{NativeSupport::Unprefix(digest.hash())},
+          raw_{Encode(hash_)},
           // Tree information is only stored in a digest in native mode and
           // false in compatible mode.
           is_tree_{NativeSupport::IsTree(digest.hash())} {}
@@ -48,29 +54,33 @@ class ArtifactDigest {
     ArtifactDigest(std::string hash, std::size_t size, bool is_tree) noexcept
         : size_{size},
           hash_{std::move(hash)},
+          raw_{Encode(hash_)},
           // Tree information is only stored in a digest in native mode and
           // false in compatible mode.
           is_tree_{not Compatibility::IsCompatible() and is_tree} {
-        ExpectsAudit(not NativeSupport::IsPrefixed(hash_));
+        ExpectsAudit(not NativeSupport::IsPrefixed(this->hash()));
     }
 
-    [[nodiscard]] auto hash() const& noexcept -> std::string const& {
+    /// \brief The hash as unprefixed hex string.
+    [[nodiscard]] auto hash() const noexcept -> std::string const& {
         return hash_;
     }
 
-    [[nodiscard]] auto hash() && noexcept -> std::string {
-        return std::move(hash_);
-    }
-
     [[nodiscard]] auto size() const noexcept -> std::size_t { return size_; }
 
     // NOLINTNEXTLINE allow implicit casts
     [[nodiscard]] operator bazel_re::Digest() const {
-        return CreateBazelDigest(hash_, size_, is_tree_);
+        return CreateBazelDigest(hash(), size_, is_tree_);
     }
 
-    [[nodiscard]] auto operator==(ArtifactDigest const& other) const -> bool {
-        return std::equal_to<bazel_re::Digest>{}(*this, other);
+    [[nodiscard]] auto operator==(ArtifactDigest const& other) const noexcept
+        -> bool {
+        // Same as comparing the prefixed hashes of the bazel digests.
+        if (is_tree_ != other.is_tree_ or raw_ != other.raw_) {
+            return false;
+        }
+        // hashes that are not hex are only known by their string
+        return raw_.length != 0 or hash_ == other.hash_;
     }
 
     template <ObjectType kType>
@@ -91,10 +101,59 @@ class ArtifactDigest {
     }
 
   private:
+    /// \brief Raw bytes of a hash of up to 256 bits.
+    struct RawHash {
+        static constexpr std::size_t kMaxBytes = 32;
+        std::array<std::uint8_t, kMaxBytes> bytes;
+        std::uint8_t length;
+
+        [[nodiscard]] auto operator==(RawHash const& other) const noexcept
+            -> bool = default;
+
+        [[nodiscard]] auto View() const noexcept -> std::string_view {
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+            return {reinterpret_cast<char const*>(bytes.data()), length};
+        }
+    };
+
     std::size_t size_{};
     std::string hash_{};
+    // Raw bytes of the hash; empty for hashes that are not the lower-case hex
+    // encoding of 1 up to RawHash::kMaxBytes bytes.
+    RawHash raw_{};
     bool is_tree_{};
 
+    [[nodiscard]] static auto Encode(std::string const& hash) noexcept
+        -> RawHash {
+        static constexpr int kDecimalDigits = 10;
+        static constexpr unsigned kNibbleBits = 4;
+        auto nibble = [](char c) -> int {
+            if (c >= '0' and c <= '9') {
+                return c - '0';
+            }
+            if (c >= 'a' and c <= 'f') {
+                return c - 'a' + kDecimalDigits;
+            }
+            return -1;
+        };
+        if (hash.empty() or hash.size() % 2 != 0 or
+            hash.size() > 2 * RawHash::kMaxBytes) {
+            return RawHash{};
+        }
+        RawHash raw{};
+        raw.length = static_cast<std::uint8_t>(hash.size() / 2);
+        for (std::size_t i = 0; i < raw.length; ++i) {
+            auto high = nibble(hash[2 * i]);
+            auto low = nibble(hash[2 * i + 1]);
+            if (high < 0 or low < 0) {
+                return RawHash{};
+            }
+            raw.bytes[i] =
+                static_cast<std::uint8_t>((high << kNibbleBits) | low);
+        }
+        return raw;
+    }
+
     [[nodiscard]] static auto CreateBazelDigest(std::string const& hash,
                                                 std::size_t size,
                                                 bool is_tree)
@@ -112,7 +171,12 @@ struct hash<ArtifactDigest> {
     [[nodiscard]] auto operator()(ArtifactDigest const& digest) const noexcept
         -> std::size_t {
         std::size_t seed{};
-        hash_combine(&seed, digest.hash_);
+        if (digest.raw_.length != 0) {
+            hash_combine(&seed, digest.raw_.View());
+        }
+        else {
+            hash_combine(&seed, digest.hash_);
+        }
         hash_combine(&seed, digest.is_tree_);
         return seed;
     }
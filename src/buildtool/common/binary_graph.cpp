@@ -0,0 +1,472 @@
+// Copyright 2024 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/buildtool/common/binary_graph.hpp"
+
+#include <bit>
+#include <exception>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+namespace {
+
+enum Tag : std::uint8_t {
+    kNull = 0,
+    kFalse = 1,
+    kTrue = 2,
+    kUnsigned = 3,
+    kNegative = 4,
+    kFloat = 5,
+    kString = 6,
+    kArray = 7,
+    kObject = 8
+};
+
+// Strings of this many hex digits or more are candidates for being digests.
+constexpr std::size_t kMinDigestLength = 40;
+constexpr std::size_t kFloatBytes = 8;
+constexpr unsigned kByteBits = 8;
+constexpr std::uint64_t kByteMask = 0xff;
+constexpr unsigned kNibbleBits = 4;
+constexpr std::uint8_t kNibbleMask = 0xf;
+constexpr std::size_t kOffsetBytes = 8;
+constexpr unsigned kVarintBits = 7;
+constexpr std::uint8_t kVarintMask = 0x7f;
+constexpr std::uint8_t kVarintMore = 0x80;
+constexpr std::size_t kMaxVarintShift = 63;
+
+// Buffered output is handed to the stream in chunks of this size.
+constexpr std::size_t kFlushSize = std::size_t{1} << 16U;
+
+constexpr std::string_view kHexDigits{"0123456789abcdef"};
+
+void WriteVarint(std::string* out, std::uint64_t value) {
+    while (value > kVarintMask) {
+        out->push_back(
+            static_cast<char>((value & kVarintMask) | kVarintMore));
+        value >>= kVarintBits;
+    }
+    out->push_back(static_cast<char>(value));
+}
+
+[[nodiscard]] auto HexValue(char c) noexcept -> int {
+    if (c >= '0' and c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' and c <= 'f') {
+        return c - 'a' + 10;  // NOLINT(readability-magic-numbers)
+    }
+    return -1;
+}
+
+/// \brief Only lower-case hex strings are stored as raw bytes, so that
+/// decoding reproduces them exactly.
+[[nodiscard]] auto IsDigest(std::string const& str) noexcept -> bool {
+    if (str.size() < kMinDigestLength or str.size() % 2 != 0) {
+        return false;
+    }
+    for (auto c : str) {
+        if (HexValue(c) < 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+BinaryGraph::Writer::Writer(gsl::not_null<std::ostream*> const& out)
+    : out_{out}, buffer_{kMagic} {}
+
+void BinaryGraph::Writer::BeginObject(std::size_t size) {
+    buffer_.push_back(static_cast<char>(kObject));
+    WriteVarint(&buffer_, size);
+    Flush();
+}
+
+void BinaryGraph::Writer::BeginArray(std::size_t size) {
+    buffer_.push_back(static_cast<char>(kArray));
+    WriteVarint(&buffer_, size);
+    Flush();
+}
+
+void BinaryGraph::Writer::Key(std::string const& key) {
+    String(key);
+    Flush();
+}
+
+// NOLINTNEXTLINE(misc-no-recursion)
+void BinaryGraph::Writer::Value(nlohmann::json const& value) {
+    switch (value.type()) {
+        case nlohmann::json::value_t::object:
+            BeginObject(value.size());
+            for (auto const& [key, entry] : value.items()) {
+                Key(key);
+                Value(entry);
+            }
+            break;
+        case nlohmann::json::value_t::array:
+            BeginArray(value.size());
+            for (auto const& entry : value) {
+                Value(entry);
+            }
+            break;
+        case nlohmann::json::value_t::string:
+            buffer_.push_back(static_cast<char>(kString));
+            String(value.get_ref<std::string const&>());
+            break;
+        case nlohmann::json::value_t::boolean:
+            buffer_.push_back(
+                static_cast<char>(value.get<bool>() ? kTrue : kFalse));
+            break;
+        case nlohmann::json::value_t::number_unsigned:
+            buffer_.push_back(static_cast<char>(kUnsigned));
+            WriteVarint(&buffer_, value.get<std::uint64_t>());
+            break;
+        case nlohmann::json::value_t::number_integer: {
+            auto number = value.get<std::int64_t>();
+            if (number >= 0) {
+                buffer_.push_back(static_cast<char>(kUnsigned));
+                WriteVarint(&buffer_, static_cast<std::uint64_t>(number));
+            }
+            else {
+                buffer_.push_back(static_cast<char>(kNegative));
+                WriteVarint(&buffer_,
+                            static_cast<std::uint64_t>(-(number + 1)));
+            }
+            break;
+        }
+        case nlohmann::json::value_t::number_float: {
+            buffer_.push_back(static_cast<char>(kFloat));
+            auto bits = std::bit_cast<std::uint64_t>(value.get<double>());
+            for (std::size_t i = 0; i < kFloatBytes; ++i) {
+                buffer_.push_back(static_cast<char>(bits & kByteMask));
+                bits >>= kByteBits;
+            }
+            break;
+        }
+        default:
+            buffer_.push_back(static_cast<char>(kNull));
+    }
+    Flush();
+}
+
+// Strings are written as a single varint: even values refer to the string
+// table, odd values announce the given number of raw digest bytes.
+void BinaryGraph::Writer::String(std::string const& str) {
+    if (IsDigest(str)) {
+        WriteVarint(&buffer_, ((str.size() / 2) << 1U) | 1U);
+        for (std::size_t i = 0; i < str.size(); i += 2) {
+            buffer_.push_back(static_cast<char>(
+                (HexValue(str[i]) << kNibbleBits) | HexValue(str[i + 1])));
+        }
+        return;
+    }
+    auto [it, inserted] = index_.emplace(str, table_.size());
+    if (inserted) {
+        table_.emplace_back(&it->first);
+    }
+    WriteVarint(&buffer_, it->second << 1U);
+}
+
+auto BinaryGraph::Writer::Finish() && -> bool {
+    Flush(/*force=*/true);
+    auto const table_offset = written_;
+    WriteVarint(&buffer_, table_.size());
+    for (auto const* str : table_) {
+        WriteVarint(&buffer_, str->size());
+        buffer_.append(*str);
+        Flush();
+    }
+    for (std::size_t i = 0; i < kOffsetBytes; ++i) {
+        buffer_.push_back(
+            static_cast<char>((table_offset >> (kByteBits * i)) & kByteMask));
+    }
+    Flush(/*force=*/true);
+    out_->flush();
+    return out_->good();
+}
+
+void BinaryGraph::Writer::Flush(bool force) {
+    if (force or buffer_.size() >= kFlushSize) {
+        out_->write(buffer_.data(),
+                    static_cast<std::streamsize>(buffer_.size()));
+        written_ += buffer_.size();
+        buffer_.clear();
+    }
+}
+
+auto BinaryGraph::Reader::Create(std::string data) noexcept
+    -> std::optional<Reader> {
+    try {
+        if (not IsBinary(data)) {
+            return std::nullopt;
+        }
+        if (data.size() < kMagic.size() + kOffsetBytes) {
+            return std::nullopt;
+        }
+        Reader reader{std::make_shared<std::string const>(std::move(data))};
+        auto const table_end = reader.data_->size() - kOffsetBytes;
+        std::uint64_t table_offset{};
+        for (std::size_t i = 0; i < kOffsetBytes; ++i) {
+            auto byte = static_cast<std::uint8_t>(
+                (*reader.data_)[table_end + i]);
+            table_offset |= static_cast<std::uint64_t>(byte)
+                            << (kByteBits * i);
+        }
+        if (table_offset < kMagic.size() or table_offset > table_end) {
+            return std::nullopt;
+        }
+        // Read the table with the end of the table as limit, then restrict
+        // reading to the encoded value.
+        reader.pos_ = table_offset;
+        reader.end_ = table_end;
+        auto count = reader.ReadVarint();
+        if (not count or *count > table_end - reader.pos_) {
+            return std::nullopt;
+        }
+        reader.table_.reserve(*count);
+        for (std::uint64_t i = 0; i < *count; ++i) {
+            auto length = reader.ReadVarint();
+            if (not length or *length > table_end - reader.pos_) {
+                return std::nullopt;
+            }
+            reader.table_.emplace_back(reader.pos_, *length);
+            reader.pos_ += *length;
+        }
+        if (reader.pos_ != table_end) {
+            return std::nullopt;
+        }
+        reader.pos_ = kMagic.size();
+        reader.end_ = table_offset;
+        return reader;
+    } catch (...) {
+        return std::nullopt;
+    }
+}
+
+auto BinaryGraph::Reader::ReadObject() noexcept -> std::optional<std::size_t> {
+    if (not ReadTag(kObject)) {
+        return std::nullopt;
+    }
+    return ReadVarint();
+}
+
+auto BinaryGraph::Reader::ReadArray() noexcept -> std::optional<std::size_t> {
+    if (not ReadTag(kArray)) {
+        return std::nullopt;
+    }
+    return ReadVarint();
+}
+
+auto BinaryGraph::Reader::ReadKey() noexcept -> std::optional<std::string> {
+    return ReadString();
+}
+
+// NOLINTNEXTLINE(misc-no-recursion)
+auto BinaryGraph::Reader::ReadValue() noexcept
+    -> std::optional<nlohmann::json> {
+    try {
+        if (pos_ >= end_) {
+            return std::nullopt;
+        }
+        auto tag = static_cast<std::uint8_t>((*data_)[pos_]);
+        switch (tag) {
+            case kNull:
+                ++pos_;
+                return nlohmann::json{};
+            case kFalse:
+            case kTrue:
+                ++pos_;
+                return nlohmann::json(tag == kTrue);
+            case kUnsigned:
+            case kNegative: {
+                ++pos_;
+                auto number = ReadVarint();
+                if (not number) {
+                    return std::nullopt;
+                }
+                if (tag == kUnsigned) {
+                    return nlohmann::json(*number);
+                }
+                if (*number > static_cast<std::uint64_t>(
+                                  std::numeric_limits<std::int64_t>::max())) {
+                    return std::nullopt;
+                }
+                return nlohmann::json(-static_cast<std::int64_t>(*number) - 1);
+            }
+            case kFloat: {
+                ++pos_;
+                if (end_ - pos_ < kFloatBytes) {
+                    return std::nullopt;
+                }
+                std::uint64_t bits{};
+                for (std::size_t i = 0; i < kFloatBytes; ++i) {
+                    bits |= static_cast<std::uint64_t>(
+                                static_cast<std::uint8_t>((*data_)[pos_ + i]))
+                            << (kByteBits * i);
+                }
+                pos_ += kFloatBytes;
+                return nlohmann::json(std::bit_cast<double>(bits));
+            }
+            case kString: {
+                ++pos_;
+                auto str = ReadString();
+                if (not str) {
+                    return std::nullopt;
+                }
+                return nlohmann::json(*std::move(str));
+            }
+            case kArray: {
+                auto size = ReadArray();
+                if (not size) {
+                    return std::nullopt;
+                }
+                auto result = nlohmann::json::array();
+                for (std::size_t i = 0; i < *size; ++i) {
+                    auto entry = ReadValue();
+                    if (not entry) {
+                        return std::nullopt;
+                    }
+                    result.emplace_back(*std::move(entry));
+                }
+                return result;
+            }
+            case kObject: {
+                auto size = ReadObject();
+                if (not size) {
+                    return std::nullopt;
+                }
+                auto result = nlohmann::json::object();
+                for (std::size_t i = 0; i < *size; ++i) {
+                    auto key = ReadKey();
+                    if (not key) {
+                        return std::nullopt;
+                    }
+                    auto entry = ReadValue();
+                    if (not entry) {
+                        return std::nullopt;
+                    }
+                    result[*key] = *std::move(entry);
+                }
+                return result;
+            }
+            default:
+                return std::nullopt;
+        }
+    } catch (...) {
+        return std::nullopt;
+    }
+}
+
+auto BinaryGraph::Reader::ReadVarint() noexcept
+    -> std::optional<std::uint64_t> {
+    std::uint64_t result{};
+    for (std::size_t shift = 0; pos_ < end_; shift += kVarintBits) {
+        if (shift > kMaxVarintShift) {
+            return std::nullopt;
+        }
+        auto byte = static_cast<std::uint8_t>((*data_)[pos_++]);
+        result |= static_cast<std::uint64_t>(byte & kVarintMask) << shift;
+        if ((byte & kVarintMore) == 0) {
+            return result;
+        }
+    }
+    return std::nullopt;
+}
+
+auto BinaryGraph::Reader::ReadString() noexcept -> std::optional<std::string> {
+    try {
+        auto ref = ReadVarint();
+        if (not ref) {
+            return std::nullopt;
+        }
+        if ((*ref & 1U) == 0) {
+            auto index = *ref >> 1U;
+            if (index >= table_.size()) {
+                return std::nullopt;
+            }
+            auto const& [offset, length] = table_[index];
+            return data_->substr(offset, length);
+        }
+        auto length = *ref >> 1U;
+        if (length > end_ - pos_) {
+            return std::nullopt;
+        }
+        std::string result{};
+        result.reserve(2 * length);
+        for (std::size_t i = 0; i < length; ++i) {
+            auto byte = static_cast<std::uint8_t>((*data_)[pos_ + i]);
+            result.push_back(kHexDigits[byte >> kNibbleBits]);
+            result.push_back(kHexDigits[byte & kNibbleMask]);
+        }
+        pos_ += length;
+        return result;
+    } catch (...) {
+        return std::nullopt;
+    }
+}
+
+auto BinaryGraph::Reader::ReadTag(std::uint8_t expected) noexcept -> bool {
+    if (pos_ < end_ and
+        static_cast<std::uint8_t>((*data_)[pos_]) == expected) {
+        ++pos_;
+        return true;
+    }
+    return false;
+}
+
+auto BinaryGraph::IsBinaryFile(std::filesystem::path const& file) noexcept
+    -> bool {
+    try {
+        std::ifstream in(file, std::ios::binary);
+        std::string prefix(kMagic.size(), '\0');
+        if (not in.read(prefix.data(),
+                        static_cast<std::streamsize>(prefix.size()))) {
+            return false;
+        }
+        return IsBinary(prefix);
+    } catch (...) {
+        return false;
+    }
+}
+
+auto BinaryGraph::Encode(nlohmann::json const& value) noexcept
+    -> std::optional<std::string> {
+    try {
+        std::ostringstream out{};
+        Writer writer{&out};
+        writer.Value(value);
+        if (not std::move(writer).Finish()) {
+            return std::nullopt;
+        }
+        return std::move(out).str();
+    } catch (...) {
+        return std::nullopt;
+    }
+}
+
+auto BinaryGraph::Decode(std::string data) noexcept
+    -> std::optional<nlohmann::json> {
+    auto reader = Reader::Create(std::move(data));
+    if (not reader) {
+        return std::nullopt;
+    }
+    auto value = reader->ReadValue();
+    if (not value or not reader->AtEnd()) {
+        return std::nullopt;
+    }
+    return value;
+}
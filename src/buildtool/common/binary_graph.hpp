@@ -0,0 +1,140 @@
+// Copyright 2024 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_SRC_BUILDTOOL_COMMON_BINARY_GRAPH_HPP
+#define INCLUDED_SRC_BUILDTOOL_COMMON_BINARY_GRAPH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>  // std::pair
+#include <vector>
+
+#include "gsl/gsl"
+#include "nlohmann/json.hpp"
+
+/// \brief Compact binary encoding of JSON values, used to hand over action
+/// graphs between processes. All strings are stored once in a string table
+/// and referred to by varint-encoded indices; strings that are hex-encoded
+/// digests are stored as raw bytes instead. Decoding a value gives back the
+/// original JSON value.
+///
+/// Layout: magic, the encoding of the top-level value, the string table
+/// (count, then length and bytes per entry), and finally the offset of the
+/// string table as 8 bytes little endian. Keeping the table at the end allows
+/// writing the encoding of the value while it is produced.
+class BinaryGraph {
+  public:
+    static constexpr std::string_view kMagic{"JUSTBG\0\1", 8};
+
+    /// \brief Incrementally encode a JSON value to a stream. Objects and
+    /// arrays can be written entry by entry, with their number of entries
+    /// given upfront. Only the string table is kept in memory.
+    class Writer {
+      public:
+        explicit Writer(gsl::not_null<std::ostream*> const& out);
+        void BeginObject(std::size_t size);
+        void BeginArray(std::size_t size);
+
+        /// \brief Write the key of the next object entry; the value has to
+        /// follow.
+        void Key(std::string const& key);
+
+        void Value(nlohmann::json const& value);
+
+        /// \brief Write the string table, completing the encoding of all
+        /// values written. \returns whether writing to the stream succeeded.
+        [[nodiscard]] auto Finish() && -> bool;
+
+      private:
+        gsl::not_null<std::ostream*> out_;
+        std::unordered_map<std::string, std::size_t> index_{};
+        std::vector<std::string const*> table_{};
+        std::string buffer_{};
+        std::uint64_t written_{};
+
+        void String(std::string const& str);
+        void Flush(bool force = false);
+    };
+
+    /// \brief Incrementally decode a value encoded by \ref Writer. Objects and
+    /// arrays can be read entry by entry, so that only single entries have to
+    /// be held as JSON value.
+    class Reader {
+      public:
+        /// \brief Check the header and read the string table of an encoding.
+        /// Strings are decoded only when requested.
+        [[nodiscard]] static auto Create(std::string data) noexcept
+            -> std::optional<Reader>;
+
+        /// \brief Read the beginning of an object. \returns the number of
+        /// entries of the object.
+        [[nodiscard]] auto ReadObject() noexcept -> std::optional<std::size_t>;
+
+        /// \brief Read the beginning of an array. \returns the number of
+        /// elements of the array.
+        [[nodiscard]] auto ReadArray() noexcept -> std::optional<std::size_t>;
+
+        /// \brief Read the key of the next object entry.
+        [[nodiscard]] auto ReadKey() noexcept -> std::optional<std::string>;
+
+        /// \brief Read the next complete value.
+        [[nodiscard]] auto ReadValue() noexcept
+            -> std::optional<nlohmann::json>;
+
+        [[nodiscard]] auto AtEnd() const noexcept -> bool {
+            return pos_ == end_;
+        }
+
+      private:
+        // Owned separately, so that moving the reader keeps offsets valid.
+        std::shared_ptr<std::string const> data_;
+        std::vector<std::pair<std::size_t, std::size_t>> table_{};
+        std::size_t pos_{};
+        std::size_t end_{};  // end of the encoded value, start of the table
+
+        explicit Reader(std::shared_ptr<std::string const> data)
+            : data_{std::move(data)} {}
+
+        [[nodiscard]] auto ReadVarint() noexcept
+            -> std::optional<std::uint64_t>;
+        [[nodiscard]] auto ReadString() noexcept -> std::optional<std::string>;
+        [[nodiscard]] auto ReadTag(std::uint8_t expected) noexcept -> bool;
+    };
+
+    /// \brief Check whether the given data starts with the binary-graph magic.
+    [[nodiscard]] static auto IsBinary(std::string_view data) noexcept -> bool {
+        return data.starts_with(kMagic);
+    }
+
+    /// \brief Check whether the given file contains a binary graph.
+    [[nodiscard]] static auto IsBinaryFile(
+        std::filesystem::path const& file) noexcept -> bool;
+
+    /// \brief Encode a JSON value as a whole.
+    [[nodiscard]] static auto Encode(nlohmann::json const& value) noexcept
+        -> std::optional<std::string>;
+
+    /// \brief Decode a complete encoding into a JSON value.
+    [[nodiscard]] static auto Decode(std::string data) noexcept
+        -> std::optional<nlohmann::json>;
+};
+
+#endif  // INCLUDED_SRC_BUILDTOOL_COMMON_BINARY_GRAPH_HPP
@@ -58,6 +58,8 @@ struct LogArguments {
 /// \brief Arguments required for analysing targets.
 struct AnalysisArguments {
     std::optional<std::size_t> expression_log_limit{};
+    std::optional<std::size_t> expression_call_memo_limit{};
+    std::optional<std::size_t> parallel_foreach_threshold{};
     std::vector<std::string> defines{};
     std::filesystem::path config_file{};
     std::optional<nlohmann::json> target{};
@@ -69,8 +71,10 @@ struct AnalysisArguments {
     std::optional<std::filesystem::path> rule_root{};
     std::optional<std::filesystem::path> expression_root{};
     std::optional<std::filesystem::path> graph_file{};
+    std::optional<std::filesystem::path> binary_graph_file{};
     std::optional<std::filesystem::path> artifacts_to_build_file{};
     std::optional<std::filesystem::path> serve_errors_file{};
+    std::optional<std::filesystem::path> analysis_profile_file{};
 };
 
 /// \brief Arguments required for describing targets/rules.
@@ -275,6 +279,18 @@ static inline auto SetupAnalysisArguments(
                                 "in error messages (Default {})",
                                 Evaluator::kDefaultExpressionLogLimit))
         ->type_name("NUM");
+    app->add_option("--expression-call-memo-limit",
+                    clargs->expression_call_memo_limit,
+                    "Memoize calls of expressions that only depend on their "
+                    "arguments, caching results of at most the given total "
+                    "size in bytes (Default: no memoization)")
+        ->type_name("NUM");
+    app->add_option("--parallel-foreach-threshold",
+                    clargs->parallel_foreach_threshold,
+                    "Evaluate the bodies of foreach and foreach_map over at "
+                    "least this many elements in parallel (Default: "
+                    "sequential evaluation)")
+        ->type_name("NUM");
     app->add_option_function<std::string>(
            "-D,--defines",
            [clargs](auto const& d) { clargs->defines.emplace_back(d); },
@@ -331,12 +347,22 @@ static inline auto SetupAnalysisArguments(
                     "File path for dumping the blob identifiers of serve "
                     "errors as json.")
         ->type_name("PATH");
+    app->add_option("--analysis-profile",
+                    clargs->analysis_profile_file,
+                    "File path for writing a profile of the analysis, per "
+                    "rule, expression, and target, as json.")
+        ->type_name("PATH");
     if (with_graph) {
         app->add_option(
                "--dump-graph",
                clargs->graph_file,
                "File path for writing the action graph description to.")
             ->type_name("PATH");
+        app->add_option("--dump-graph-binary",
+                        clargs->binary_graph_file,
+                        "File path for writing the action graph description "
+                        "to in compact binary format.")
+            ->type_name("PATH");
         app->add_option("--dump-artifacts-to-build",
                         clargs->artifacts_to_build_file,
                         "File path for writing the artifacts to build to.")
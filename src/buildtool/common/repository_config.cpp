@@ -14,9 +14,42 @@
 
 #include "src/buildtool/common/repository_config.hpp"
 
+#include <algorithm>
+#include <vector>
+
+#include "src/buildtool/crypto/hash_function.hpp"
+#include "src/buildtool/file_system/file_system_manager.hpp"
+#include "src/buildtool/logging/log_level.hpp"
+#include "src/buildtool/logging/logger.hpp"
+#include "src/buildtool/storage/fs_utils.hpp"
 #include "src/buildtool/storage/storage.hpp"
 #include "src/utils/automata/dfa_minimizer.hpp"
 
+namespace {
+
+// Read a repository key remembered in the given file. The key is only
+// returned if its graph is still available in CAS.
+[[nodiscard]] auto ReadRepositoryKey(
+    std::filesystem::path const& key_file) noexcept
+    -> std::optional<std::string> {
+    if (not FileSystemManager::IsFile(key_file)) {
+        return std::nullopt;
+    }
+    auto key = FileSystemManager::ReadFile(key_file);
+    if (not key or key->empty()) {
+        return std::nullopt;
+    }
+    auto const& cas = Storage::Instance().CAS();
+    if (cas.BlobPath(ArtifactDigest{*key, /*size is unknown*/ 0,
+                                    /*is_tree=*/false},
+                     /*is_executable=*/false)) {
+        return key;
+    }
+    return std::nullopt;
+}
+
+}  // namespace
+
 auto RepositoryConfig::RepositoryInfo::BaseContentDescription() const
     -> std::optional<nlohmann::json> {
     auto wroot = workspace_root.ContentDescription();
@@ -37,23 +70,82 @@ auto RepositoryConfig::RepositoryInfo::BaseContentDescription() const
 
 auto RepositoryConfig::RepositoryKey(std::string const& repo) const noexcept
     -> std::optional<std::string> {
-    auto const& unique = DeduplicateRepo(repo);
-    if (auto const* data = Data(unique)) {
+    if (auto const* data = Data(repo)) {
         // compute key only once (thread-safe)
         return data->key.SetOnceAndGet(
-            [this, &unique]() -> std::optional<std::string> {
-                if (auto graph = BuildGraphForRepository(unique)) {
-                    auto const& cas = Storage::Instance().CAS();
-                    if (auto digest = cas.StoreBlob(graph->dump(2))) {
-                        return ArtifactDigest{*digest}.hash();
-                    }
+            [this, &repo]() -> std::optional<std::string> {
+                // As keys are fully determined by the configuration, a key
+                // remembered for the same configuration can be reused.
+                auto key_file = StorageUtils::GetRepositoryKeyFile(
+                    ConfigDigest(),
+                    HashFunction::ComputeHash(repo).HexString());
+                if (auto key = ReadRepositoryKey(key_file)) {
+                    return key;
                 }
-                return std::nullopt;
+                auto key = ComputeRepositoryKey(repo);
+                if (key and
+                    not StorageUtils::WriteTreeIDFile(key_file, *key)) {
+                    Logger::Log(LogLevel::Warning,
+                                "Failed to write repository key file {}",
+                                key_file.string());
+                }
+                return key;
             });
     }
     return std::nullopt;
 }
 
+auto RepositoryConfig::ComputeRepositoryKey(std::string const& repo) const
+    -> std::optional<std::string> {
+    auto const& unique = DeduplicateRepo(repo);
+    if (unique != repo) {
+        // equivalent repositories share their key
+        return RepositoryKey(unique);
+    }
+    if (auto graph = BuildGraphForRepository(unique)) {
+        auto const& cas = Storage::Instance().CAS();
+        if (auto digest = cas.StoreBlob(graph->dump(2))) {
+            return ArtifactDigest{*digest}.hash();
+        }
+    }
+    return std::nullopt;
+}
+
+// Obtain the digest of everything repository keys depend on, i.e., the names,
+// content-fixed base descriptions, and bindings of all repositories. They are
+// hashed in a compact canonical encoding: repositories ordered by name, each
+// string prefixed by its length.
+auto RepositoryConfig::ConfigDigest() const -> std::string const& {
+    // Compute digest only once (thread-safe)
+    return config_digest_.SetOnceAndGet([this] {
+        std::vector<std::string const*> names{};
+        names.reserve(repos_.size());
+        for (auto const& [repo, data] : repos_) {
+            names.emplace_back(&repo);
+        }
+        std::sort(names.begin(), names.end(), [](auto const* a, auto const* b) {
+            return *a < *b;
+        });
+        auto hasher = HashFunction::Hasher();
+        auto add = [&hasher](std::string const& str) {
+            hasher.Update(std::to_string(str.size()) + ':');
+            hasher.Update(str);
+        };
+        for (auto const* name : names) {
+            auto const& data = repos_.at(*name);
+            add(*name);
+            add(data.base_desc ? data.base_desc->dump() : std::string{});
+            add(std::to_string(data.info.name_mapping.size()));
+            for (auto const& [local_name, global_name] :
+                 data.info.name_mapping) {
+                add(local_name);
+                add(global_name);
+            }
+        }
+        return std::move(hasher).Finalize().HexString();
+    });
+}
+
 // Obtain canonical name (according to bisimulation) for the given repository.
 auto RepositoryConfig::DeduplicateRepo(std::string const& repo) const
     -> std::string const& {
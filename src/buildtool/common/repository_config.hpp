@@ -52,6 +52,7 @@ class RepositoryConfig {
         repos_[repo].base_desc = info.BaseContentDescription();
         repos_[repo].info = std::move(info);
         repos_[repo].key.Reset();
+        config_digest_.Reset();
     }
 
     [[nodiscard]] auto SetGitCAS(
@@ -135,7 +136,9 @@ class RepositoryConfig {
     }
 
     // Obtain repository's cache key if the repository is content fixed or
-    // std::nullopt otherwise.
+    // std::nullopt otherwise. Keys are remembered in the local build root for
+    // the digest of the configuration (see \ref ConfigDigest), so that they
+    // are only computed once for an unchanged configuration.
     [[nodiscard]] auto RepositoryKey(std::string const& repo) const noexcept
         -> std::optional<std::string>;
 
@@ -144,6 +147,7 @@ class RepositoryConfig {
         repos_.clear();
         git_cas_.reset();
         duplicates_.Reset();
+        config_digest_.Reset();
     }
 
   private:
@@ -162,6 +166,7 @@ class RepositoryConfig {
     std::unordered_map<std::string, RepositoryData> repos_;
     GitCASPtr git_cas_;
     AtomicValue<duplicates_t> duplicates_{};
+    AtomicValue<std::string> config_digest_{};
 
     template <class T>
     [[nodiscard]] auto Get(std::string const& repo,
@@ -188,6 +193,11 @@ class RepositoryConfig {
     [[nodiscard]] auto DeduplicateRepo(std::string const& repo) const
         -> std::string const&;
 
+    [[nodiscard]] auto ConfigDigest() const -> std::string const&;
+
+    [[nodiscard]] auto ComputeRepositoryKey(std::string const& repo) const
+        -> std::optional<std::string>;
+
     [[nodiscard]] auto BuildGraphForRepository(std::string const& repo) const
         -> std::optional<nlohmann::json>;
 
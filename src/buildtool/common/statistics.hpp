@@ -28,6 +28,7 @@ class Statistics {
         num_rebuilt_actions_compared_ = 0;
         num_rebuilt_actions_missing_ = 0;
         num_trees_analysed_ = 0;
+        num_analyses_collapsed_ = 0;
     }
     void IncrementActionsQueuedCounter() noexcept { ++num_actions_queued_; }
     void IncrementActionsExecutedCounter() noexcept { ++num_actions_executed_; }
@@ -50,6 +51,9 @@ class Statistics {
     void IncrementExportsFoundCounter() noexcept { ++num_exports_found_; }
     void IncrementExportsServedCounter() noexcept { ++num_exports_served_; }
     void IncrementTreesAnalysedCounter() noexcept { ++num_trees_analysed_; }
+    void IncrementAnalysesCollapsedCounter() noexcept {
+        ++num_analyses_collapsed_;
+    }
     [[nodiscard]] auto ActionsQueuedCounter() const noexcept -> int {
         return num_actions_queued_;
     }
@@ -89,6 +93,9 @@ class Statistics {
     [[nodiscard]] auto TreesAnalysedCounter() const noexcept -> int {
         return num_trees_analysed_;
     }
+    [[nodiscard]] auto AnalysesCollapsedCounter() const noexcept -> int {
+        return num_analyses_collapsed_;
+    }
 
   private:
     std::atomic<int> num_actions_queued_{};
@@ -104,6 +111,7 @@ class Statistics {
     std::atomic<int> num_exports_found_{};
     std::atomic<int> num_exports_served_{};
     std::atomic<int> num_trees_analysed_{};
+    std::atomic<int> num_analyses_collapsed_{};
 };
 
 #endif  // INCLUDED_SRC_BUILDTOOL_COMMON_STATISTICS_HPP
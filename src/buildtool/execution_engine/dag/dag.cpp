@@ -14,41 +14,81 @@
 
 #include "src/buildtool/execution_engine/dag/dag.hpp"
 
+#include <exception>
+
+#include "src/buildtool/multithreading/task_system.hpp"
+
+namespace {
+
+[[nodiscard]] auto CountOutputs(ActionDescription const& action) noexcept
+    -> std::size_t {
+    return action.OutputFiles().size() + action.OutputDirs().size();
+}
+
+}  // namespace
+
+auto DependencyGraph::CreateOutputArtifactIds(
+    ActionDescription const& description) noexcept
+    -> std::optional<std::vector<ArtifactIdentifier>> {
+    try {
+        auto const& action_id = description.Id();
+        if (description.GraphAction().IsTreeAction()) {  // tree artifact
+            return std::vector<ArtifactIdentifier>{
+                ArtifactDescription{action_id}.Id()};
+        }
+
+        // action artifacts
+        std::vector<ArtifactIdentifier> ids{};
+        ids.reserve(CountOutputs(description));
+        for (auto const* paths :
+             {&description.OutputFiles(), &description.OutputDirs()}) {
+            for (auto const& artifact_path : *paths) {
+                ids.emplace_back(
+                    ArtifactDescription{action_id,
+                                        std::filesystem::path{artifact_path}}
+                        .Id());
+            }
+        }
+        return ids;
+    } catch (std::exception const& ex) {
+        Logger::Log(LogLevel::Error,
+                    "computing output artifacts of action {} failed with:\n{}",
+                    description.Id(),
+                    ex.what());
+    }
+    return std::nullopt;
+}
+
 auto DependencyGraph::CreateOutputArtifactNodes(
-    std::string const& action_id,
-    std::vector<std::string> const& file_paths,
-    std::vector<std::string> const& dir_paths,
-    bool is_tree_action)
+    ActionDescription const& description,
+    std::vector<ArtifactIdentifier> const& output_ids)
     -> std::pair<std::vector<DependencyGraph::NamedArtifactNodePtr>,
                  std::vector<DependencyGraph::NamedArtifactNodePtr>> {
-    if (is_tree_action) {  // create tree artifact
-        auto artifact = ArtifactDescription{action_id}.ToArtifact();
-        auto const node_id = AddArtifact(std::move(artifact));
-        return std::make_pair(std::vector<NamedArtifactNodePtr>{},
-                              std::vector<NamedArtifactNodePtr>{
-                                  {{}, &(*artifact_nodes_[node_id])}});
+    auto id_it = output_ids.begin();
+    if (description.GraphAction().IsTreeAction()) {  // create tree artifact
+        auto const node_id =
+            AddArtifact(Artifact::CreateActionArtifact(*id_it));
+        return std::make_pair(
+            std::vector<NamedArtifactNodePtr>{},
+            std::vector<NamedArtifactNodePtr>{{{}, &artifact_nodes_[node_id]}});
     }
 
     // create action artifacts
-    auto node_creator = [this, &action_id](auto* nodes, auto const& paths) {
+    auto node_creator = [this, &id_it](auto* nodes, auto const& paths) {
+        nodes->reserve(paths.size());
         for (auto const& artifact_path : paths) {
-            auto artifact =
-                ArtifactDescription{action_id,
-                                    std::filesystem::path{artifact_path}}
-                    .ToArtifact();
-            auto const node_id = AddArtifact(std::move(artifact));
-            nodes->emplace_back(NamedArtifactNodePtr{
-                artifact_path, &(*artifact_nodes_[node_id])});
+            auto const node_id =
+                AddArtifact(Artifact::CreateActionArtifact(*id_it++));
+            nodes->emplace_back(
+                NamedArtifactNodePtr{artifact_path, &artifact_nodes_[node_id]});
         }
     };
 
     std::vector<NamedArtifactNodePtr> file_nodes{};
-    file_nodes.reserve(file_paths.size());
-    node_creator(&file_nodes, file_paths);
+    node_creator(&file_nodes, description.OutputFiles());
 
     std::vector<NamedArtifactNodePtr> dir_nodes{};
-    dir_nodes.reserve(dir_paths.size());
-    node_creator(&dir_nodes, dir_paths);
+    node_creator(&dir_nodes, description.OutputDirs());
 
     return std::make_pair(std::move(file_nodes), std::move(dir_nodes));
 }
@@ -58,10 +98,10 @@ auto DependencyGraph::CreateInputArtifactNodes(
     -> std::optional<std::vector<DependencyGraph::NamedArtifactNodePtr>> {
     std::vector<NamedArtifactNodePtr> nodes{};
 
+    nodes.reserve(inputs.size());
     for (auto const& [local_path, artifact_desc] : inputs) {
-        auto artifact = artifact_desc.ToArtifact();
-        auto const node_id = AddArtifact(std::move(artifact));
-        nodes.push_back({local_path, &(*artifact_nodes_[node_id])});
+        auto const node_id = AddArtifactNode(artifact_desc);
+        nodes.push_back({local_path, &artifact_nodes_[node_id]});
     }
     return nodes;
 }
@@ -70,7 +110,7 @@ auto DependencyGraph::CreateActionNode(Action const& action) noexcept
     -> DependencyGraph::ActionNode* {
     if (action.IsTreeAction() or not action.Command().empty()) {
         auto const node_id = AddAction(action);
-        return &(*action_nodes_[node_id]);
+        return &action_nodes_[node_id];
     }
     return nullptr;
 }
@@ -107,34 +147,75 @@ auto DependencyGraph::LinkNodePointers(
 
 auto DependencyGraph::Add(std::vector<ActionDescription> const& actions)
     -> bool {
+    std::size_t outputs{};
+    for (auto const& action : actions) {
+        outputs += CountOutputs(action);
+    }
+    Reserve(actions.size(), outputs);
     return std::all_of(
         actions.begin(), actions.end(), [this](auto const& action) {
             return AddAction(action);
         });
 }
 
-auto DependencyGraph::Add(std::vector<ActionDescription::Ptr> const& actions)
-    -> bool {
-    return std::all_of(
-        actions.begin(), actions.end(), [this](auto const& action) {
-            return AddAction(*action);
-        });
+auto DependencyGraph::Add(std::vector<ActionDescription::Ptr> const& actions,
+                          std::size_t jobs) -> bool {
+    std::size_t outputs{};
+    for (auto const& action : actions) {
+        outputs += CountOutputs(*action);
+    }
+    Reserve(actions.size(), outputs);
+    if (jobs <= 1 or actions.size() < kMinParallelActions) {
+        return std::all_of(
+            actions.begin(), actions.end(), [this](auto const& action) {
+                return AddAction(*action);
+            });
+    }
+
+    // Computing the identifiers of output artifacts is the expensive part of
+    // adding an action and does not depend on the graph, so it is done in
+    // parallel. Inserting and linking the nodes remains sequential.
+    std::vector<std::optional<std::vector<ArtifactIdentifier>>> output_ids(
+        actions.size());
+    {
+        TaskSystem ts{jobs};
+        auto const chunk_size = std::max<std::size_t>(
+            kMinParallelActions / 4, actions.size() / (jobs * 4));
+        for (std::size_t begin = 0; begin < actions.size();
+             begin += chunk_size) {
+            auto const end = std::min(begin + chunk_size, actions.size());
+            ts.QueueTask([&actions, &output_ids, begin, end]() {
+                for (auto i = begin; i < end; ++i) {
+                    output_ids[i] = CreateOutputArtifactIds(*actions[i]);
+                }
+            });
+        }
+    }
+
+    for (std::size_t i = 0; i < actions.size(); ++i) {
+        if (not output_ids[i] or not AddAction(*actions[i], *output_ids[i])) {
+            return false;
+        }
+        output_ids[i].reset();
+    }
+    return true;
 }
 
 auto DependencyGraph::AddArtifact(ArtifactDescription const& description)
     -> ArtifactIdentifier {
-    auto artifact = description.ToArtifact();
-    auto id = artifact.Id();
-    [[maybe_unused]] auto const node_id = AddArtifact(std::move(artifact));
-    return id;
+    [[maybe_unused]] auto const node_id = AddArtifactNode(description);
+    return description.Id();
 }
 
 auto DependencyGraph::AddAction(ActionDescription const& description) -> bool {
-    auto output_nodes =
-        CreateOutputArtifactNodes(description.Id(),
-                                  description.OutputFiles(),
-                                  description.OutputDirs(),
-                                  description.GraphAction().IsTreeAction());
+    auto output_ids = CreateOutputArtifactIds(description);
+    return output_ids and AddAction(description, *output_ids);
+}
+
+auto DependencyGraph::AddAction(
+    ActionDescription const& description,
+    std::vector<ArtifactIdentifier> const& output_ids) -> bool {
+    auto output_nodes = CreateOutputArtifactNodes(description, output_ids);
     auto* action_node = CreateActionNode(description.GraphAction());
     auto input_nodes = CreateInputArtifactNodes(description.Inputs());
 
@@ -149,56 +230,69 @@ auto DependencyGraph::AddAction(ActionDescription const& description) -> bool {
 
 auto DependencyGraph::AddAction(Action const& a) noexcept
     -> DependencyGraph::ActionNodeIdentifier {
-    auto id = a.Id();
-    auto const action_it = action_ids_.find(id);
-    if (action_it != action_ids_.end()) {
-        return action_it->second;
+    auto const [it, inserted] =
+        action_ids_.try_emplace(a.Id(), action_nodes_.size());
+    if (inserted) {
+        action_nodes_.emplace_back(a);
     }
-    action_nodes_.emplace_back(ActionNode::Create(a));
-    ActionNodeIdentifier node_id{action_nodes_.size() - 1};
-    action_ids_[id] = node_id;
-    return node_id;
+    return it->second;
 }
 
 auto DependencyGraph::AddAction(Action&& a) noexcept
     -> DependencyGraph::ActionNodeIdentifier {
-    auto const& id = a.Id();
-    auto const action_it = action_ids_.find(id);
-    if (action_it != action_ids_.end()) {
-        return action_it->second;
+    auto const [it, inserted] =
+        action_ids_.try_emplace(a.Id(), action_nodes_.size());
+    if (inserted) {
+        action_nodes_.emplace_back(std::move(a));
     }
-    action_nodes_.emplace_back(ActionNode::Create(std::move(a)));
-    ActionNodeIdentifier node_id{action_nodes_.size() - 1};
-    action_ids_[id] = node_id;
-    return node_id;
+    return it->second;
 }
 
 auto DependencyGraph::AddArtifact(Artifact const& a) noexcept
     -> DependencyGraph::ArtifactNodeIdentifier {
-    auto const& id = a.Id();
-    auto const artifact_it = artifact_ids_.find(id);
+    auto const artifact_it = artifact_ids_.find(a.Id());
     if (artifact_it != artifact_ids_.end()) {
         return artifact_it->second;
     }
-    artifact_nodes_.emplace_back(ArtifactNode::Create(a));
-    ArtifactNodeIdentifier node_id{artifact_nodes_.size() - 1};
-    artifact_ids_[id] = node_id;
+    ArtifactNodeIdentifier node_id{artifact_nodes_.size()};
+    auto const& node = artifact_nodes_.emplace_back(a);
+    artifact_ids_.emplace(node.Content().Id(), node_id);
     return node_id;
 }
 
 auto DependencyGraph::AddArtifact(Artifact&& a) noexcept
     -> DependencyGraph::ArtifactNodeIdentifier {
-    auto id = a.Id();
-    auto const artifact_it = artifact_ids_.find(id);
+    auto const artifact_it = artifact_ids_.find(a.Id());
     if (artifact_it != artifact_ids_.end()) {
         return artifact_it->second;
     }
-    artifact_nodes_.emplace_back(ArtifactNode::Create(std::move(a)));
-    ArtifactNodeIdentifier node_id{artifact_nodes_.size() - 1};
-    artifact_ids_[id] = node_id;
+    ArtifactNodeIdentifier node_id{artifact_nodes_.size()};
+    auto const& node = artifact_nodes_.emplace_back(std::move(a));
+    artifact_ids_.emplace(node.Content().Id(), node_id);
     return node_id;
 }
 
+auto DependencyGraph::AddArtifactNode(
+    ArtifactDescription const& description) noexcept
+    -> DependencyGraph::ArtifactNodeIdentifier {
+    // Only create the artifact if no node exists for it yet
+    auto const it = artifact_ids_.find(description.Id());
+    if (it != artifact_ids_.end()) {
+        return it->second;
+    }
+    return AddArtifact(description.ToArtifact());
+}
+
+void DependencyGraph::Reserve(std::size_t actions,
+                              std::size_t artifacts) noexcept {
+    try {
+        action_ids_.reserve(action_ids_.size() + actions);
+        artifact_ids_.reserve(artifact_ids_.size() + artifacts);
+    } catch (...) {
+        // Reserving is only an optimization; maps grow on demand anyway.
+    }
+}
+
 auto DependencyGraph::ArtifactIdentifiers() const noexcept
     -> std::unordered_set<ArtifactIdentifier> {
     std::unordered_set<ArtifactIdentifier> ids;
@@ -206,7 +300,9 @@ auto DependencyGraph::ArtifactIdentifiers() const noexcept
         std::begin(artifact_ids_),
         std::end(artifact_ids_),
         std::inserter(ids, std::begin(ids)),
-        [](auto const& artifact_id_pair) { return artifact_id_pair.first; });
+        [](auto const& artifact_id_pair) {
+            return ArtifactIdentifier{artifact_id_pair.first};
+        });
     return ids;
 }
 
@@ -216,7 +312,7 @@ auto DependencyGraph::ArtifactNodeWithId(ArtifactIdentifier const& id)
     if (it_to_artifact == artifact_ids_.end()) {
         return nullptr;
     }
-    return &(*artifact_nodes_[it_to_artifact->second]);
+    return &artifact_nodes_[it_to_artifact->second];
 }
 
 auto DependencyGraph::ActionNodeWithId(ActionIdentifier const& id)
@@ -225,7 +321,7 @@ auto DependencyGraph::ActionNodeWithId(ActionIdentifier const& id)
     if (it_to_action == action_ids_.end()) {
         return nullptr;
     }
-    return &(*action_nodes_[it_to_action->second]);
+    return &action_nodes_[it_to_action->second];
 }
 
 auto DependencyGraph::ActionNodeOfArtifactWithId(ArtifactIdentifier const& id)
@@ -19,10 +19,11 @@
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <deque>
 #include <map>
-#include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>  // std::move
@@ -139,6 +140,8 @@ class DirectedAcyclicGraph {
     /// Note that "discovered" refers to "queued for visit" here.
     ///  - Retrieve (previous) state and mark as queued to be processed, which
     ///  will allow us to ensure that processing a node is queued at most once.
+    /// All flags are packed into a single atomic byte, which sub classes may
+    /// extend by flags of their own (see \ref kFirstUnusedFlag).
     class NodeTraversalState {
       public:
         NodeTraversalState() noexcept = default;
@@ -153,7 +156,7 @@ class DirectedAcyclicGraph {
         /// \returns True if it was already discovered, false otherwise
         /// Note: this is an atomic, lock-free operation
         [[nodiscard]] auto GetAndMarkDiscovered() noexcept -> bool {
-            return std::atomic_exchange(&has_been_discovered_, true);
+            return GetAndSetFlag(kDiscovered);
         }
 
         /// \brief Sets traversal state as queued to be processed
@@ -161,23 +164,39 @@ class DirectedAcyclicGraph {
         /// otherwise
         /// Note: this is an atomic, lock-free operation
         [[nodiscard]] auto GetAndMarkQueuedToBeProcessed() noexcept -> bool {
-            return std::atomic_exchange(&is_queued_to_be_processed_, true);
+            return GetAndSetFlag(kQueuedToBeProcessed);
         }
 
         /// \brief Check if a node is required to be processed or not
         [[nodiscard]] auto IsRequired() const noexcept -> bool {
-            return is_required_;
+            return IsFlagSet(kRequired);
         }
 
         /// \brief Mark node as required to be executed
         /// Note: this should be upon node discovery (visit) while traversing
         /// the graph
-        void MarkRequired() noexcept { is_required_ = true; }
+        void MarkRequired() noexcept { SetFlag(kRequired); }
+
+      protected:
+        using flags_t = std::uint8_t;
+        static constexpr flags_t kFirstUnusedFlag = 1U << 3U;
+
+        [[nodiscard]] auto GetAndSetFlag(flags_t flag) noexcept -> bool {
+            return (flags_.fetch_or(flag) & flag) != 0;
+        }
+
+        void SetFlag(flags_t flag) noexcept { flags_.fetch_or(flag); }
+
+        [[nodiscard]] auto IsFlagSet(flags_t flag) const noexcept -> bool {
+            return (flags_.load() & flag) != 0;
+        }
 
       private:
-        std::atomic<bool> has_been_discovered_{false};
-        std::atomic<bool> is_queued_to_be_processed_{false};
-        std::atomic<bool> is_required_{false};
+        static constexpr flags_t kDiscovered = 1U << 0U;
+        static constexpr flags_t kQueuedToBeProcessed = 1U << 1U;
+        static constexpr flags_t kRequired = 1U << 2U;
+
+        std::atomic<flags_t> flags_{};
     };
 
   protected:
@@ -282,13 +301,13 @@ class DependencyGraph : DirectedAcyclicGraph {
         ~ArtifactNodeTraversalState() noexcept = default;
 
         [[nodiscard]] auto IsAvailable() const noexcept -> bool {
-            return is_available_;
+            return IsFlagSet(kAvailable);
         }
 
-        void MakeAvailable() noexcept { is_available_ = true; }
+        void MakeAvailable() noexcept { SetFlag(kAvailable); }
 
       private:
-        std::atomic<bool> is_available_{false};
+        static constexpr flags_t kAvailable = kFirstUnusedFlag;
     };
 
     /// \brief Action node (bipartite)
@@ -298,21 +317,11 @@ class DependencyGraph : DirectedAcyclicGraph {
 
       public:
         using base::base;
-        using Ptr = std::unique_ptr<ActionNode>;
         struct NamedOtherNodePtr {
             Action::LocalPath path;
             base::OtherNodePtr node;
         };
 
-        [[nodiscard]] static auto Create(Action const& content) noexcept
-            -> Ptr {
-            return std::make_unique<ActionNode>(content);
-        }
-
-        [[nodiscard]] static auto Create(Action&& content) noexcept -> Ptr {
-            return std::make_unique<ActionNode>(std::move(content));
-        }
-
         // only valid if it has parents
         [[nodiscard]] auto IsValid() const noexcept -> bool final {
             return (!base::Parents().empty());
@@ -433,20 +442,19 @@ class DependencyGraph : DirectedAcyclicGraph {
         // To initialise the action traversal specific data before traversing
         // the graph
         void NotifyDoneLinking() const noexcept {
-            traversal_state_->InitUnavailableDeps(Children().size());
+            traversal_state_.InitUnavailableDeps(Children().size());
         }
 
         [[nodiscard]] auto TraversalState() const noexcept
             -> ActionNodeTraversalState* {
-            return traversal_state_.get();
+            return &traversal_state_;
         }
 
       private:
         std::vector<NamedOtherNodePtr> output_files_;
         std::vector<NamedOtherNodePtr> output_dirs_;
         std::vector<NamedOtherNodePtr> dependencies_;
-        std::unique_ptr<ActionNodeTraversalState> traversal_state_{
-            std::make_unique<ActionNodeTraversalState>()};
+        mutable ActionNodeTraversalState traversal_state_{};
 
         // Collect paths from named nodes.
         // TODO(oreiche): This could be potentially speed up by using a wrapper
@@ -488,16 +496,6 @@ class DependencyGraph : DirectedAcyclicGraph {
         using base::base;
         using typename base::OtherNode;
         using typename base::OtherNodePtr;
-        using Ptr = std::unique_ptr<ArtifactNode>;
-
-        [[nodiscard]] static auto Create(Artifact const& content) noexcept
-            -> Ptr {
-            return std::make_unique<ArtifactNode>(content);
-        }
-
-        [[nodiscard]] static auto Create(Artifact&& content) noexcept -> Ptr {
-            return std::make_unique<ArtifactNode>(std::move(content));
-        }
 
         [[nodiscard]] auto AddBuilderActionNode(
             OtherNodePtr const& action) noexcept -> bool {
@@ -530,12 +528,11 @@ class DependencyGraph : DirectedAcyclicGraph {
 
         [[nodiscard]] auto TraversalState() const noexcept
             -> ArtifactNodeTraversalState* {
-            return traversal_state_.get();
+            return &traversal_state_;
         }
 
       private:
-        std::unique_ptr<ArtifactNodeTraversalState> traversal_state_{
-            std::make_unique<ArtifactNodeTraversalState>()};
+        mutable ArtifactNodeTraversalState traversal_state_{};
     };
 
     using NamedArtifactNodePtr = ActionNode::NamedOtherNodePtr;
@@ -553,8 +550,13 @@ class DependencyGraph : DirectedAcyclicGraph {
     [[nodiscard]] auto Add(std::vector<ActionDescription> const& actions)
         -> bool;
 
-    [[nodiscard]] auto Add(std::vector<ActionDescription::Ptr> const& actions)
-        -> bool;
+    /// \brief Add actions to the graph.
+    /// \param actions     The actions to add.
+    /// \param jobs        Number of threads to use for preparing the output
+    ///                    artifacts of large batches of actions. Nodes are
+    ///                    always inserted and linked in the given order.
+    [[nodiscard]] auto Add(std::vector<ActionDescription::Ptr> const& actions,
+                           std::size_t jobs = 1) -> bool;
 
     [[nodiscard]] auto AddAction(ActionDescription const& description) -> bool;
 
@@ -594,29 +596,39 @@ class DependencyGraph : DirectedAcyclicGraph {
             artifact_nodes_.end(),
             [](auto const& node) {
                 return DirectedAcyclicGraph::check_validity<
-                    std::remove_reference_t<decltype(*node)>>(&(*node));
+                    std::remove_reference_t<decltype(node)>>(&node);
             });
     }
 
   private:
-    // List of action nodes we already created
-    std::vector<ActionNode::Ptr> action_nodes_{};
+    // Action nodes we already created. Nodes are stored in place, in chunks of
+    // contiguous memory, and never move once created.
+    std::deque<ActionNode> action_nodes_{};
 
-    // List of artifact nodes we already created
-    std::vector<ArtifactNode::Ptr> artifact_nodes_{};
+    // Artifact nodes we already created, stored like the action nodes
+    std::deque<ArtifactNode> artifact_nodes_{};
 
     // Associates global action identifier to local node id
     std::unordered_map<ActionIdentifier, ActionNodeIdentifier> action_ids_{};
 
-    // Associates global artifact identifier to local node id
-    std::unordered_map<ArtifactIdentifier, ArtifactNodeIdentifier>
+    // Associates global artifact identifier to local node id. The keys refer to
+    // the identifiers held by the artifact nodes, which never move.
+    std::unordered_map<std::string_view, ArtifactNodeIdentifier>
         artifact_ids_{};
 
+    // Minimal number of actions to prepare their outputs in parallel
+    static constexpr std::size_t kMinParallelActions = 1024;
+
+    /// \brief Compute the identifiers of the output artifacts of an action,
+    /// output files first, followed by output directories. This does not
+    /// touch the graph and is safe to call concurrently.
+    [[nodiscard]] static auto CreateOutputArtifactIds(
+        ActionDescription const& description) noexcept
+        -> std::optional<std::vector<ArtifactIdentifier>>;
+
     [[nodiscard]] auto CreateOutputArtifactNodes(
-        std::string const& action_id,
-        std::vector<std::string> const& file_paths,
-        std::vector<std::string> const& dir_paths,
-        bool is_tree_action)
+        ActionDescription const& description,
+        std::vector<ArtifactIdentifier> const& output_ids)
         -> std::pair<std::vector<DependencyGraph::NamedArtifactNodePtr>,
                      std::vector<DependencyGraph::NamedArtifactNodePtr>>;
 
@@ -627,6 +639,10 @@ class DependencyGraph : DirectedAcyclicGraph {
     [[nodiscard]] auto CreateActionNode(Action const& action) noexcept
         -> ActionNode*;
 
+    [[nodiscard]] auto AddAction(
+        ActionDescription const& description,
+        std::vector<ArtifactIdentifier> const& output_ids) -> bool;
+
     [[nodiscard]] static auto LinkNodePointers(
         std::vector<NamedArtifactNodePtr> const& output_files,
         std::vector<NamedArtifactNodePtr> const& output_dirs,
@@ -640,6 +656,15 @@ class DependencyGraph : DirectedAcyclicGraph {
         -> ArtifactNodeIdentifier;
     [[nodiscard]] auto AddArtifact(Artifact&& a) noexcept
         -> ArtifactNodeIdentifier;
+
+    /// \brief Get the node of a described artifact, creating the artifact
+    /// only if the graph does not know it yet.
+    [[nodiscard]] auto AddArtifactNode(
+        ArtifactDescription const& description) noexcept
+        -> ArtifactNodeIdentifier;
+
+    /// \brief Reserve the identifier maps for a batch of new nodes.
+    void Reserve(std::size_t actions, std::size_t artifacts) noexcept;
 };
 
 #endif  // INCLUDED_SRC_BUILDTOOL_EXECUTION_ENGINE_DAG_DAG_HPP
@@ -15,13 +15,16 @@
 #ifndef INCLUDED_SRC_BUILDTOOL_FILE_SYSTEM_FILE_ROOT_HPP
 #define INCLUDED_SRC_BUILDTOOL_FILE_SYSTEM_FILE_ROOT_HPP
 
+#include <algorithm>
 #include <filesystem>
 #include <iterator>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <utility>
 #include <variant>
+#include <vector>
 
 #include "gsl/gsl"
 #include "nlohmann/json.hpp"
@@ -178,6 +181,25 @@ class FileRoot {
         explicit DirectoryEntries(tree_t const& git_tree) noexcept
             : data_{git_tree} {}
 
+        /// \brief The names of all files and symlinks, sorted. Computed on
+        /// first use and shared between copies of these entries, so that,
+        /// e.g., several glob patterns can be matched against a range of the
+        /// same listing.
+        [[nodiscard]] auto SortedBlobNames() const
+            -> std::vector<std::string> const& {
+            std::call_once(sorted_blobs_->once, [this]() {
+                auto& names = sorted_blobs_->names;
+                for (auto const& x : FilesIterator()) {
+                    names.emplace_back(x);
+                }
+                for (auto const& x : SymlinksIterator()) {
+                    names.emplace_back(x);
+                }
+                std::sort(names.begin(), names.end());
+            });
+            return sorted_blobs_->names;
+        }
+
         [[nodiscard]] auto ContainsBlob(std::string const& name) const noexcept
             -> bool {
             try {
@@ -200,6 +222,35 @@ class FileRoot {
             return false;
         }
 
+        /// \brief Describe the blob with the given name in these entries as
+        /// artifact, as \ref FileRoot::ToArtifactDescription does for the
+        /// path dir_path/name, but without looking up the path again.
+        /// \returns nullopt if there is no blob of that name.
+        [[nodiscard]] auto ToArtifactDescription(
+            std::filesystem::path const& dir_path,
+            std::string const& name,
+            std::string const& repository) const noexcept
+            -> std::optional<ArtifactDescription> {
+            try {
+                if (std::holds_alternative<tree_t>(data_)) {
+                    auto const& data = std::get<tree_t>(data_);
+                    if (auto entry = data->LookupEntryByName(name)) {
+                        return GitBlobDescription(*entry, repository);
+                    }
+                    return std::nullopt;
+                }
+                if (std::holds_alternative<pairs_t>(data_)) {
+                    auto const& data = std::get<pairs_t>(data_);
+                    auto it = data.find(name);
+                    if (it != data.end() and IsBlobObject(it->second)) {
+                        return ArtifactDescription{dir_path / name, repository};
+                    }
+                }
+            } catch (...) {
+            }
+            return std::nullopt;
+        }
+
         [[nodiscard]] auto Empty() const noexcept -> bool {
             if (std::holds_alternative<tree_t>(data_)) {
                 try {
@@ -292,7 +343,14 @@ class FileRoot {
         }
 
       private:
+        struct SortedNames {
+            std::once_flag once{};
+            std::vector<std::string> names{};
+        };
+
         entries_t data_;
+        std::shared_ptr<SortedNames> sorted_blobs_{
+            std::make_shared<SortedNames>()};
     };
 
     FileRoot() noexcept = default;
@@ -570,22 +628,7 @@ class FileRoot {
             if (auto entry =
                     std::get<git_root_t>(root_).tree->LookupEntryByPath(
                         file_path)) {
-                if (entry->IsBlob()) {
-                    if (Compatibility::IsCompatible()) {
-                        auto compatible_hash = Compatibility::RegisterGitEntry(
-                            entry->Hash(), *entry->Blob(), repository);
-                        return ArtifactDescription{
-                            ArtifactDigest{compatible_hash,
-                                           *entry->Size(),
-                                           /*is_tree=*/false},
-                            entry->Type()};
-                    }
-                    return ArtifactDescription{
-                        ArtifactDigest{
-                            entry->Hash(), *entry->Size(), /*is_tree=*/false},
-                        entry->Type(),
-                        repository};
-                }
+                return GitBlobDescription(*entry, repository);
             }
             return std::nullopt;
         }
@@ -733,6 +776,28 @@ class FileRoot {
     // directories instead of erroring out. This means implicitly also that
     // there are no more fast tree lookups, i.e., tree traversal is a must.
     bool ignore_special_{};
+
+    /// \brief Describe a git tree entry as KNOWN artifact, if it is a blob.
+    [[nodiscard]] static auto GitBlobDescription(
+        GitTreeEntry const& entry,
+        std::string const& repository) noexcept
+        -> std::optional<ArtifactDescription> {
+        if (not entry.IsBlob()) {
+            return std::nullopt;
+        }
+        if (Compatibility::IsCompatible()) {
+            auto compatible_hash = Compatibility::RegisterGitEntry(
+                entry.Hash(), *entry.Blob(), repository);
+            return ArtifactDescription{
+                ArtifactDigest{
+                    compatible_hash, *entry.Size(), /*is_tree=*/false},
+                entry.Type()};
+        }
+        return ArtifactDescription{
+            ArtifactDigest{entry.Hash(), *entry.Size(), /*is_tree=*/false},
+            entry.Type(),
+            repository};
+    }
 };
 
 #endif  // INCLUDED_SRC_BUILDTOOL_FILE_SYSTEM_FILE_ROOT_HPP
@@ -1588,6 +1588,42 @@ auto GitRepo::WriteBlob(std::string const& content,
 #endif  // BOOTSTRAP_BUILD_TOOL
 }
 
+auto GitRepo::WriteBlobFromFile(std::filesystem::path const& file_path,
+                                anon_logger_ptr const& logger) noexcept
+    -> std::optional<std::string> {
+#ifdef BOOTSTRAP_BUILD_TOOL
+    return std::nullopt;
+#else
+    try {
+        // preferably with a "fake" repository!
+        if (not IsRepoFake()) {
+            Logger::Log(LogLevel::Debug,
+                        "Blob writer called on a real repository");
+        }
+        // share the odb lock
+        std::shared_lock lock{GetGitCAS()->mutex_};
+
+        git_oid blob_oid;
+        if (git_blob_create_from_disk(
+                &blob_oid, repo_->Ptr(), file_path.c_str()) != 0) {
+            (*logger)(fmt::format("writing blob from file {} into database "
+                                  "failed with:\n{}",
+                                  file_path.string(),
+                                  GitLastError()),
+                      /*fatal=*/true);
+            return std::nullopt;
+        }
+        return std::string{git_oid_tostr_s(&blob_oid)};
+    } catch (std::exception const& ex) {
+        Logger::Log(LogLevel::Error,
+                    "write blob from file {} failed with:\n{}",
+                    file_path.string(),
+                    ex.what());
+        return std::nullopt;
+    }
+#endif  // BOOTSTRAP_BUILD_TOOL
+}
+
 auto GitRepo::GetObjectByPathFromTree(std::string const& tree_id,
                                       std::string const& rel_path) noexcept
     -> std::optional<TreeEntryInfo> {
@@ -281,6 +281,15 @@ class GitRepo {
                                  anon_logger_ptr const& logger) noexcept
         -> std::optional<std::string>;
 
+    /// \brief Write the content of given file as a blob into underlying object
+    /// database, without holding the whole content in memory.
+    /// Calling it from a fake repository allows thread-safe use.
+    /// \returns Git ID of the written blob, or nullopt on errors.
+    /// It guarantees the logger is called exactly once with fatal if failure.
+    [[nodiscard]] auto WriteBlobFromFile(std::filesystem::path const& file_path,
+                                         anon_logger_ptr const& logger) noexcept
+        -> std::optional<std::string>;
+
     /// \brief Get the object info related to a given path inside a Git tree.
     /// Unlike GetSubtreeFromTree, we here ignore errors and only return a value
     /// when all is successful.
@@ -14,6 +14,12 @@
 
 #include "src/buildtool/file_system/symlinks_map/resolve_symlinks_map.hpp"
 
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
 #include "fmt/core.h"
 #include "src/buildtool/file_system/object_type.hpp"
 #include "src/buildtool/storage/config.hpp"
@@ -21,6 +27,76 @@
 
 namespace {
 
+/// \brief Ids of the subtrees at given directories of source root trees,
+/// remembered while looking up paths. Looking up a path then only has to read
+/// the trees below its deepest known directory instead of all trees from the
+/// root tree on; paths targeted by symlinks typically share long prefixes.
+class SourceTreesCache {
+  public:
+    /// \brief Look up the entry at the given path in the given root tree, as
+    /// GitRepo::GetObjectByPathFromTree does.
+    [[nodiscard]] auto GetObjectByPath(
+        GitRepo& repo,
+        std::string const& root_tree_id,
+        std::filesystem::path const& rel_path) noexcept
+        -> std::optional<GitRepo::TreeEntryInfo> {
+        try {
+            if (rel_path == ".") {
+                return repo.GetObjectByPathFromTree(root_tree_id, ".");
+            }
+            std::vector<std::string> const parts(rel_path.begin(),
+                                                 rel_path.end());
+            // start from the deepest known directory
+            std::size_t start{};
+            std::string tree_id{root_tree_id};
+            {
+                std::shared_lock lock{mutex_};
+                if (auto root = trees_.find(root_tree_id);
+                    root != trees_.end()) {
+                    for (std::size_t i = parts.size() - 1; i > 0; --i) {
+                        auto dir = Prefix(parts, i);
+                        if (auto it = root->second.find(dir);
+                            it != root->second.end()) {
+                            start = i;
+                            tree_id = it->second;
+                            break;
+                        }
+                    }
+                }
+            }
+            // walk the remaining directories, remembering their trees
+            for (std::size_t i = start; i + 1 < parts.size(); ++i) {
+                auto entry = repo.GetObjectByPathFromTree(tree_id, parts[i]);
+                if (not entry or not IsTreeObject(entry->type)) {
+                    return std::nullopt;
+                }
+                tree_id = entry->id;
+                std::unique_lock lock{mutex_};
+                trees_[root_tree_id].emplace(Prefix(parts, i + 1), tree_id);
+            }
+            return repo.GetObjectByPathFromTree(tree_id, parts.back());
+        } catch (...) {
+            return std::nullopt;
+        }
+    }
+
+  private:
+    std::shared_mutex mutex_{};
+    // root tree id -> directory path -> subtree id
+    std::unordered_map<std::string,
+                       std::unordered_map<std::string, std::string>>
+        trees_{};
+
+    [[nodiscard]] static auto Prefix(std::vector<std::string> const& parts,
+                                     std::size_t n) -> std::string {
+        std::filesystem::path dir{};
+        for (std::size_t i = 0; i < n; ++i) {
+            dir /= parts[i];
+        }
+        return dir.string();
+    }
+};
+
 /// \brief Ensures that a given blob is in the target repo.
 /// On errors, calls logger with fatal and returns false.
 [[nodiscard]] auto EnsureBlobExists(GitObjectToResolve const& obj,
@@ -292,11 +368,12 @@ void ResolveKnownEntry(GitObjectToResolve const& obj,
 }  // namespace
 
 auto CreateResolveSymlinksMap() -> ResolveSymlinksMap {
-    auto resolve_symlinks = [](auto /*unused*/,
-                               auto setter,
-                               auto logger,
-                               auto subcaller,
-                               auto const& key) {
+    auto resolve_symlinks = [trees = std::make_shared<SourceTreesCache>()](
+                                auto /*unused*/,
+                                auto setter,
+                                auto logger,
+                                auto subcaller,
+                                auto const& key) {
         auto entry_info = key.known_info;
         if (not entry_info) {
             // look up entry by its relative path inside root tree if not known
@@ -307,8 +384,8 @@ auto CreateResolveSymlinksMap() -> ResolveSymlinksMap {
                     /*fatal=*/true);
                 return;
             }
-            entry_info = source_git_repo->GetObjectByPathFromTree(
-                key.root_tree_id, key.rel_path);
+            entry_info = trees->GetObjectByPath(
+                *source_git_repo, key.root_tree_id, key.rel_path);
         }
 
         // differentiate between existing path and non-existing
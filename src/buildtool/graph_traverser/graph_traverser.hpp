@@ -16,22 +16,29 @@
 #define INCLUDED_SRC_BUILDTOOL_GRAPH_TRAVERSER_GRAPH_TRAVERSER_HPP
 
 #include <algorithm>
+#include <condition_variable>
 #include <cstddef>
 #include <cstdlib>
+#include <exception>
 #include <filesystem>
+#include <fstream>
 #include <functional>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <sstream>
 #include <string>
 #include <thread>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
 #include "fmt/core.h"
 #include "gsl/gsl"
 #include "src/buildtool/common/artifact_digest.hpp"
+#include "src/buildtool/common/binary_graph.hpp"
 #include "src/buildtool/common/cli.hpp"
 #include "src/buildtool/common/remote/remote_common.hpp"
 #include "src/buildtool/common/repository_config.hpp"
@@ -49,7 +56,6 @@
 #include "src/buildtool/execution_engine/executor/executor.hpp"
 #include "src/buildtool/execution_engine/traverser/traverser.hpp"
 #include "src/buildtool/file_system/file_system_manager.hpp"
-#include "src/buildtool/file_system/jsonfs.hpp"
 #include "src/buildtool/file_system/object_type.hpp"
 #include "src/buildtool/logging/log_level.hpp"
 #include "src/buildtool/logging/log_sink_cmdline.hpp"
@@ -57,6 +63,7 @@
 #include "src/buildtool/logging/logger.hpp"
 #include "src/buildtool/progress_reporting/base_progress_reporter.hpp"
 #include "src/utils/cpp/json.hpp"
+#include "src/utils/cpp/lazy_json.hpp"
 
 class GraphTraverser {
   public:
@@ -67,6 +74,16 @@ class GraphTraverser {
         std::optional<RebuildArguments> rebuild;
     };
 
+    /// \brief State of prefetching blobs via \ref UploadBlobsAhead.
+    struct AheadUploadStats {
+        bool uploading;        // whether the uploader thread is running
+        std::size_t uploaded;  // number of blobs uploaded ahead of building
+        std::size_t skipped;   // number of blobs not uploaded again
+    };
+
+    /// \brief Number of blobs collected before they are uploaded ahead.
+    static constexpr std::size_t kAheadUploadBatchSize = 1024;
+
     struct BuildResult {
         std::vector<std::filesystem::path> output_paths;
         // Object infos of extra artifacts requested to build.
@@ -126,25 +143,37 @@ class GraphTraverser {
     /// \param blobs                 Blob artifacts to upload before the build.
     /// \param trees                 Tree artifacts to compute graph nodes from.
     /// \param extra_artifacts       Extra artifacts to obtain object infos for.
+    /// Actions, blobs, and trees are released as soon as they are no longer
+    /// needed, i.e., once uploaded or added to the dependency graph.
     [[nodiscard]] auto BuildAndStage(
         std::map<std::string, ArtifactDescription> const& artifact_descriptions,
         std::map<std::string, ArtifactDescription> const& runfile_descriptions,
-        std::vector<ActionDescription::Ptr> const& action_descriptions,
-        std::vector<std::string> const& blobs,
-        std::vector<Tree::Ptr> const& trees,
+        std::vector<ActionDescription::Ptr>&& action_descriptions,
+        std::vector<std::string>&& blobs,
+        std::vector<Tree::Ptr>&& trees,
         std::vector<ArtifactDescription>&& extra_artifacts = {}) const
         -> std::optional<BuildResult> {
+        // all blobs left are uploaded as part of the build
+        StopUploadsAhead();
         DependencyGraph graph;  // must outlive artifact_nodes
         auto artifacts = BuildArtifacts(&graph,
                                         artifact_descriptions,
                                         runfile_descriptions,
-                                        action_descriptions,
-                                        trees,
-                                        blobs,
+                                        std::move(action_descriptions),
+                                        std::move(trees),
+                                        std::move(blobs),
                                         extra_artifacts);
         if (not artifacts) {
             return std::nullopt;
         }
+        if (auto const ahead = GetAheadUploadStats(); ahead.uploaded > 0) {
+            Logger::Log(logger_,
+                        LogLevel::Debug,
+                        "Prefetched {} blobs ahead of building, {} of them "
+                        "were not uploaded again.",
+                        ahead.uploaded,
+                        ahead.skipped);
+        }
         auto [rel_paths, artifact_nodes, extra_nodes] = *artifacts;
 
         auto const object_infos = CollectObjectInfos(artifact_nodes, logger_);
@@ -209,30 +238,24 @@ class GraphTraverser {
     [[nodiscard]] auto BuildAndStage(
         std::filesystem::path const& graph_description,
         nlohmann::json const& artifacts) const -> std::optional<BuildResult> {
-        // Read blobs to upload and actions from graph description file
-        auto desc = ReadGraphDescription(graph_description, logger_);
-        if (not desc) {
-            return std::nullopt;
-        }
-        auto const [blobs, tree_descs, actions] = *desc;
-
-        std::vector<ActionDescription::Ptr> action_descriptions{};
-        action_descriptions.reserve(actions.size());
-        for (auto const& [id, description] : actions.items()) {
-            auto action = ActionDescription::FromJson(id, description);
-            if (not action) {
-                return std::nullopt;  // Error already logged
-            }
-            action_descriptions.emplace_back(std::move(*action));
-        }
-
+        std::vector<std::string> blobs{};
         std::vector<Tree::Ptr> trees{};
-        for (auto const& [id, description] : tree_descs.items()) {
-            auto tree = Tree::FromJson(id, description);
-            if (not tree) {
+        std::vector<ActionDescription::Ptr> action_descriptions{};
+        if (BinaryGraph::IsBinaryFile(graph_description)) {
+            if (not ReadBinaryGraphDescription(graph_description,
+                                               &blobs,
+                                               &trees,
+                                               &action_descriptions,
+                                               logger_)) {
                 return std::nullopt;
             }
-            trees.emplace_back(std::move(*tree));
+        }
+        else if (not ReadGraphDescription(graph_description,
+                                          &blobs,
+                                          &trees,
+                                          &action_descriptions,
+                                          logger_)) {
+            return std::nullopt;
         }
 
         std::map<std::string, ArtifactDescription> artifact_descriptions{};
@@ -244,8 +267,63 @@ class GraphTraverser {
             artifact_descriptions.emplace(rel_path, std::move(*artifact));
         }
 
-        return BuildAndStage(
-            artifact_descriptions, {}, action_descriptions, blobs, trees);
+        return BuildAndStage(artifact_descriptions,
+                             {},
+                             std::move(action_descriptions),
+                             std::move(blobs),
+                             std::move(trees));
+    }
+
+    GraphTraverser(GraphTraverser const&) = delete;
+    GraphTraverser(GraphTraverser&&) = delete;
+    auto operator=(GraphTraverser const&) -> GraphTraverser& = delete;
+    auto operator=(GraphTraverser&&) -> GraphTraverser& = delete;
+    ~GraphTraverser() noexcept { StopUploadsAhead(); }
+
+    /// \brief Prefetch blobs to the CAS ahead of building, e.g., while the
+    /// analysis is still running. Only uploads overlap with the analysis;
+    /// actions are not executed before \ref BuildAndStage. Blobs are collected
+    /// and handed in batches to a separate uploader thread, started with the
+    /// first full batch, so that callers are never blocked by uploads. Blobs
+    /// uploaded successfully are not uploaded again by \ref BuildAndStage,
+    /// which stops the uploader. A failed upload is not an error, as the
+    /// affected blobs are then simply uploaded when building. Can be called
+    /// concurrently.
+    void UploadBlobsAhead(
+        std::vector<std::string> const& blobs) const noexcept {
+        try {
+            std::unique_lock lock{ahead_uploads_->mutex};
+            if (ahead_uploads_->stopped) {
+                return;
+            }
+            auto& pending = ahead_uploads_->pending;
+            pending.insert(pending.end(), blobs.begin(), blobs.end());
+            if (pending.size() < kAheadUploadBatchSize) {
+                return;
+            }
+            if (not ahead_uploads_->uploader.joinable()) {
+                ahead_uploads_->uploader =
+                    std::thread([this]() { RunUploadsAhead(); });
+                ahead_uploads_->started = true;
+            }
+            ahead_uploads_->cv.notify_one();
+        } catch (std::exception const& ex) {
+            Logger::Log(logger_,
+                        LogLevel::Debug,
+                        "Uploading blobs ahead of building failed with:\n{}",
+                        ex.what());
+        }
+    }
+
+    /// \brief Get the state of prefetching blobs ahead of building.
+    [[nodiscard]] auto GetAheadUploadStats() const noexcept
+        -> AheadUploadStats {
+        std::unique_lock lock{ahead_uploads_->mutex};
+        auto const& ahead = *ahead_uploads_;
+        return AheadUploadStats{
+            .uploading = ahead.started and not ahead.stopped,
+            .uploaded = ahead.uploaded.size(),
+            .skipped = ahead.skipped};
     }
 
     [[nodiscard]] auto GetLocalApi() const -> gsl::not_null<IExecutionApi*> {
@@ -269,65 +347,236 @@ class GraphTraverser {
     progress_reporter_t reporter_;
     Logger const* logger_{nullptr};
 
-    /// \brief Reads contents of graph description file as json object. In case
-    /// the description is missing "blobs" or "actions" key/value pairs or they
-    /// can't be retrieved with the appropriate types, execution is terminated
-    /// after logging error
-    /// \returns A pair containing the blobs to upload (as a vector of strings)
-    /// and the actions as a json object.
+    // Blobs collected by, and already uploaded by, \ref UploadBlobsAhead
+    struct AheadUploads {
+        std::mutex mutex{};
+        std::condition_variable cv{};
+        std::vector<std::string> pending{};
+        std::unordered_set<ArtifactDigest> uploaded{};
+        std::size_t skipped{};
+        bool started{};
+        bool stopped{};
+        std::thread uploader{};
+    };
+    gsl::not_null<std::unique_ptr<AheadUploads>> ahead_uploads_{
+        std::make_unique<AheadUploads>()};
+
+    /// \brief Reads the blobs, trees, and actions of a graph description file.
+    /// The file is read entry by entry, so that only one tree or action is
+    /// held as JSON at a time. In case the description is missing "blobs",
+    /// "trees", or "actions" key/value pairs or they can't be retrieved with
+    /// the appropriate types, execution is terminated after logging error.
     [[nodiscard]] static auto ReadGraphDescription(
         std::filesystem::path const& graph_description,
-        Logger const* logger)
-        -> std::optional<
-            std::tuple<nlohmann::json, nlohmann::json, nlohmann::json>> {
-        auto const graph_description_opt = Json::ReadFile(graph_description);
-        if (not graph_description_opt.has_value()) {
+        gsl::not_null<std::vector<std::string>*> const& blobs,
+        gsl::not_null<std::vector<Tree::Ptr>*> const& trees,
+        gsl::not_null<std::vector<ActionDescription::Ptr>*> const& actions,
+        Logger const* logger) -> bool {
+        auto malformed = [&logger, &graph_description](std::string const& key) {
             Logger::Log(logger,
                         LogLevel::Error,
-                        "parsing graph from {}",
+                        "can not retrieve value for \"{}\" from graph "
+                        "description {}.",
+                        key,
                         graph_description.string());
-            return std::nullopt;
+            return false;
+        };
+        bool found_blobs{};
+        bool found_trees{};
+        bool found_actions{};
+        bool failed{};
+        auto decode = [&](std::vector<std::string> const& keys,
+                          nlohmann::json&& value) -> bool {
+            auto const& key = keys[0];
+            if (key == "blobs") {
+                failed = not value.is_array();
+                if (failed) {
+                    return malformed(key);
+                }
+                blobs->reserve(value.size());
+                for (auto& blob : value) {
+                    failed = not blob.is_string();
+                    if (failed) {
+                        return malformed(key);
+                    }
+                    blobs->emplace_back(
+                        std::move(blob.get_ref<std::string&>()));
+                }
+                found_blobs = true;
+            }
+            else if (key == "trees" or key == "actions") {
+                (key == "trees" ? found_trees : found_actions) = true;
+                if (keys.size() == 1) {
+                    // only empty objects are given as a whole
+                    failed = not value.is_object() or not value.empty();
+                    if (failed) {
+                        return malformed(key);
+                    }
+                }
+                else if (key == "trees") {
+                    auto tree = Tree::FromJson(keys[1], value);
+                    failed = not tree;
+                    if (failed) {
+                        return false;
+                    }
+                    trees->emplace_back(std::move(*tree));
+                }
+                else {
+                    auto action = ActionDescription::FromJson(keys[1], value);
+                    failed = not action;
+                    if (failed) {
+                        return false;  // Error already logged
+                    }
+                    actions->emplace_back(std::move(*action));
+                }
+            }
+            return true;
+        };
+        bool complete{};
+        try {
+            std::ifstream stream{graph_description};
+            complete = stream.good() and
+                       ReadJsonMembers(stream, /*depth=*/2, decode);
+        } catch (std::exception const& ex) {
+            Logger::Log(logger,
+                        LogLevel::Error,
+                        "parsing graph from {}:\n{}",
+                        graph_description.string(),
+                        ex.what());
+            return false;
         }
-        auto blobs_opt = ExtractValueAs<std::vector<std::string>>(
-            *graph_description_opt, "blobs", [logger](std::string const& s) {
+        if (not complete) {
+            if (not failed) {
                 Logger::Log(logger,
                             LogLevel::Error,
-                            "{}\ncan not retrieve value for \"blobs\" from "
-                            "graph description.",
-                            s);
-            });
-        auto trees_opt = ExtractValueAs<nlohmann::json>(
-            *graph_description_opt, "trees", [logger](std::string const& s) {
-                Logger::Log(logger,
-                            LogLevel::Error,
-                            "{}\ncan not retrieve value for \"trees\" from "
-                            "graph description.",
-                            s);
-            });
-        auto actions_opt = ExtractValueAs<nlohmann::json>(
-            *graph_description_opt, "actions", [logger](std::string const& s) {
-                Logger::Log(logger,
-                            LogLevel::Error,
-                            "{}\ncan not retrieve value for \"actions\" from "
-                            "graph description.",
-                            s);
-            });
-        if (not blobs_opt or not trees_opt or not actions_opt) {
-            return std::nullopt;
+                            "parsing graph from {}",
+                            graph_description.string());
+            }
+            return false;
+        }
+        if (not found_blobs) {
+            return malformed("blobs");
+        }
+        if (not found_trees) {
+            return malformed("trees");
         }
-        return std::make_tuple(std::move(*blobs_opt),
-                               std::move(*trees_opt),
-                               std::move(*actions_opt));
+        if (not found_actions) {
+            return malformed("actions");
+        }
+        return true;
+    }
+
+    [[nodiscard]] static auto ReadBinaryGraphDescription(
+        std::filesystem::path const& graph_description,
+        gsl::not_null<std::vector<std::string>*> const& blobs,
+        gsl::not_null<std::vector<Tree::Ptr>*> const& trees,
+        gsl::not_null<std::vector<ActionDescription::Ptr>*> const& actions,
+        Logger const* logger) -> bool {
+        auto content = FileSystemManager::ReadFile(graph_description);
+        auto reader = content ? BinaryGraph::Reader::Create(std::move(*content))
+                              : std::nullopt;
+        auto num_entries = reader ? reader->ReadObject() : std::nullopt;
+        if (not num_entries) {
+            Logger::Log(logger,
+                        LogLevel::Error,
+                        "parsing binary graph from {}",
+                        graph_description.string());
+            return false;
+        }
+        auto malformed = [&logger, &graph_description](std::string const& key) {
+            Logger::Log(logger,
+                        LogLevel::Error,
+                        "can not retrieve value for \"{}\" from binary graph "
+                        "description {}.",
+                        key,
+                        graph_description.string());
+            return false;
+        };
+        bool found_blobs{};
+        bool found_trees{};
+        bool found_actions{};
+        for (std::size_t i = 0; i < *num_entries; ++i) {
+            auto key = reader->ReadKey();
+            if (not key) {
+                return malformed("");
+            }
+            if (*key == "blobs") {
+                auto size = reader->ReadArray();
+                if (not size) {
+                    return malformed(*key);
+                }
+                blobs->reserve(*size);
+                for (std::size_t j = 0; j < *size; ++j) {
+                    auto blob = reader->ReadValue();
+                    if (not blob or not blob->is_string()) {
+                        return malformed(*key);
+                    }
+                    blobs->emplace_back(blob->get<std::string>());
+                }
+                found_blobs = true;
+            }
+            else if (*key == "trees" or *key == "actions") {
+                auto size = reader->ReadObject();
+                if (not size) {
+                    return malformed(*key);
+                }
+                for (std::size_t j = 0; j < *size; ++j) {
+                    auto id = reader->ReadKey();
+                    auto desc = id ? reader->ReadValue() : std::nullopt;
+                    if (not desc) {
+                        return malformed(*key);
+                    }
+                    if (*key == "trees") {
+                        auto tree = Tree::FromJson(*id, *desc);
+                        if (not tree) {
+                            return false;
+                        }
+                        trees->emplace_back(std::move(*tree));
+                    }
+                    else {
+                        auto action = ActionDescription::FromJson(*id, *desc);
+                        if (not action) {
+                            return false;  // Error already logged
+                        }
+                        actions->emplace_back(std::move(*action));
+                    }
+                }
+                (*key == "trees" ? found_trees : found_actions) = true;
+            }
+            else if (not reader->ReadValue()) {
+                return malformed(*key);
+            }
+        }
+        if (not found_blobs) {
+            return malformed("blobs");
+        }
+        if (not found_trees) {
+            return malformed("trees");
+        }
+        if (not found_actions) {
+            return malformed("actions");
+        }
+        return true;
     }
 
     /// \brief Requires for the executor to upload blobs to CAS. In the case any
-    /// of the uploads fails, execution is terminated
-    /// \param[in]  blobs   blobs to be uploaded
+    /// of the uploads fails, execution is terminated. Blobs already uploaded
+    /// by \ref UploadBlobsAhead are skipped.
+    /// \param[in]  blobs       blobs to be uploaded
+    /// \param[out] uploaded    optional, digests of the blobs uploaded
     [[nodiscard]] auto UploadBlobs(
-        std::vector<std::string> const& blobs) const noexcept -> bool {
+        std::vector<std::string> const& blobs,
+        std::vector<ArtifactDigest>* uploaded = nullptr) const noexcept
+        -> bool {
         ArtifactBlobContainer container;
         for (auto const& blob : blobs) {
             auto digest = ArtifactDigest::Create<ObjectType::File>(blob);
+            if (IsUploadedAhead(digest)) {
+                continue;
+            }
+            if (uploaded != nullptr) {
+                uploaded->emplace_back(digest);
+            }
             Logger::Log(logger_, LogLevel::Trace, [&]() {
                 return fmt::format(
                     "Uploaded blob {}, its digest has id {} and size {}.",
@@ -352,6 +601,65 @@ class GraphTraverser {
         return remote_api_->Upload(std::move(container));
     }
 
+    /// \brief Body of the uploader thread of \ref UploadBlobsAhead. Uploads
+    /// full batches of pending blobs until stopped.
+    void RunUploadsAhead() const noexcept {
+        try {
+            while (true) {
+                std::vector<std::string> batch{};
+                {
+                    std::unique_lock lock{ahead_uploads_->mutex};
+                    ahead_uploads_->cv.wait(lock, [this]() {
+                        return ahead_uploads_->stopped or
+                               ahead_uploads_->pending.size() >=
+                                   kAheadUploadBatchSize;
+                    });
+                    if (ahead_uploads_->stopped) {
+                        return;
+                    }
+                    batch.swap(ahead_uploads_->pending);
+                }
+                std::vector<ArtifactDigest> uploaded{};
+                if (UploadBlobs(batch, &uploaded)) {
+                    std::unique_lock lock{ahead_uploads_->mutex};
+                    ahead_uploads_->uploaded.insert(uploaded.begin(),
+                                                    uploaded.end());
+                }
+            }
+        } catch (std::exception const& ex) {
+            Logger::Log(logger_,
+                        LogLevel::Debug,
+                        "Uploading blobs ahead of building failed with:\n{}",
+                        ex.what());
+        }
+    }
+
+    /// \brief Stop uploading blobs ahead of building. Pending blobs are
+    /// dropped; an upload already running is waited for.
+    void StopUploadsAhead() const noexcept {
+        {
+            std::unique_lock lock{ahead_uploads_->mutex};
+            ahead_uploads_->stopped = true;
+            ahead_uploads_->pending.clear();
+        }
+        ahead_uploads_->cv.notify_all();
+        if (ahead_uploads_->uploader.joinable()) {
+            ahead_uploads_->uploader.join();
+        }
+    }
+
+    /// \brief Check whether a blob was uploaded ahead, counting it as skipped
+    /// if so.
+    [[nodiscard]] auto IsUploadedAhead(
+        ArtifactDigest const& digest) const noexcept -> bool {
+        std::unique_lock lock{ahead_uploads_->mutex};
+        if (ahead_uploads_->uploaded.contains(digest)) {
+            ++ahead_uploads_->skipped;
+            return true;
+        }
+        return false;
+    }
+
     /// \brief Adds the artifacts to be retrieved to the graph
     /// \param[in]  g   dependency graph
     /// \param[in]  artifacts   output artifact map
@@ -511,9 +819,9 @@ class GraphTraverser {
         gsl::not_null<DependencyGraph*> const& graph,
         std::map<std::string, ArtifactDescription> const& artifacts,
         std::map<std::string, ArtifactDescription> const& runfiles,
-        std::vector<ActionDescription::Ptr> const& actions,
-        std::vector<Tree::Ptr> const& trees,
-        std::vector<std::string> const& blobs,
+        std::vector<ActionDescription::Ptr>&& actions,
+        std::vector<Tree::Ptr>&& trees,
+        std::vector<std::string>&& blobs,
         std::vector<ArtifactDescription> const& extra_artifacts = {}) const
         -> std::optional<
             std::tuple<std::vector<std::filesystem::path>,
@@ -522,6 +830,7 @@ class GraphTraverser {
         if (not UploadBlobs(blobs)) {
             return std::nullopt;
         }
+        blobs = std::vector<std::string>{};
 
         auto artifact_infos =
             AddArtifactsToRetrieve(graph, artifacts, runfiles);
@@ -542,7 +851,8 @@ class GraphTraverser {
             tree_actions.emplace_back(tree->Action());
         }
 
-        if (not graph->Add(actions) or not graph->Add(tree_actions)) {
+        if (not graph->Add(actions, clargs_.jobs) or
+            not graph->Add(tree_actions)) {
             Logger::Log(logger_, LogLevel::Error, [&actions]() {
                 auto json = nlohmann::json::array();
                 for (auto const& desc : actions) {
@@ -556,6 +866,12 @@ class GraphTraverser {
             return std::nullopt;
         }
 
+        // The graph holds its own copies of the actions, so release the
+        // descriptions before building.
+        actions = std::vector<ActionDescription::Ptr>{};
+        trees = std::vector<Tree::Ptr>{};
+        tree_actions = std::vector<ActionDescription>{};
+
         if (clargs_.rebuild ? not TraverseRebuild(*graph, artifact_ids)
                             : not Traverse(*graph, artifact_ids)) {
             Logger::Log(logger_, LogLevel::Error, "Build failed.");
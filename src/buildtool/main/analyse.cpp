@@ -20,6 +20,7 @@
 
 #include "src/buildtool/build_engine/base_maps/directory_map.hpp"
 #include "src/buildtool/build_engine/base_maps/entity_name.hpp"
+#include "src/buildtool/build_engine/base_maps/expression_call_memo.hpp"
 #include "src/buildtool/build_engine/base_maps/expression_map.hpp"
 #include "src/buildtool/build_engine/base_maps/rule_map.hpp"
 #include "src/buildtool/build_engine/base_maps/source_map.hpp"
@@ -179,6 +180,16 @@ namespace Target = BuildMaps::Target;
     cv.notify_all();
     observer.join();
 
+    if (auto const& memo = Base::ExpressionCallMemo::Instance();
+        memo.IsEnabled()) {
+        Logger::Log(logger,
+                    LogLevel::Performance,
+                    "Expression call memo: {} hits, {} misses, {} bytes cached",
+                    memo.Hits(),
+                    memo.Misses(),
+                    memo.Bytes());
+    }
+
     if (failed) {
         return std::nullopt;
     }
@@ -24,6 +24,7 @@
 #include "src/buildtool/logging/log_level.hpp"
 #include "src/buildtool/logging/logger.hpp"
 #include "src/buildtool/main/exit_codes.hpp"
+#include "src/utils/cpp/lazy_json.hpp"
 #ifndef BOOTSTRAP_BUILD_TOOL
 #include "src/buildtool/execution_api/common/create_execution_api.hpp"
 #include "src/buildtool/execution_api/remote/config.hpp"
@@ -234,7 +235,7 @@ auto DescribeUserDefinedRule(
     bool print_json) -> int {
     bool failed{};
     auto rule_file_map = Base::CreateRuleFileMap(repo_config, jobs);
-    nlohmann::json rules_file;
+    LazyJsonObject rules_file{};
     {
         TaskSystem ts{jobs};
         rule_file_map.ConsumeAfterKeysReady(
@@ -251,18 +252,18 @@ auto DescribeUserDefinedRule(
     if (failed) {
         return kExitFailure;
     }
-    auto ruledesc_it = rules_file.find(rule_name.GetNamedTarget().name);
-    if (ruledesc_it == rules_file.end()) {
+    auto const* ruledesc = rules_file.Find(rule_name.GetNamedTarget().name);
+    if (ruledesc == nullptr) {
         Logger::Log(LogLevel::Error,
                     "Rule definition of {} is missing",
                     rule_name.ToString());
         return kExitFailure;
     }
     if (print_json) {
-        PrintRuleAsOrderedJson(*ruledesc_it, rule_name.ToJson());
+        PrintRuleAsOrderedJson(*ruledesc, rule_name.ToJson());
         return kExitSuccess;
     }
-    PrettyPrintRule(*ruledesc_it, rule_name, repo_config);
+    PrettyPrintRule(*ruledesc, rule_name, repo_config);
     return kExitSuccess;
 }
 
@@ -381,7 +382,7 @@ auto DescribeTarget(BuildMaps::Target::ConfiguredTarget const& id,
 
     // process with a present target root
     auto targets_file_map = Base::CreateTargetsFileMap(repo_config, jobs);
-    nlohmann::json targets_file{};
+    LazyJsonObject targets_file{};
     bool failed{false};
     {
         TaskSystem ts{jobs};
@@ -399,13 +400,14 @@ auto DescribeTarget(BuildMaps::Target::ConfiguredTarget const& id,
     if (failed) {
         return kExitFailure;
     }
-    auto desc_it = targets_file.find(id.target.GetNamedTarget().name);
-    if (desc_it == targets_file.end()) {
+    auto const* target_desc =
+        targets_file.Find(id.target.GetNamedTarget().name);
+    if (target_desc == nullptr) {
         std::cout << id.ToString() << " is implicitly a source file."
                   << std::endl;
         return kExitSuccess;
     }
-    nlohmann::json desc = *desc_it;
+    nlohmann::json desc = *target_desc;
     auto rule_it = desc.find("type");
     if (rule_it == desc.end()) {
         Logger::Log(LogLevel::Error,
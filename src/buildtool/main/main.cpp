@@ -26,7 +26,9 @@
 
 #include "gsl/gsl"
 #include "nlohmann/json.hpp"
+#include "src/buildtool/build_engine/base_maps/analysis_profile.hpp"
 #include "src/buildtool/build_engine/base_maps/entity_name.hpp"
+#include "src/buildtool/build_engine/base_maps/expression_call_memo.hpp"
 #include "src/buildtool/build_engine/expression/evaluator.hpp"
 #include "src/buildtool/build_engine/expression/expression.hpp"
 #include "src/buildtool/build_engine/target_map/target_map.hpp"
@@ -364,7 +366,7 @@ void SetupFileChunker() {
         }
         try {
             std::ifstream fs(clargs.config_file);
-            auto map = Expression::FromJson(nlohmann::json::parse(fs));
+            auto map = Expression::ParseJson(fs);
             if (not map->IsMap()) {
                 Logger::Log(LogLevel::Error,
                             "Config file {} does not contain a map.",
@@ -383,7 +385,7 @@ void SetupFileChunker() {
 
     for (auto const& s : clargs.defines) {
         try {
-            auto map = Expression::FromJson(nlohmann::json::parse(s));
+            auto map = Expression::ParseJson(s);
             if (not map->IsMap()) {
                 Logger::Log(LogLevel::Error,
                             "Defines entry {} does not contain a map.",
@@ -825,6 +827,18 @@ auto main(int argc, char* argv[]) -> int {
             Evaluator::SetExpressionLogLimit(
                 *arguments.analysis.expression_log_limit);
         }
+        if (arguments.analysis.parallel_foreach_threshold) {
+            Evaluator::SetParallelForeach(
+                *arguments.analysis.parallel_foreach_threshold,
+                arguments.common.jobs);
+        }
+        if (arguments.analysis.expression_call_memo_limit) {
+            BuildMaps::Base::ExpressionCallMemo::Instance().Enable(
+                *arguments.analysis.expression_call_memo_limit);
+        }
+        if (arguments.analysis.analysis_profile_file) {
+            BuildMaps::Base::AnalysisProfile::Instance().Enable();
+        }
 
         // global repository configuration
         RepositoryConfig repo_config{};
@@ -997,6 +1011,14 @@ auto main(int argc, char* argv[]) -> int {
                 arguments.common.jobs};
             auto id = ReadConfiguredTarget(
                 main_repo, main_ws_root, &repo_config, arguments.analysis);
+#ifndef BOOTSTRAP_BUILD_TOOL
+            if (arguments.cmd != SubCommand::kAnalyse) {
+                // Start uploading blobs while the analysis is still running
+                result_map.SetBlobsConsumer([&traverser](auto const& blobs) {
+                    traverser.UploadBlobsAhead(blobs);
+                });
+            }
+#endif  // BOOTSTRAP_BUILD_TOOL
             auto serve_errors = nlohmann::json::array();
             std::mutex serve_errors_access{};
             BuildMaps::Target::ServeFailureLogReporter collect_serve_errors =
@@ -1027,11 +1049,28 @@ auto main(int argc, char* argv[]) -> int {
                 std::ofstream os(*arguments.analysis.serve_errors_file);
                 os << serve_errors.dump() << std::endl;
             }
+            if (arguments.analysis.analysis_profile_file) {
+                auto const& profile =
+                    BuildMaps::Base::AnalysisProfile::Instance();
+                Logger::Log(LogLevel::Info,
+                            "Analysis profile (written to {}):\n{}",
+                            arguments.analysis.analysis_profile_file->string(),
+                            profile.ToTable(/*max_rows=*/10));
+                std::ofstream os(*arguments.analysis.analysis_profile_file);
+                os << profile.ToJson().dump(2) << std::endl;
+            }
             if (result) {
                 if (arguments.analysis.graph_file) {
                     result_map.ToFile(
                         *arguments.analysis.graph_file, &stats, &progress);
                 }
+                if (arguments.analysis.binary_graph_file and
+                    not result_map.ToBinaryFile(
+                        arguments.analysis.binary_graph_file->string(),
+                        &stats,
+                        &progress)) {
+                    return kExitFailure;
+                }
                 auto const [artifacts, runfiles] =
                     ReadOutputArtifacts(result->target);
                 if (arguments.analysis.artifacts_to_build_file) {
@@ -1073,18 +1112,20 @@ auto main(int argc, char* argv[]) -> int {
                 }
 
                 ReportTaintedness(*result);
-                auto const& [actions, blobs, trees] =
-                    result_map.ToResult(&stats, &progress);
 
                 // collect cache targets and artifacts for target-level caching
                 auto const cache_targets = result_map.CacheTargets();
                 auto cache_artifacts = CollectNonKnownArtifacts(cache_targets);
 
-                // Clean up result map, now that it is no longer needed
+                // release analysed targets while collecting their actions, and
+                // clean up the result map, now that it is no longer needed
+                BuildMaps::Target::ResultTargetMap::ResultType<> collected{};
                 {
                     TaskSystem ts{arguments.common.jobs};
+                    collected = result_map.TakeResult(&ts, &stats, &progress);
                     result_map.Clear(&ts);
                 }
+                auto& [actions, blobs, trees] = collected;
 
                 Logger::Log(
                     LogLevel::Info,
@@ -1098,9 +1139,9 @@ auto main(int argc, char* argv[]) -> int {
                 auto build_result =
                     traverser.BuildAndStage(artifacts,
                                             runfiles,
-                                            actions,
-                                            blobs,
-                                            trees,
+                                            std::move(actions),
+                                            std::move(blobs),
+                                            std::move(trees),
                                             std::move(cache_artifacts));
                 if (build_result) {
                     WriteTargetCacheEntries(
@@ -119,7 +119,7 @@ void ReadJustServeConfig(gsl::not_null<CommandLineArguments*> const& clargs) {
         // json::parse may throw
         try {
             std::ifstream fs(clargs->serve.config);
-            auto map = Expression::FromJson(nlohmann::json::parse(fs));
+            auto map = Expression::ParseJson(fs);
             if (not map->IsMap()) {
                 Logger::Log(LogLevel::Error,
                             "In serve service config file {}:\nExpected an "
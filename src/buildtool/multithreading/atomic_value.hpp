@@ -17,6 +17,7 @@
 
 #include <atomic>
 #include <functional>
+#include <memory>
 #include <optional>
 
 #include "src/utils/cpp/atomic.hpp"
@@ -53,6 +54,12 @@ class AtomicValue {
     [[nodiscard]] auto SetOnceAndGet(std::function<T()> const& setter) && =
         delete;
 
+    // Get the value if it is set already, without waiting for a value that is
+    // being set concurrently.
+    [[nodiscard]] auto GetIfSet() const noexcept -> std::shared_ptr<T const> {
+        return data_.load();
+    }
+
     // Reset, not thread-safe!
     void Reset() noexcept {
         load_ = false;
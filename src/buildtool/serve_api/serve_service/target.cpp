@@ -270,8 +270,8 @@ auto TargetService::ServeTarget(
 
     ExpressionPtr target_description_dict{};
     try {
-        target_description_dict = Expression::FromJson(
-            nlohmann::json::parse(*target_description_str));
+        target_description_dict =
+            Expression::ParseJson(*target_description_str);
     } catch (std::exception const& ex) {
         auto msg = fmt::format("Parsing TargetCacheKey {} failed with:\n{}",
                                target_cache_key_digest.hash(),
@@ -395,7 +395,7 @@ auto TargetService::ServeTarget(
     Configuration config{};
     try {
         config = Configuration{
-            Expression::FromJson(nlohmann::json::parse(config_expr->String()))};
+            Expression::ParseJson(config_expr->String())};
     } catch (std::exception const& ex) {
         auto msg = fmt::format(
             "TargetCacheKey {}: parsing \"effective_config\" failed with:\n{}",
@@ -463,19 +463,19 @@ auto TargetService::ServeTarget(
     // get the output artifacts
     auto const [artifacts, runfiles] = ReadOutputArtifacts(result->target);
 
-    // get the result map outputs
-    auto const& [actions, blobs, trees] =
-        result_map.ToResult(&stats, &progress, &logger);
-
     // collect cache targets and artifacts for target-level caching
     auto const cache_targets = result_map.CacheTargets();
     auto cache_artifacts = CollectNonKnownArtifacts(cache_targets);
 
-    // Clean up result map, now that it is no longer needed
+    // get the result map outputs, releasing the analysed targets, and clean up
+    // the result map, now that it is no longer needed
+    BuildMaps::Target::ResultTargetMap::ResultType<> collected{};
     {
         TaskSystem ts{RemoteServeConfig::Jobs()};
+        collected = result_map.TakeResult(&ts, &stats, &progress, &logger);
         result_map.Clear(&ts);
     }
+    auto& [actions, blobs, trees] = collected;
 
     auto jobs = RemoteServeConfig::BuildJobs();
     if (jobs == 0) {
@@ -499,8 +499,12 @@ auto TargetService::ServeTarget(
         &logger};
 
     // perform build
-    auto build_result = traverser.BuildAndStage(
-        artifacts, runfiles, actions, blobs, trees, std::move(cache_artifacts));
+    auto build_result = traverser.BuildAndStage(artifacts,
+                                                runfiles,
+                                                std::move(actions),
+                                                std::move(blobs),
+                                                std::move(trees),
+                                                std::move(cache_artifacts));
 
     if (not build_result) {
         // report failure locally, to keep track of it...
@@ -629,7 +633,7 @@ auto TargetService::ServeTargetVariables(
     // parse target file as json
     ExpressionPtr map{nullptr};
     try {
-        map = Expression::FromJson(nlohmann::json::parse(*target_file_content));
+        map = Expression::ParseJson(*target_file_content);
     } catch (std::exception const& e) {
         auto err = fmt::format(
             "Failed to parse targets file {} as json with error:\n{}",
@@ -787,7 +791,7 @@ auto TargetService::ServeTargetDescription(
     // parse target file as json
     ExpressionPtr map{nullptr};
     try {
-        map = Expression::FromJson(nlohmann::json::parse(*target_file_content));
+        map = Expression::ParseJson(*target_file_content);
     } catch (std::exception const& e) {
         auto err = fmt::format(
             "Failed to parse targets file {} as json with error:\n{}",
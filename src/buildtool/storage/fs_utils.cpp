@@ -87,6 +87,28 @@ auto GetResolvedTreeIDFile(std::string const& tree_hash,
            kPragmaSpecialInverseMap.at(pragma_special) / tree_hash;
 }
 
+auto GetRepoSetupRootFile(std::string const& repo_key) noexcept
+    -> std::filesystem::path {
+    return StorageConfig::BuildRoot() / "repo-setup-map" / repo_key;
+}
+
+auto GetSetupConfigIDFile(std::string const& fingerprint) noexcept
+    -> std::filesystem::path {
+    return StorageConfig::BuildRoot() / "setup-config-map" / fingerprint;
+}
+
+auto GetContentSizeFile(std::string const& content) noexcept
+    -> std::filesystem::path {
+    return StorageConfig::BuildRoot() / "content-size-map" / content;
+}
+
+auto GetRepositoryKeyFile(std::string const& config_digest,
+                          std::string const& repo_hash) noexcept
+    -> std::filesystem::path {
+    return StorageConfig::BuildRoot() / "repository-key-map" / config_digest /
+           repo_hash;
+}
+
 auto WriteTreeIDFile(std::filesystem::path const& tree_id_file,
                      std::string const& tree_id) noexcept -> bool {
     // needs to be done safely, so use the rename trick
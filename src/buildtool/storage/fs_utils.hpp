@@ -60,6 +60,27 @@ namespace StorageUtils {
     std::string const& tree_hash,
     PragmaSpecial const& pragma_special) noexcept -> std::filesystem::path;
 
+/// \brief Get the path to the file storing the workspace root that was set
+/// up for a repository description.
+[[nodiscard]] auto GetRepoSetupRootFile(std::string const& repo_key) noexcept
+    -> std::filesystem::path;
+
+/// \brief Get the path to the file storing the id of the setup configuration
+/// produced for a given fingerprint of the just-mr inputs.
+[[nodiscard]] auto GetSetupConfigIDFile(std::string const& fingerprint) noexcept
+    -> std::filesystem::path;
+
+/// \brief Get the path to the file storing the size, in bytes, of a content
+/// as observed when it was last fetched from the network.
+[[nodiscard]] auto GetContentSizeFile(std::string const& content) noexcept
+    -> std::filesystem::path;
+
+/// \brief Get the path to the file storing the key of a repository, given by
+/// the hash of its name, for a given digest of the repository configuration.
+[[nodiscard]] auto GetRepositoryKeyFile(std::string const& config_digest,
+                                        std::string const& repo_hash) noexcept
+    -> std::filesystem::path;
+
 /// \brief Write a tree id to file. The parent folder of the file must exist!
 [[nodiscard]] auto WriteTreeIDFile(std::filesystem::path const& tree_id_file,
                                    std::string const& tree_id) noexcept -> bool;
@@ -14,7 +14,9 @@
 
 #include "src/other_tools/git_operations/git_repo_remote.hpp"
 
+#include <algorithm>
 #include <cstddef>
+#include <sstream>
 #include <utility>  // std::move
 
 #include "fmt/core.h"
@@ -143,21 +145,27 @@ auto GitRepoRemote::GetCommitFromRemote(std::shared_ptr<git_config> cfg,
                                         std::string const& branch,
                                         anon_logger_ptr const& logger) noexcept
     -> std::optional<std::string> {
+    auto commits =
+        GetCommitsFromRemote(std::move(cfg), repo_url, {branch}, logger);
+    if (not commits) {
+        return std::nullopt;
+    }
+    return commits->front();
+}
+
+auto GitRepoRemote::GetCommitsFromRemote(
+    std::shared_ptr<git_config> cfg,
+    std::string const& repo_url,
+    std::vector<std::string> const& branches,
+    anon_logger_ptr const& logger) const noexcept
+    -> std::optional<std::vector<std::string>> {
     try {
-        // only possible for real repository!
-        if (IsRepoFake()) {
-            (*logger)("Cannot update commit using a fake repository!",
-                      true /*fatal*/);
-            return std::nullopt;
-        }
-        // create remote
+        // create a detached remote; listing refs needs no repository
         git_remote* remote_ptr{nullptr};
-        if (git_remote_create_anonymous(
-                &remote_ptr, GetRepoRef()->Ptr(), repo_url.c_str()) != 0) {
+        if (git_remote_create_detached(&remote_ptr, repo_url.c_str()) != 0) {
             (*logger)(
-                fmt::format("Creating anonymous remote for git repository {} "
-                            "failed with:\n{}",
-                            GetGitPath().string(),
+                fmt::format("Creating detached remote for {} failed with:\n{}",
+                            repo_url,
                             GitLastError()),
                 true /*fatal*/);
             git_remote_free(remote_ptr);
@@ -170,7 +178,7 @@ auto GitRepoRemote::GetCommitFromRemote(std::shared_ptr<git_config> cfg,
 
         // get a well-defined config file
         if (not cfg) {
-            // get config snapshot of current repo (shared with caller)
+            // get config snapshot of current repo
             cfg = GetConfigSnapshot();
             if (cfg == nullptr) {
                 (*logger)(fmt::format("Retrieving config object in get commit "
@@ -219,13 +227,10 @@ auto GitRepoRemote::GetCommitFromRemote(std::shared_ptr<git_config> cfg,
                                &callbacks,
                                &proxy_opts,
                                nullptr) != 0) {
-            (*logger)(
-                fmt::format("Connecting to remote {} for git repository {} "
-                            "failed with:\n{}",
-                            repo_url,
-                            GetGitPath().string(),
-                            GitLastError()),
-                true /*fatal*/);
+            (*logger)(fmt::format("Connecting to remote {} failed with:\n{}",
+                                  repo_url,
+                                  GitLastError()),
+                      true /*fatal*/);
             return std::nullopt;
         }
         // get the list of refs from remote
@@ -240,29 +245,38 @@ auto GitRepoRemote::GetCommitFromRemote(std::shared_ptr<git_config> cfg,
                 true /*fatal*/);
             return std::nullopt;
         }
-        // figure out what remote branch the local one is tracking
-        for (size_t i = 0; i < refs_len; ++i) {
-            // by treating each read reference string as a path we can easily
-            // check for the branch name
-            // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-            std::filesystem::path ref_name_as_path{refs[i]->name};
-            if (ref_name_as_path.filename() == branch) {
-                // branch found!
+        // resolve all requested branches from the single refs listing
+        std::vector<std::string> commits{};
+        commits.reserve(branches.size());
+        for (auto const& branch : branches) {
+            std::optional<std::string> commit{std::nullopt};
+            for (std::size_t i = 0; i < refs_len; ++i) {
+                // by treating each read reference string as a path we can
+                // easily check for the branch name
                 // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-                std::string new_commit_hash{git_oid_tostr_s(&refs[i]->oid)};
-                return new_commit_hash;
+                std::filesystem::path ref_name_as_path{refs[i]->name};
+                if (ref_name_as_path.filename() == branch) {
+                    // branch found!
+                    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+                    commit = std::string{git_oid_tostr_s(&refs[i]->oid)};
+                    break;
+                }
             }
+            if (not commit) {
+                (*logger)(fmt::format("Could not find branch {} for remote {}",
+                                      branch,
+                                      repo_url),
+                          true /*fatal*/);
+                return std::nullopt;
+            }
+            commits.emplace_back(*std::move(commit));
         }
-        (*logger)(fmt::format("Could not find branch {} for remote {}",
-                              branch,
-                              repo_url,
-                              GitLastError()),
-                  true /*fatal*/);
-        return std::nullopt;
+        return commits;
     } catch (std::exception const& ex) {
         Logger::Log(LogLevel::Error,
-                    "Get commit from branch {} of remote {} failed with:\n{}",
-                    branch,
+                    "Get commits of branches {} from remote {} failed "
+                    "with:\n{}",
+                    nlohmann::json(branches).dump(),
                     repo_url,
                     ex.what());
         return std::nullopt;
@@ -404,51 +418,54 @@ auto GitRepoRemote::UpdateCommitViaTmpRepo(
     std::vector<std::string> const& launcher,
     anon_logger_ptr const& logger) const noexcept
     -> std::optional<std::string> {
+    auto commits = UpdateCommits(
+        repo_url, {branch}, inherit_env, git_bin, launcher, logger);
+    if (not commits) {
+        return std::nullopt;
+    }
+    return commits->front();
+}
+
+auto GitRepoRemote::UpdateCommits(std::string const& repo_url,
+                                  std::vector<std::string> const& branches,
+                                  std::vector<std::string> const& inherit_env,
+                                  std::string const& git_bin,
+                                  std::vector<std::string> const& launcher,
+                                  anon_logger_ptr const& logger) const noexcept
+    -> std::optional<std::vector<std::string>> {
     try {
-        auto tmp_dir = StorageConfig::CreateTypedTmpDir("update");
-        if (not tmp_dir) {
-            (*logger)("Failed to create temp dir for running 'git ls-remote'",
-                      /*fatal=*/true);
-            return std::nullopt;
-        }
-        auto const& tmp_path = tmp_dir->GetPath();
         // check for internally supported protocols
         if (IsSupported(repo_url)) {
-            // preferably with a "fake" repository!
-            if (not IsRepoFake()) {
-                Logger::Log(LogLevel::Debug,
-                            "Commit update called on a real repository");
-            }
-            // create the temporary real repository
-            auto tmp_repo =
-                GitRepoRemote::InitAndOpen(tmp_path / "git", /*is_bare=*/true);
-            if (tmp_repo == std::nullopt) {
-                return std::nullopt;
-            }
             // setup wrapped logger
             auto wrapped_logger = std::make_shared<anon_logger_t>(
                 [logger](auto const& msg, bool fatal) {
                     (*logger)(
-                        fmt::format(
-                            "While doing commit update via tmp repo:\n{}", msg),
+                        fmt::format("While doing commits update:\n{}", msg),
                         fatal);
                 });
             // get the config of the correct target repo
             auto cfg = GetConfigSnapshot();
             if (cfg == nullptr) {
-                (*logger)(
-                    fmt::format("Retrieving config object in update commit "
-                                "via tmp repo failed with:\n{}",
-                                GitLastError()),
-                    true /*fatal*/);
+                (*logger)(fmt::format("Retrieving config object in update "
+                                      "commits failed with:\n{}",
+                                      GitLastError()),
+                          true /*fatal*/);
                 return std::nullopt;
             }
-            return tmp_repo->GetCommitFromRemote(
-                cfg, repo_url, branch, wrapped_logger);
+            return GetCommitsFromRemote(
+                cfg, repo_url, branches, wrapped_logger);
         }
         // default to shelling out to git for non-explicitly supported protocols
+        auto tmp_dir = StorageConfig::CreateTypedTmpDir("update");
+        if (not tmp_dir) {
+            (*logger)("Failed to create temp dir for running 'git ls-remote'",
+                      /*fatal=*/true);
+            return std::nullopt;
+        }
+        auto const& tmp_path = tmp_dir->GetPath();
         auto cmdline = launcher;
-        cmdline.insert(cmdline.end(), {git_bin, "ls-remote", repo_url, branch});
+        cmdline.insert(cmdline.end(), {git_bin, "ls-remote", repo_url});
+        cmdline.insert(cmdline.end(), branches.begin(), branches.end());
         Logger::Log(
             LogLevel::Debug,
             "Git commit update for remote {} must shell out. Running:\n{}",
@@ -508,30 +525,84 @@ auto GitRepoRemote::UpdateCommitViaTmpRepo(
 
             return std::nullopt;
         }
-        // parse the output: it should contain two tab-separated columns,
-        // with the commit being the first entry
-        auto str_len = out_str.find('\t');
-        if (str_len == std::string::npos) {
-            (*logger)(fmt::format("List remote commits command {} produced "
-                                  "malformed output:\n{}",
-                                  nlohmann::json(cmdline).dump(),
-                                  out_str),
-                      /*fatal=*/true);
-            return std::nullopt;
-        }
-        // success!
-        return out_str.substr(0, str_len);
+        // parse the output for the commits of all branches
+        auto wrapped_logger = std::make_shared<anon_logger_t>(
+            [logger, &cmdline](auto const& msg, bool fatal) {
+                (*logger)(fmt::format("While parsing output of list remote "
+                                      "commits command {}:\n{}",
+                                      nlohmann::json(cmdline).dump(),
+                                      msg),
+                          fatal);
+            });
+        return ParseLsRemoteOutput(out_str, branches, wrapped_logger);
     } catch (std::exception const& ex) {
         Logger::Log(LogLevel::Error,
-                    "Update commit from branch {} of remote {} via tmp dir "
-                    "failed with:\n{}",
-                    branch,
+                    "Update commits of branches {} from remote {} failed "
+                    "with:\n{}",
+                    nlohmann::json(branches).dump(),
                     repo_url,
                     ex.what());
         return std::nullopt;
     }
 }
 
+auto GitRepoRemote::ParseLsRemoteOutput(
+    std::string const& output,
+    std::vector<std::string> const& branches,
+    anon_logger_ptr const& logger) noexcept
+    -> std::optional<std::vector<std::string>> {
+    try {
+        // each line should contain two tab-separated columns, the commit and
+        // the reference name
+        std::vector<std::pair<std::string, std::string>> listed_refs{};
+        std::istringstream out_stream{output};
+        std::string line{};
+        while (std::getline(out_stream, line)) {
+            if (line.empty()) {
+                continue;
+            }
+            auto str_len = line.find('\t');
+            if (str_len == std::string::npos) {
+                (*logger)(fmt::format("Malformed output line:\n{}", line),
+                          /*fatal=*/true);
+                return std::nullopt;
+            }
+            listed_refs.emplace_back(line.substr(0, str_len),
+                                     line.substr(str_len + 1));
+        }
+        // as for a single pattern, take for each branch the first listed
+        // reference it matches, i.e., of which it is a path tail
+        std::vector<std::string> commits{};
+        commits.reserve(branches.size());
+        for (auto const& branch : branches) {
+            auto it = std::find_if(
+                listed_refs.begin(),
+                listed_refs.end(),
+                [&branch](auto const& entry) {
+                    auto const& ref = entry.second;
+                    return ref == branch or
+                           (ref.size() > branch.size() and
+                            ref.ends_with(branch) and
+                            ref[ref.size() - branch.size() - 1] == '/');
+                });
+            if (it == listed_refs.end()) {
+                (*logger)(fmt::format("Branch {} was not reported", branch),
+                          /*fatal=*/true);
+                return std::nullopt;
+            }
+            commits.emplace_back(it->first);
+        }
+        // success!
+        return commits;
+    } catch (std::exception const& ex) {
+        (*logger)(
+            fmt::format("Parsing ls-remote output failed with:\n{}",
+                        ex.what()),
+            /*fatal=*/true);
+        return std::nullopt;
+    }
+}
+
 auto GitRepoRemote::FetchViaTmpRepo(std::string const& repo_url,
                                     std::optional<std::string> const& branch,
                                     std::vector<std::string> const& inherit_env,
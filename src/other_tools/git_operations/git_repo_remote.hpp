@@ -55,7 +55,6 @@ class GitRepoRemote : public GitRepo {
         bool is_bare) noexcept -> std::optional<GitRepoRemote>;
 
     /// \brief Retrieve commit hash from remote branch given its name.
-    /// Only possible with real repository and thus non-thread-safe.
     /// If non-null, use given config snapshot to interact with config entries;
     /// otherwise, use a snapshot from the current repo and share pointer to it.
     /// Returns the retrieved commit hash, or nullopt if failure.
@@ -66,6 +65,22 @@ class GitRepoRemote : public GitRepo {
         std::string const& branch,
         anon_logger_ptr const& logger) noexcept -> std::optional<std::string>;
 
+    /// \brief Retrieve the commit hashes of several remote branches, given by
+    /// name, from a single listing of the remote references. Uses a detached
+    /// remote, so no repository is needed and this is thread-safe also for
+    /// fake repositories.
+    /// If non-null, use given config snapshot to interact with config entries;
+    /// otherwise, use a snapshot from the current repo.
+    /// Returns the commit hashes in the order of the given branches, or
+    /// nullopt if failure.
+    /// It guarantees the logger is called exactly once with fatal if failure.
+    [[nodiscard]] auto GetCommitsFromRemote(
+        std::shared_ptr<git_config> cfg,
+        std::string const& repo_url,
+        std::vector<std::string> const& branches,
+        anon_logger_ptr const& logger) const noexcept
+        -> std::optional<std::vector<std::string>>;
+
     /// \brief Fetch from given remote. It can either fetch a given named
     /// branch, or it can fetch with base refspecs.
     /// Only possible with real repository and thus non-thread-safe.
@@ -95,6 +110,34 @@ class GitRepoRemote : public GitRepo {
         anon_logger_ptr const& logger) const noexcept
         -> std::optional<std::string>;
 
+    /// \brief Get the commits of several branches on the same remote with a
+    /// single ls-remote query. If URL is SSH, shells out to system git to
+    /// perform one ls-remote call for all branches. For non-SSH URLs, the
+    /// remote references are listed once using libgit2, without creating any
+    /// temporary repository.
+    /// Returns the commit hashes, in the order of the given branches, or
+    /// nullopt if failure.
+    /// It guarantees the logger is called exactly once with fatal if failure.
+    [[nodiscard]] auto UpdateCommits(
+        std::string const& repo_url,
+        std::vector<std::string> const& branches,
+        std::vector<std::string> const& inherit_env,
+        std::string const& git_bin,
+        std::vector<std::string> const& launcher,
+        anon_logger_ptr const& logger) const noexcept
+        -> std::optional<std::vector<std::string>>;
+
+    /// \brief Get the commits of the given branches from the output of an
+    /// ls-remote query, in the order of the branches. For each branch, the
+    /// first listed reference of which it is a path tail is taken.
+    /// Returns nullopt if the output is malformed or a branch is not listed.
+    /// It guarantees the logger is called exactly once with fatal if failure.
+    [[nodiscard]] static auto ParseLsRemoteOutput(
+        std::string const& output,
+        std::vector<std::string> const& branches,
+        anon_logger_ptr const& logger) noexcept
+        -> std::optional<std::vector<std::string>>;
+
     /// \brief Fetch from a remote. If URL is SSH, shells out to system git to
     /// retrieve packs in a safe manner, with the only side-effect being that
     /// there can be some redundancy in the fetched packs.
@@ -80,6 +80,7 @@ struct MultiRepoFetchArguments {
 
 struct MultiRepoUpdateArguments {
     std::vector<std::string> repos_to_update{};
+    std::optional<std::size_t> max_connections_per_host{std::nullopt};
 };
 
 struct MultiRepoJustSubCmdsArguments {
@@ -329,6 +330,11 @@ static inline void SetupMultiRepoFetchArguments(
 static inline void SetupMultiRepoUpdateArguments(
     gsl::not_null<CLI::App*> const& app,
     gsl::not_null<MultiRepoUpdateArguments*> const& clargs) {
+    app->add_option("--max-connections-per-host",
+                    clargs->max_connections_per_host,
+                    "Maximal number of remotes of the same host to query at "
+                    "the same time (Default: 4).")
+        ->type_name("NUM");
     // take all remaining args as positional
     app->add_option("repo", clargs->repos_to_update, "Repository to update.")
         ->type_name("");
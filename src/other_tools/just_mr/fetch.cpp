@@ -15,18 +15,22 @@
 #include "src/other_tools/just_mr/fetch.hpp"
 
 #include <filesystem>
+#include <string>
 #include <utility>  // std::move
 
 #include "fmt/core.h"
 #include "nlohmann/json.hpp"
 #include "src/buildtool/execution_api/common/execution_api.hpp"
 #include "src/buildtool/execution_api/local/local_api.hpp"
+#include "src/buildtool/file_system/file_system_manager.hpp"
 #include "src/buildtool/logging/log_level.hpp"
 #include "src/buildtool/logging/logger.hpp"
 #include "src/buildtool/multithreading/task_system.hpp"
 #include "src/other_tools/just_mr/exit_codes.hpp"
+#include "src/other_tools/just_mr/fetch_order.hpp"
 #include "src/other_tools/just_mr/progress_reporting/progress.hpp"
 #include "src/other_tools/just_mr/progress_reporting/progress_reporter.hpp"
+#include "src/other_tools/just_mr/progress_reporting/statistics.hpp"
 #include "src/other_tools/just_mr/setup_utils.hpp"
 #include "src/other_tools/ops_maps/archive_fetch_map.hpp"
 #include "src/other_tools/ops_maps/content_cas_map.hpp"
@@ -389,6 +393,9 @@ auto MultiRepoFetch(std::shared_ptr<Configuration> const& config,
         Logger::Log(LogLevel::Info, "Found {} to fetch", fetchables);
     }
 
+    // schedule the largest archives first, as far as their sizes are known
+    JustMR::Utils::SortLargestFirst(&archives_to_fetch);
+
     // setup the APIs for archive fetches; only happens if in native mode
     auto remote_api =
         JustMR::Utils::GetRemoteApi(common_args.remote_execution_address,
@@ -517,6 +524,15 @@ auto MultiRepoFetch(std::shared_ptr<Configuration> const& config,
     cv.notify_all();
     observer.join();
 
+    // report the bytes fetched from the network, per mirror
+    for (auto const& [mirror, bytes] :
+         JustMRStatistics::Instance().FetchedBytes()) {
+        Logger::Log(LogLevel::Info,
+                    "Fetched {} from {}",
+                    JustMRProgressReporter::FormatBytes(bytes),
+                    mirror);
+    }
+
     if (failed_archives or failed_git_trees) {
         return kExitFetchError;
     }
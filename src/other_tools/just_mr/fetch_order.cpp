@@ -0,0 +1,67 @@
+// Copyright 2023 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/other_tools/just_mr/fetch_order.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <unordered_map>
+
+#include "src/buildtool/common/artifact_digest.hpp"
+#include "src/buildtool/file_system/file_system_manager.hpp"
+#include "src/buildtool/storage/fs_utils.hpp"
+#include "src/buildtool/storage/storage.hpp"
+
+namespace JustMR::Utils {
+
+auto KnownContentSize(std::string const& content) noexcept
+    -> std::optional<std::uintmax_t> {
+    try {
+        auto const& cas = Storage::Instance().CAS();
+        if (auto path = cas.BlobPath(ArtifactDigest{content, 0, false},
+                                     /*is_executable=*/false)) {
+            return std::filesystem::file_size(*path);
+        }
+        auto size_file = StorageUtils::GetContentSizeFile(content);
+        if (FileSystemManager::IsFile(size_file)) {
+            if (auto size = FileSystemManager::ReadFile(size_file)) {
+                return std::stoull(*size);
+            }
+        }
+    } catch (...) {
+        // size unknown, e.g., due to a malformed record
+    }
+    return std::nullopt;
+}
+
+void SortLargestFirst(
+    gsl::not_null<std::vector<ArchiveContent>*> const& archives,
+    ContentSizeFunc const& size_of) {
+    std::unordered_map<std::string, std::optional<std::uintmax_t>> sizes{};
+    for (auto const& archive : *archives) {
+        if (not sizes.contains(archive.content)) {
+            sizes.emplace(archive.content, size_of(archive.content));
+        }
+    }
+    std::stable_sort(archives->begin(),
+                     archives->end(),
+                     [&sizes](auto const& lhs, auto const& rhs) {
+                         auto const& lhs_size = sizes.at(lhs.content);
+                         auto const& rhs_size = sizes.at(rhs.content);
+                         return lhs_size and
+                                (not rhs_size or *lhs_size > *rhs_size);
+                     });
+}
+
+}  // namespace JustMR::Utils
@@ -0,0 +1,50 @@
+// Copyright 2023 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_SRC_OTHER_TOOLS_JUST_MR_FETCH_ORDER_HPP
+#define INCLUDED_SRC_OTHER_TOOLS_JUST_MR_FETCH_ORDER_HPP
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "gsl/gsl"
+#include "src/other_tools/ops_maps/content_cas_map.hpp"
+
+/* Scheduling of archive fetches in just-mr */
+
+namespace JustMR::Utils {
+
+using ContentSizeFunc =
+    std::function<std::optional<std::uintmax_t>(std::string const&)>;
+
+/// \brief Best known size of a content to fetch: the size of the blob in
+/// local CAS, or else the size recorded when it was last fetched from the
+/// network.
+/// \returns The size in bytes, or nullopt if it is not known.
+[[nodiscard]] auto KnownContentSize(std::string const& content) noexcept
+    -> std::optional<std::uintmax_t>;
+
+/// \brief Order archives to fetch by size, largest first, so that a large
+/// fetch does not start last and determine the total time. Archives of
+/// unknown size follow those of known size, in their original order.
+void SortLargestFirst(
+    gsl::not_null<std::vector<ArchiveContent>*> const& archives,
+    ContentSizeFunc const& size_of = KnownContentSize);
+
+}  // namespace JustMR::Utils
+
+#endif  // INCLUDED_SRC_OTHER_TOOLS_JUST_MR_FETCH_ORDER_HPP
@@ -65,25 +65,47 @@ auto CallJust(std::optional<std::filesystem::path> const& config_file,
             if (not lock) {
                 return kExitGenericFailure;
             }
-            auto config = JustMR::Utils::ReadConfiguration(
-                config_file, common_args.absent_repository_file);
-
             use_config = true;
-            mr_config_path = MultiRepoSetup(config,
-                                            common_args,
-                                            setup_args,
-                                            just_cmd_args,
-                                            auth_args,
-                                            /*interactive=*/false,
-                                            std::move(multi_repo_tool_name));
-            if (not mr_config_path) {
-                Logger::Log(LogLevel::Error,
-                            "Failed to setup config for calling \"{} {}\"",
-                            common_args.just_path
-                                ? common_args.just_path->string()
-                                : kDefaultJustPath,
-                            *subcommand);
-                return kExitSetupError;
+            // if all inputs of setup are unchanged, reuse the previous result
+            auto fingerprint = JustMR::Utils::ComputeSetupFingerprint(
+                config_file, common_args, setup_args);
+            if (fingerprint) {
+                mr_config_path =
+                    JustMR::Utils::ReadSetupConfigCache(*fingerprint);
+            }
+            if (mr_config_path) {
+                Logger::Log(LogLevel::Info,
+                            "Reusing setup configuration {} of unchanged "
+                            "inputs",
+                            mr_config_path->string());
+            }
+            else {
+                auto config = JustMR::Utils::ReadConfiguration(
+                    config_file, common_args.absent_repository_file);
+
+                mr_config_path =
+                    MultiRepoSetup(config,
+                                   common_args,
+                                   setup_args,
+                                   just_cmd_args,
+                                   auth_args,
+                                   /*interactive=*/false,
+                                   std::move(multi_repo_tool_name));
+                if (not mr_config_path) {
+                    Logger::Log(
+                        LogLevel::Error,
+                        "Failed to setup config for calling \"{} {}\"",
+                        common_args.just_path ? common_args.just_path->string()
+                                              : kDefaultJustPath,
+                        *subcommand);
+                    return kExitSetupError;
+                }
+                if (fingerprint and
+                    JustMR::Utils::IsSetupReusable(config,
+                                                   common_args.fetch_absent)) {
+                    JustMR::Utils::WriteSetupConfigCache(*fingerprint,
+                                                         *mr_config_path);
+                }
             }
         }
         use_build_root = kKnownJustSubcommands.at(*subcommand).build_root;
@@ -144,7 +166,7 @@ auto CallJust(std::optional<std::filesystem::path> const& config_file,
         auto overlay_config = Configuration();
         for (auto const& s : common_args.defines) {
             try {
-                auto map = Expression::FromJson(nlohmann::json::parse(s));
+                auto map = Expression::ParseJson(s);
                 if (not map->IsMap()) {
                     Logger::Log(LogLevel::Error,
                                 "Defines entry {} does not contain a map.",
@@ -15,8 +15,13 @@
 #ifndef INCLUDED_SRC_OTHER_TOOLS_JUST_MR_PROGRESS_REPORTING_PROGRESS_HPP
 #define INCLUDED_SRC_OTHER_TOOLS_JUST_MR_PROGRESS_REPORTING_PROGRESS_HPP
 
+#include <chrono>
+#include <cstddef>
 #include <cstdlib>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -38,9 +43,64 @@ class JustMRProgress {
 
     void SetTotal(int total) noexcept { total_ = total; }
 
+    /// \brief State of an ongoing network transfer.
+    struct Transfer {
+        std::size_t bytes{};        // bytes received so far
+        double bytes_per_second{};  // average throughput since start
+    };
+
+    /// \brief Record the number of bytes received so far by the network
+    /// transfer of the task with the given id.
+    void TransferProgress(std::string const& id, std::size_t bytes) noexcept {
+        try {
+            std::unique_lock lock{transfers_mutex_};
+            auto now = std::chrono::steady_clock::now();
+            auto [it, is_new] = transfers_.emplace(id, TransferState{now, 0});
+            // a retry, e.g., from another mirror, restarts the transfer
+            if (bytes < it->second.bytes) {
+                it->second.start = now;
+            }
+            it->second.bytes = bytes;
+        } catch (...) {
+            // progress information is best effort only
+        }
+    }
+
+    /// \brief Forget the network transfer of the task with the given id.
+    void TransferDone(std::string const& id) noexcept {
+        std::unique_lock lock{transfers_mutex_};
+        transfers_.erase(id);
+    }
+
+    /// \brief Get the state of the network transfer of the task with the
+    /// given id, if there is one ongoing.
+    [[nodiscard]] auto GetTransfer(std::string const& id) noexcept
+        -> std::optional<Transfer> {
+        std::unique_lock lock{transfers_mutex_};
+        auto it = transfers_.find(id);
+        if (it == transfers_.end()) {
+            return std::nullopt;
+        }
+        std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - it->second.start;
+        return Transfer{
+            .bytes = it->second.bytes,
+            .bytes_per_second =
+                elapsed.count() > 0
+                    ? static_cast<double>(it->second.bytes) / elapsed.count()
+                    : 0.0};
+    }
+
   private:
+    struct TransferState {
+        std::chrono::steady_clock::time_point start{};
+        std::size_t bytes{};
+    };
+
     ::TaskTracker task_tracker_{};
     int total_{};
+    std::mutex transfers_mutex_{};
+    std::unordered_map<std::string, TransferState> transfers_{};
 };
 
 #endif  // INCLUDED_SRC_OTHER_TOOLS_JUST_MR_PROGRESS_REPORTING_PROGRESS_HPP
@@ -14,6 +14,8 @@
 
 #include "src/other_tools/just_mr/progress_reporting/progress_reporter.hpp"
 
+#include <array>
+#include <cstddef>
 #include <optional>
 #include <string>
 
@@ -37,10 +39,19 @@ auto JustMRProgressReporter::Reporter() noexcept -> progress_reporter_t {
         std::string msg;
         msg = fmt::format("{} local, {} cached, {} done", local, cached, run);
         if ((active > 0) && !sample.empty()) {
-            msg = fmt::format("{}; {} fetches ({}{})",
+            std::string transfer{};
+            if (auto state = JustMRProgress::Instance().GetTransfer(sample)) {
+                transfer = fmt::format(
+                    ", {} at {}/s",
+                    FormatBytes(state->bytes),
+                    FormatBytes(
+                        static_cast<std::size_t>(state->bytes_per_second)));
+            }
+            msg = fmt::format("{}; {} fetches ({}{}{})",
                               msg,
                               active,
                               nlohmann::json(sample).dump(),
+                              transfer,
                               active > 1 ? ", ..." : "");
         }
         constexpr int kOneHundred{100};
@@ -52,3 +63,19 @@ auto JustMRProgressReporter::Reporter() noexcept -> progress_reporter_t {
         Logger::Log(LogLevel::Progress, "[{:3}%] {}", progress, msg);
     });
 }
+
+auto JustMRProgressReporter::FormatBytes(std::size_t bytes) noexcept
+    -> std::string {
+    constexpr std::array<char const*, 4> kUnits{"KiB", "MiB", "GiB", "TiB"};
+    constexpr double kStep{1024.0};
+    if (static_cast<double>(bytes) < kStep) {
+        return fmt::format("{} B", bytes);
+    }
+    auto value = static_cast<double>(bytes) / kStep;
+    std::size_t unit = 0;
+    while (value >= kStep and unit + 1 < kUnits.size()) {
+        value /= kStep;
+        ++unit;
+    }
+    return fmt::format("{:.1f} {}", value, kUnits.at(unit));
+}
@@ -15,11 +15,18 @@
 #ifndef INCLUDED_SRC_OTHER_TOOLS_JUST_MR_PROGRESS_REPORTING_PROGRESS_REPORTER_HPP
 #define INCLUDED_SRC_OTHER_TOOLS_JUST_MR_PROGRESS_REPORTING_PROGRESS_REPORTER_HPP
 
+#include <cstddef>
+#include <string>
+
 #include "src/buildtool/progress_reporting/base_progress_reporter.hpp"
 
 class JustMRProgressReporter {
   public:
     [[nodiscard]] static auto Reporter() noexcept -> progress_reporter_t;
+
+    /// \brief Human-readable representation of a number of bytes.
+    [[nodiscard]] static auto FormatBytes(std::size_t bytes) noexcept
+        -> std::string;
 };
 
 #endif  // INCLUDED_SRC_OTHER_TOOLS_JUST_MR_PROGRESS_REPORTING_PROGRESS_REPORTER_HPP
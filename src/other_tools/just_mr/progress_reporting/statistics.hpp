@@ -16,6 +16,10 @@
 #define INCLUDED_SRC_OTHER_TOOLS_JUST_MR_PROGRESS_REPORTING_STATISTICS_HPP
 
 #include <atomic>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
 
 class JustMRStatistics {
   public:
@@ -28,11 +32,24 @@ class JustMRStatistics {
         num_local_paths_ = 0;
         num_cache_hits_ = 0;
         num_executed_ = 0;
+        std::unique_lock lock{fetched_bytes_mutex_};
+        fetched_bytes_.clear();
     }
     void IncrementLocalPathsCounter() noexcept { ++num_local_paths_; }
     void IncrementCacheHitsCounter() noexcept { ++num_cache_hits_; }
     void IncrementExecutedCounter() noexcept { ++num_executed_; }
 
+    /// \brief Account bytes fetched over the network from the given mirror.
+    void AddFetchedBytes(std::string const& mirror,
+                         std::size_t bytes) noexcept {
+        try {
+            std::unique_lock lock{fetched_bytes_mutex_};
+            fetched_bytes_[mirror] += bytes;
+        } catch (...) {
+            // statistics are best effort only
+        }
+    }
+
     [[nodiscard]] auto LocalPathsCounter() const noexcept -> int {
         return num_local_paths_;
     }
@@ -42,11 +59,17 @@ class JustMRStatistics {
     [[nodiscard]] auto ExecutedCounter() const noexcept -> int {
         return num_executed_;
     }
+    [[nodiscard]] auto FetchedBytes() -> std::map<std::string, std::size_t> {
+        std::unique_lock lock{fetched_bytes_mutex_};
+        return fetched_bytes_;
+    }
 
   private:
     std::atomic<int> num_local_paths_{};  // roots that are actual paths
     std::atomic<int> num_cache_hits_{};   // no-ops
     std::atomic<int> num_executed_{};     // actual work done
+    std::mutex fetched_bytes_mutex_{};
+    std::map<std::string, std::size_t> fetched_bytes_{};  // bytes per mirror
 };
 
 #endif  // INCLUDED_SRC_OTHER_TOOLS_JUST_MR_PROGRESS_REPORTING_STATISTICS_HPP
@@ -104,7 +104,7 @@ namespace {
             // json::parse may throw
             try {
                 std::ifstream fs(*rc_path);
-                auto map = Expression::FromJson(nlohmann::json::parse(fs));
+                auto map = Expression::ParseJson(fs);
                 if (not map->IsMap()) {
                     Logger::Log(
                         LogLevel::Error,
@@ -154,8 +154,7 @@ namespace {
                     Configuration extra_rc_config{};
                     try {
                         std::ifstream fs(extra_rc_path);
-                        auto map =
-                            Expression::FromJson(nlohmann::json::parse(fs));
+                        auto map = Expression::ParseJson(fs);
                         if (not map->IsMap()) {
                             Logger::Log(LogLevel::Error,
                                         "In extra RC file {}: expected an "
@@ -235,7 +235,6 @@ auto MultiRepoSetup(std::shared_ptr<Configuration> const& config,
 
     auto distdir_git_map =
         CreateDistdirGitMap(&content_cas_map,
-                            &import_to_git_map,
                             &critical_git_op_map,
                             serve_api_exists,
                             &(*local_api),
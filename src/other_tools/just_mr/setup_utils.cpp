@@ -15,6 +15,7 @@
 #include "src/other_tools/just_mr/setup_utils.hpp"
 
 #include <fstream>
+#include <map>
 #include <memory>
 #include <optional>
 #include <string>
@@ -23,13 +24,23 @@
 #include "nlohmann/json.hpp"
 #include "src/buildtool/auth/authentication.hpp"
 #include "src/buildtool/build_engine/expression/expression.hpp"
+#include "src/buildtool/common/artifact_digest.hpp"
+#include "src/buildtool/crypto/hash_function.hpp"
 #include "src/buildtool/execution_api/bazel_msg/bazel_common.hpp"
 #include "src/buildtool/execution_api/remote/bazel/bazel_api.hpp"
+#include "src/buildtool/file_system/file_root.hpp"
 #include "src/buildtool/file_system/file_system_manager.hpp"
+#include "src/buildtool/file_system/git_cas.hpp"
+#include "src/buildtool/file_system/git_repo.hpp"
+#include "src/buildtool/file_system/symlinks_map/pragma_special.hpp"
 #include "src/buildtool/logging/log_level.hpp"
 #include "src/buildtool/logging/logger.hpp"
+#include "src/buildtool/main/version.hpp"
 #include "src/buildtool/serve_api/remote/config.hpp"
+#include "src/buildtool/storage/fs_utils.hpp"
+#include "src/buildtool/storage/storage.hpp"
 #include "src/other_tools/just_mr/exit_codes.hpp"
+#include "src/other_tools/just_mr/utils.hpp"
 
 namespace {
 
@@ -70,6 +81,63 @@ void SetupAuthConfig(MultiRepoRemoteAuthArguments const& authargs) noexcept {
     }
 }
 
+/// \brief Check that all Git-tree roots of a setup configuration are still
+/// present in their respective repositories.
+[[nodiscard]] auto SetupConfigRootsPresent(nlohmann::json const& mr_config)
+    -> bool {
+    // open each referenced Git repository only once
+    std::map<std::string, std::optional<GitRepo>> git_repos{};
+    auto silent_logger = std::make_shared<GitRepo::anon_logger_t>(
+        [](auto const& /*unused*/, auto /*unused*/) {});
+    auto root_present = [&git_repos, &silent_logger](
+                            nlohmann::json const& root) -> bool {
+        if (not root.is_array() or root.empty() or not root[0].is_string()) {
+            return false;
+        }
+        auto marker = root[0].get<std::string>();
+        if (marker != FileRoot::kGitTreeMarker and
+            marker != FileRoot::kGitTreeIgnoreSpecialMarker) {
+            // non-Git roots are taken as-is, as done by setup
+            return true;
+        }
+        if (root.size() != 3 or not root[1].is_string() or
+            not root[2].is_string()) {
+            return false;
+        }
+        auto repo_path = root[2].get<std::string>();
+        auto it = git_repos.find(repo_path);
+        if (it == git_repos.end()) {
+            auto git_cas = GitCAS::Open(repo_path);
+            it = git_repos
+                     .emplace(repo_path,
+                              git_cas ? GitRepo::Open(git_cas) : std::nullopt)
+                     .first;
+        }
+        if (not it->second) {
+            return false;
+        }
+        auto tree_found = it->second->CheckTreeExists(
+            root[1].get<std::string>(), silent_logger);
+        return tree_found and *tree_found;
+    };
+    for (auto const& [repo, desc] :
+         mr_config.value("repositories", nlohmann::json::object()).items()) {
+        if (not desc.is_object()) {
+            return false;
+        }
+        if (desc.contains("workspace_root") and
+            not root_present(desc["workspace_root"])) {
+            return false;
+        }
+        for (auto const& key : kAltDirs) {
+            if (desc.contains(key) and not root_present(desc[key])) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
 }  // namespace
 
 namespace JustMR::Utils {
@@ -282,4 +350,160 @@ auto SetupServeApi(std::optional<std::string> const& remote_serve_addr,
     return false;
 }
 
+auto ComputeSetupFingerprint(
+    std::optional<std::filesystem::path> const& config_file_opt,
+    MultiRepoCommonArguments const& common_args,
+    MultiRepoSetupArguments const& setup_args) noexcept
+    -> std::optional<std::string> {
+    if (not config_file_opt or
+        not FileSystemManager::IsFile(*config_file_opt)) {
+        return std::nullopt;
+    }
+    try {
+        auto config_content = FileSystemManager::ReadFile(*config_file_opt);
+        if (not config_content) {
+            return std::nullopt;
+        }
+        auto inputs = nlohmann::json::object();
+        inputs["version"] = version();
+        // relative paths of file repositories are resolved against the
+        // working directory
+        inputs["working directory"] = std::filesystem::current_path().string();
+        inputs["config file"] =
+            std::filesystem::absolute(*config_file_opt).string();
+        inputs["config"] =
+            HashFunction::ComputeBlobHash(*config_content).HexString();
+        if (common_args.absent_repository_file) {
+            auto absent_content = FileSystemManager::ReadFile(
+                *common_args.absent_repository_file);
+            if (not absent_content) {
+                return std::nullopt;
+            }
+            inputs["absent"] =
+                HashFunction::ComputeBlobHash(*absent_content).HexString();
+        }
+        inputs["setup root"] = common_args.just_mr_paths->setup_root.string();
+        inputs["checkout locations"] =
+            common_args.just_mr_paths->git_checkout_locations;
+        if (common_args.main) {
+            inputs["main"] = *common_args.main;
+        }
+        inputs["all"] = setup_args.sub_all;
+        inputs["fetch absent"] = common_args.fetch_absent;
+        inputs["compatible"] = common_args.compatible == true;
+        if (common_args.remote_execution_address) {
+            inputs["remote execution"] = *common_args.remote_execution_address;
+        }
+        if (common_args.remote_serve_address) {
+            inputs["remote serve"] = *common_args.remote_serve_address;
+        }
+        return HashFunction::ComputeHash(inputs.dump()).HexString();
+    } catch (std::exception const& ex) {
+        Logger::Log(LogLevel::Debug,
+                    "Computing setup fingerprint failed with:\n{}",
+                    ex.what());
+    }
+    return std::nullopt;
+}
+
+auto IsSetupReusable(std::shared_ptr<Configuration> const& config,
+                     bool fetch_absent) noexcept -> bool {
+    try {
+        auto repos = (*config)["repositories"];
+        if (not repos.IsNotNull() or not repos->IsMap()) {
+            return false;
+        }
+        for (auto const& [repo, repo_entry] : repos->Map().Items()) {
+            if (not repo_entry->IsMap()) {
+                return false;
+            }
+            auto resolved_repo_desc = ResolveRepo(
+                repo_entry->Get("repository", Expression::none_t{}), repos);
+            if (not resolved_repo_desc or
+                not resolved_repo_desc.value()->IsMap()) {
+                return false;
+            }
+            auto pragma =
+                (*resolved_repo_desc)->Get("pragma", Expression::none_t{});
+            if (not pragma->IsMap()) {
+                continue;
+            }
+            auto absent = pragma->Get("absent", Expression::none_t{});
+            if (not fetch_absent and absent->IsBool() and absent->Bool()) {
+                return false;
+            }
+            auto type =
+                (*resolved_repo_desc)->Get("type", Expression::none_t{});
+            if (type->IsString() and type->String() == "file") {
+                auto to_git = pragma->Get("to_git", Expression::none_t{});
+                if (to_git->IsBool() and to_git->Bool()) {
+                    return false;
+                }
+                auto special = pragma->Get("special", Expression::none_t{});
+                if (special->IsString() and
+                    kPragmaSpecialMap.contains(special->String()) and
+                    kPragmaSpecialMap.at(special->String()) !=
+                        PragmaSpecial::Ignore) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    } catch (std::exception const& ex) {
+        Logger::Log(LogLevel::Debug,
+                    "Checking reusability of setup failed with:\n{}",
+                    ex.what());
+    }
+    return false;
+}
+
+auto ReadSetupConfigCache(std::string const& fingerprint) noexcept
+    -> std::optional<std::filesystem::path> {
+    auto id_file = StorageUtils::GetSetupConfigIDFile(fingerprint);
+    if (not FileSystemManager::IsFile(id_file)) {
+        return std::nullopt;
+    }
+    auto config_id = FileSystemManager::ReadFile(id_file);
+    if (not config_id) {
+        return std::nullopt;
+    }
+    auto config_path = Storage::Instance().CAS().BlobPath(
+        ArtifactDigest{*config_id, 0, /*is_tree=*/false},
+        /*is_executable=*/false);
+    if (not config_path) {
+        return std::nullopt;
+    }
+    try {
+        std::ifstream fs(*config_path);
+        if (SetupConfigRootsPresent(nlohmann::json::parse(fs))) {
+            return config_path;
+        }
+    } catch (std::exception const& ex) {
+        Logger::Log(LogLevel::Debug,
+                    "Reading setup configuration {} failed with:\n{}",
+                    config_path->string(),
+                    ex.what());
+    }
+    return std::nullopt;
+}
+
+void WriteSetupConfigCache(
+    std::string const& fingerprint,
+    std::filesystem::path const& mr_config_path) noexcept {
+    auto hash =
+        HashFunction::ComputeHashFile(mr_config_path, /*as_tree=*/false);
+    if (not hash) {
+        Logger::Log(LogLevel::Warning,
+                    "Failed to hash setup configuration {}",
+                    mr_config_path.string());
+        return;
+    }
+    auto id_file = StorageUtils::GetSetupConfigIDFile(fingerprint);
+    if (not StorageUtils::WriteTreeIDFile(id_file, hash->first.HexString())) {
+        Logger::Log(LogLevel::Warning,
+                    "Failed to write setup configuration id to file {}",
+                    id_file.string());
+    }
+}
+
 }  // namespace JustMR::Utils
@@ -74,6 +74,38 @@ void DefaultReachableRepositories(
     std::optional<std::string> const& remote_serve_addr,
     MultiRepoRemoteAuthArguments const& auth) noexcept -> bool;
 
+/// \brief Compute a fingerprint of all inputs that determine the outcome of a
+/// non-interactive setup, i.e., the repository configuration, the absent
+/// repositories file, the working directory (against which relative paths of
+/// file repositories are resolved), and the effective just-mr arguments (as
+/// resulting from the command line and all rc files) relevant for setup.
+/// \returns The fingerprint, or nullopt if the inputs could not be read.
+[[nodiscard]] auto ComputeSetupFingerprint(
+    std::optional<std::filesystem::path> const& config_file_opt,
+    MultiRepoCommonArguments const& common_args,
+    MultiRepoSetupArguments const& setup_args) noexcept
+    -> std::optional<std::string>;
+
+/// \brief Check whether the setup outcome of a configuration is fully
+/// determined by its fingerprint. This is not the case for file repositories
+/// imported to Git (as their content can change) and for absent roots (as
+/// they depend on the serve endpoint).
+[[nodiscard]] auto IsSetupReusable(
+    std::shared_ptr<Configuration> const& config,
+    bool fetch_absent) noexcept -> bool;
+
+/// \brief Get the setup configuration previously produced for the given
+/// fingerprint. The configuration is only returned if it is still in CAS and
+/// all of its Git-tree roots are still present in the Git cache.
+[[nodiscard]] auto ReadSetupConfigCache(std::string const& fingerprint) noexcept
+    -> std::optional<std::filesystem::path>;
+
+/// \brief Remember the setup configuration produced for the given fingerprint.
+/// Failures are only reported, as they merely affect future invocations.
+void WriteSetupConfigCache(
+    std::string const& fingerprint,
+    std::filesystem::path const& mr_config_path) noexcept;
+
 }  // namespace Utils
 
 }  // namespace JustMR
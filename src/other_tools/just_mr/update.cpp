@@ -14,12 +14,15 @@
 
 #include "src/other_tools/just_mr/update.hpp"
 
+#include <algorithm>
 #include <atomic>
 #include <condition_variable>
 #include <cstddef>
 #include <exception>
 #include <filesystem>
 #include <thread>
+#include <unordered_map>
+#include <utility>
 
 #include "fmt/core.h"
 #include "nlohmann/json.hpp"
@@ -60,9 +63,12 @@ auto MultiRepoUpdate(std::shared_ptr<Configuration> const& config,
                     "Config: Value for key \"repositories\" is not a map");
         return kExitUpdateError;
     }
-    // gather repos to update
+    // gather repos to update, batching all branches of the same remote
     std::vector<RepoDescriptionForUpdating> repos_to_update{};
-    repos_to_update.reserve(update_args.repos_to_update.size());
+    std::unordered_map<std::string, std::size_t> remote_positions{};
+    // for each repository to update, its remote and branch positions
+    std::vector<std::pair<std::size_t, std::size_t>> update_positions{};
+    update_positions.reserve(update_args.repos_to_update.size());
     for (auto const& repo_name : update_args.repos_to_update) {
         auto repo_desc_parent = repos->At(repo_name);
         if (not repo_desc_parent) {
@@ -170,10 +176,32 @@ auto MultiRepoUpdate(std::shared_ptr<Configuration> const& config,
                     inherit_env.emplace_back(var->String());
                 }
 
-                repos_to_update.emplace_back(RepoDescriptionForUpdating{
-                    .repo = repo_desc_repository->get()->String(),
-                    .branch = repo_desc_branch->get()->String(),
-                    .inherit_env = inherit_env});
+                auto const& remote = repo_desc_repository->get()->String();
+                auto const& branch = repo_desc_branch->get()->String();
+                auto [remote_it, is_new] =
+                    remote_positions.emplace(remote, repos_to_update.size());
+                if (is_new) {
+                    repos_to_update.emplace_back(
+                        RepoDescriptionForUpdating{.repo = remote});
+                }
+                auto& remote_desc = repos_to_update[remote_it->second];
+                // environment needed by any of the repositories is inherited
+                for (auto& var : inherit_env) {
+                    if (std::find(remote_desc.inherit_env.begin(),
+                                  remote_desc.inherit_env.end(),
+                                  var) == remote_desc.inherit_env.end()) {
+                        remote_desc.inherit_env.emplace_back(std::move(var));
+                    }
+                }
+                auto branch_it = std::find(remote_desc.branches.begin(),
+                                           remote_desc.branches.end(),
+                                           branch);
+                auto branch_pos = static_cast<std::size_t>(
+                    branch_it - remote_desc.branches.begin());
+                if (branch_it == remote_desc.branches.end()) {
+                    remote_desc.branches.emplace_back(branch);
+                }
+                update_positions.emplace_back(remote_it->second, branch_pos);
             }
             else {
                 Logger::Log(LogLevel::Error,
@@ -190,7 +218,7 @@ auto MultiRepoUpdate(std::shared_ptr<Configuration> const& config,
             return kExitUpdateError;
         }
     }
-    // Create fake repo for the anonymous remotes
+    // Create fake repo providing the configuration for the remotes
     auto tmp_dir = StorageConfig::CreateTypedTmpDir("update");
     if (not tmp_dir) {
         Logger::Log(LogLevel::Error, "Failed to create commit update tmp dir");
@@ -208,19 +236,25 @@ auto MultiRepoUpdate(std::shared_ptr<Configuration> const& config,
     }
 
     // report progress
-    auto nr = repos_to_update.size();
+    auto nr = update_positions.size();
+    auto nr_remotes = repos_to_update.size();
     Logger::Log(LogLevel::Info,
-                "Discovered {} Git {} to update",
+                "Discovered {} Git {} to update from {} {}",
                 nr,
-                nr == 1 ? "repository" : "repositories");
+                nr == 1 ? "repository" : "repositories",
+                nr_remotes,
+                nr_remotes == 1 ? "remote" : "remotes");
 
     // Initialize resulting config to be updated
     auto mr_config = config->ToJson();
     // Create async map
-    auto git_update_map = CreateGitUpdateMap(git_repo->GetGitCAS(),
-                                             common_args.git_path->string(),
-                                             *common_args.local_launcher,
-                                             common_args.jobs);
+    auto git_update_map = CreateGitUpdateMap(
+        git_repo->GetGitCAS(),
+        common_args.git_path->string(),
+        *common_args.local_launcher,
+        common_args.jobs,
+        update_args.max_connections_per_host.value_or(
+            kDefaultMaxConnectionsPerHost));
 
     // set up progress observer
     JustMRProgress::Instance().SetTotal(repos_to_update.size());
@@ -239,18 +273,20 @@ auto MultiRepoUpdate(std::shared_ptr<Configuration> const& config,
             repos_to_update,
             [&failed,
              &mr_config,
+             &update_positions,
              repos_to_update_names = update_args.repos_to_update,
              multi_repo_tool_name](auto const& values) noexcept {
                 try {
-                    for (auto const& repo_name : repos_to_update_names) {
-                        auto i = static_cast<std::size_t>(
-                            &repo_name -
-                            &repos_to_update_names[0]);  // get index
+                    for (std::size_t i = 0; i < repos_to_update_names.size();
+                         ++i) {
+                        auto const& [remote_pos, branch_pos] =
+                            update_positions[i];
                         // we know "repository" is a map for repo_name, so
                         // field "commit" is here either overwritten or set if
                         // missing; either way, this should always work
-                        mr_config["repositories"][repo_name]["repository"]
-                                 ["commit"] = *values[i];
+                        mr_config["repositories"][repos_to_update_names[i]]
+                                 ["repository"]["commit"] =
+                                     values[remote_pos]->at(branch_pos);
                     }
                 } catch (std::exception const& ex) {
                     Logger::Log(
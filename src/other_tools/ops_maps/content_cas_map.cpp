@@ -41,12 +41,19 @@ void FetchFromNetwork(ArchiveContent const& key,
                   /*fatal=*/true);
         return;
     }
-    // now do the actual fetch
+    // now do the actual fetch, reporting the bytes received
     auto res = NetworkFetchWithMirrors(
-        key.fetch_url, key.mirrors, ca_info, additional_mirrors);
-    auto* data =
+        key.fetch_url,
+        key.mirrors,
+        ca_info,
+        additional_mirrors,
+        [origin = key.origin](std::size_t bytes) {
+            JustMRProgress::Instance().TransferProgress(origin, bytes);
+        });
+    JustMRProgress::Instance().TransferDone(key.origin);
+    auto* fetched =
         std::get_if<1>(&res);  // get pointer to fetched data, or nullptr
-    if (data == nullptr) {
+    if (fetched == nullptr) {
         (*logger)(fmt::format("Failed to fetch a file with id {} from provided "
                               "remotes:{}",
                               key.content,
@@ -54,6 +61,7 @@ void FetchFromNetwork(ArchiveContent const& key,
                   /*fatal=*/true);
         return;
     }
+    auto const* data = &fetched->data;
     // check content wrt checksums
     if (key.sha256) {
         auto actual_sha256 = GetContentHash<Hasher::HashType::SHA256>(*data);
@@ -97,6 +105,18 @@ void FetchFromNetwork(ArchiveContent const& key,
             /*fatal=*/true);
         return;
     }
+    // account the transfer per mirror host
+    JustMRStatistics::Instance().AddFetchedBytes(
+        CurlURLHandle::GetHostname(fetched->mirror).value_or(fetched->mirror),
+        data->size());
+    // remember the size, to schedule large fetches first in the future
+    if (not StorageUtils::WriteTreeIDFile(
+            StorageUtils::GetContentSizeFile(key.content),
+            std::to_string(data->size()))) {
+        (*logger)(fmt::format("Failed to record size of content {}",
+                              key.content),
+                  /*fatal=*/false);
+    }
     JustMRProgress::Instance().TaskTracker().Stop(key.origin);
     // success!
     (*setter)(nullptr);
@@ -14,53 +14,165 @@
 
 #include "src/other_tools/ops_maps/git_update_map.hpp"
 
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+
 #include "fmt/core.h"
+#include "gsl/gsl"
+#include "nlohmann/json.hpp"
 #include "src/buildtool/execution_api/local/config.hpp"
+#include "src/buildtool/multithreading/task_system.hpp"
 #include "src/buildtool/storage/fs_utils.hpp"
 #include "src/other_tools/just_mr/progress_reporting/progress.hpp"
 #include "src/other_tools/just_mr/progress_reporting/statistics.hpp"
 
+namespace {
+
+/// \brief Get the host part of a remote url; this is the authority for urls
+/// with a scheme and the part before the colon for scp-like syntax. Local
+/// paths are all treated as the same (empty) host.
+[[nodiscard]] auto GetRemoteHost(std::string const& url) -> std::string {
+    std::string authority{};
+    if (auto pos = url.find("://"); pos != std::string::npos) {
+        auto rest = url.substr(pos + 3);
+        authority = rest.substr(0, rest.find('/'));
+    }
+    else if (auto colon = url.find(':');
+             colon != std::string::npos and url.find('/') > colon) {
+        authority = url.substr(0, colon);
+    }
+    else {
+        return std::string{};
+    }
+    // drop any user information
+    if (auto at = authority.rfind('@'); at != std::string::npos) {
+        authority = authority.substr(at + 1);
+    }
+    return authority;
+}
+
+/// \brief Limit on concurrent connections to the same host, enforced by
+/// scheduling: tasks not admitted right away are queued per host and handed
+/// to the task system once a connection to that host is released, so that no
+/// worker waits for a free connection.
+class HostConnectionLimit {
+  public:
+    using Task = std::function<void()>;
+
+    explicit HostConnectionLimit(std::size_t limit) noexcept
+        : limit_{limit == 0 ? 1 : limit} {}
+
+    /// \brief Run the task in the calling thread if a connection to the host
+    /// is available, otherwise queue it. The task has to call \ref Release
+    /// for the host once it finished using the connection.
+    void Run(std::string const& host, Task task) {
+        {
+            std::unique_lock lock{mutex_};
+            auto& [active, waiting] = hosts_[host];
+            if (active >= limit_) {
+                waiting.emplace(std::move(task));
+                return;
+            }
+            ++active;
+        }
+        task();
+    }
+
+    /// \brief Release a connection to the host. If tasks are waiting for
+    /// that host, the connection is passed on to the next of them, which is
+    /// queued in the given task system.
+    void Release(gsl::not_null<TaskSystem*> const& ts,
+                 std::string const& host) {
+        Task next{};
+        {
+            std::unique_lock lock{mutex_};
+            auto& [active, waiting] = hosts_[host];
+            if (waiting.empty()) {
+                --active;
+                return;
+            }
+            next = std::move(waiting.front());
+            waiting.pop();
+        }
+        ts->QueueTask(std::move(next));
+    }
+
+  private:
+    std::size_t const limit_;
+    std::mutex mutex_{};
+    // per host, the number of active connections and the waiting tasks
+    std::unordered_map<std::string, std::pair<std::size_t, std::queue<Task>>>
+        hosts_{};
+};
+
+}  // namespace
+
 auto CreateGitUpdateMap(GitCASPtr const& git_cas,
                         std::string const& git_bin,
                         std::vector<std::string> const& launcher,
-                        std::size_t jobs) -> GitUpdateMap {
-    auto update_commits = [git_cas, git_bin, launcher](auto /* unused */,
-                                                       auto setter,
-                                                       auto logger,
-                                                       auto /* unused */,
-                                                       auto const& key) {
-        // perform git update commit
-        auto git_repo = GitRepoRemote::Open(git_cas);  // wrap the tmp odb
-        if (not git_repo) {
-            (*logger)(
-                fmt::format("Failed to open tmp Git repository for remote {}",
-                            key.repo),
-                /*fatal=*/true);
-            return;
-        }
-        // setup wrapped logger
-        auto wrapped_logger = std::make_shared<AsyncMapConsumerLogger>(
-            [logger](auto const& msg, bool fatal) {
-                (*logger)(
-                    fmt::format("While updating commit from remote:\n{}", msg),
-                    fatal);
-            });
-        // update commit
-        auto id = fmt::format("{}:{}", key.repo, key.branch);
-        JustMRProgress::Instance().TaskTracker().Start(id);
-        auto new_commit = git_repo->UpdateCommitViaTmpRepo(key.repo,
-                                                           key.branch,
-                                                           key.inherit_env,
-                                                           git_bin,
-                                                           launcher,
-                                                           wrapped_logger);
-        JustMRProgress::Instance().TaskTracker().Stop(id);
-        if (not new_commit) {
-            return;
-        }
-        JustMRStatistics::Instance().IncrementExecutedCounter();
-        (*setter)(new_commit->c_str());
+                        std::size_t jobs,
+                        std::size_t max_connections_per_host) -> GitUpdateMap {
+    auto host_limit =
+        std::make_shared<HostConnectionLimit>(max_connections_per_host);
+    auto update_commits = [git_cas, git_bin, launcher, host_limit](
+                              auto ts,
+                              auto setter,
+                              auto logger,
+                              auto /* unused */,
+                              auto const& key) {
+        auto host = GetRemoteHost(key.repo);
+        auto update = [git_cas,
+                       git_bin,
+                       launcher,
+                       host_limit,
+                       ts,
+                       host,
+                       setter,
+                       logger,
+                       key]() {
+            // perform git update commit
+            auto git_repo = GitRepoRemote::Open(git_cas);  // wrap the tmp odb
+            if (not git_repo) {
+                host_limit->Release(ts, host);
+                (*logger)(fmt::format(
+                              "Failed to open tmp Git repository for remote {}",
+                              key.repo),
+                          /*fatal=*/true);
+                return;
+            }
+            // setup wrapped logger
+            auto wrapped_logger = std::make_shared<AsyncMapConsumerLogger>(
+                [logger](auto const& msg, bool fatal) {
+                    (*logger)(
+                        fmt::format("While updating commits from remote:\n{}",
+                                    msg),
+                        fatal);
+                });
+            // update all commits of this remote in one go
+            auto id = fmt::format(
+                "{}:{}", key.repo, nlohmann::json(key.branches).dump());
+            JustMRProgress::Instance().TaskTracker().Start(id);
+            auto new_commits = git_repo->UpdateCommits(key.repo,
+                                                       key.branches,
+                                                       key.inherit_env,
+                                                       git_bin,
+                                                       launcher,
+                                                       wrapped_logger);
+            JustMRProgress::Instance().TaskTracker().Stop(id);
+            host_limit->Release(ts, host);
+            if (not new_commits) {
+                return;
+            }
+            JustMRStatistics::Instance().IncrementExecutedCounter();
+            (*setter)(*std::move(new_commits));
+        };
+        // run the update as soon as a connection to the host is available
+        host_limit->Run(host, std::move(update));
     };
-    return AsyncMapConsumer<RepoDescriptionForUpdating, std::string>(
-        update_commits, jobs);
+    return AsyncMapConsumer<RepoDescriptionForUpdating,
+                            std::vector<std::string>>(update_commits, jobs);
 }
@@ -24,19 +24,25 @@
 #include "src/other_tools/git_operations/git_repo_remote.hpp"
 #include "src/utils/cpp/hash_combine.hpp"
 
+/// \brief Default for the number of remotes of the same host queried at once.
+constexpr std::size_t kDefaultMaxConnectionsPerHost = 4;
+
+/// \brief All branches to be updated from one remote repository.
 struct RepoDescriptionForUpdating {
     std::string repo{};
-    std::string branch{};
+    std::vector<std::string> branches{};
     std::vector<std::string> inherit_env{}; /*non-key!*/
 
     [[nodiscard]] auto operator==(const RepoDescriptionForUpdating& other) const
         -> bool {
-        return repo == other.repo and branch == other.branch;
+        return repo == other.repo and branches == other.branches;
     }
 };
 
-/// \brief Maps a pair of repository url and branch to an updated commit hash.
-using GitUpdateMap = AsyncMapConsumer<RepoDescriptionForUpdating, std::string>;
+/// \brief Maps a repository url and a list of branches to the updated commit
+/// hashes of these branches, in the same order.
+using GitUpdateMap =
+    AsyncMapConsumer<RepoDescriptionForUpdating, std::vector<std::string>>;
 
 namespace std {
 template <>
@@ -45,15 +51,23 @@ struct hash<RepoDescriptionForUpdating> {
         RepoDescriptionForUpdating const& ct) const noexcept -> std::size_t {
         size_t seed{};
         hash_combine<std::string>(&seed, ct.repo);
-        hash_combine<std::string>(&seed, ct.branch);
+        for (auto const& branch : ct.branches) {
+            hash_combine<std::string>(&seed, branch);
+        }
         return seed;
     }
 };
 }  // namespace std
 
-[[nodiscard]] auto CreateGitUpdateMap(GitCASPtr const& git_cas,
-                                      std::string const& git_bin,
-                                      std::vector<std::string> const& launcher,
-                                      std::size_t jobs) -> GitUpdateMap;
+/// \brief Create the map resolving the branches of each remote with a single
+/// ls-remote query. Remotes are queried in parallel, but at most
+/// max_connections_per_host of them for any one host at the same time.
+[[nodiscard]] auto CreateGitUpdateMap(
+    GitCASPtr const& git_cas,
+    std::string const& git_bin,
+    std::vector<std::string> const& launcher,
+    std::size_t jobs,
+    std::size_t max_connections_per_host = kDefaultMaxConnectionsPerHost)
+    -> GitUpdateMap;
 
 #endif  // INCLUDED_SRC_OTHER_TOOLS_OPS_MAPS_GIT_UPDATE_MAP_HPP
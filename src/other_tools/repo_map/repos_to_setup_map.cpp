@@ -18,11 +18,17 @@
 #include <utility>  // std::move
 
 #include "fmt/core.h"
+#include "src/buildtool/crypto/hash_function.hpp"
 #include "src/buildtool/file_system/file_root.hpp"
+#include "src/buildtool/file_system/file_system_manager.hpp"
+#include "src/buildtool/file_system/git_cas.hpp"
+#include "src/buildtool/file_system/git_repo.hpp"
 #include "src/buildtool/file_system/symlinks_map/pragma_special.hpp"
 #include "src/buildtool/logging/log_level.hpp"
 #include "src/buildtool/logging/logger.hpp"
 #include "src/buildtool/multithreading/task_system.hpp"
+#include "src/buildtool/storage/config.hpp"
+#include "src/buildtool/storage/fs_utils.hpp"
 #include "src/other_tools/just_mr/progress_reporting/progress.hpp"
 #include "src/other_tools/just_mr/progress_reporting/statistics.hpp"
 #include "src/other_tools/ops_maps/content_cas_map.hpp"
@@ -31,6 +37,145 @@
 
 namespace {
 
+/// \brief Compute the key under which the workspace root of a repository is
+/// remembered across invocations. Only repositories with a root fully
+/// determined by their resolved description qualify; for distdirs, the
+/// descriptions of the listed repositories are taken into account as well.
+/// Returns nullopt if the root of the repository cannot be remembered.
+[[nodiscard]] auto GetSetupRootKey(ExpressionPtr const& resolved_repo_desc,
+                                   ExpressionPtr const& repos,
+                                   CheckoutType checkout_type,
+                                   bool fetch_absent) noexcept
+    -> std::optional<std::string> {
+    // roots of local paths depend on the current state of the file system
+    if (checkout_type == CheckoutType::File) {
+        return std::nullopt;
+    }
+    try {
+        // absent roots depend on the state of the serve endpoint
+        auto repo_desc_pragma = resolved_repo_desc->At("pragma");
+        auto pragma_absent =
+            (repo_desc_pragma and repo_desc_pragma->get()->IsMap())
+                ? repo_desc_pragma->get()->At("absent")
+                : std::nullopt;
+        if (not fetch_absent and pragma_absent and
+            pragma_absent->get()->IsBool() and pragma_absent->get()->Bool()) {
+            return std::nullopt;
+        }
+        auto key_desc =
+            nlohmann::json{{"repository", resolved_repo_desc->ToJson()}};
+        if (checkout_type == CheckoutType::Distdir) {
+            auto distdir_repos =
+                resolved_repo_desc->Get("repositories", Expression::none_t{});
+            if (not distdir_repos->IsList()) {
+                return std::nullopt;
+            }
+            auto dist_descs = nlohmann::json::array();
+            for (auto const& dist_repo : distdir_repos->List()) {
+                if (not dist_repo->IsString()) {
+                    return std::nullopt;
+                }
+                auto dist_repo_entry =
+                    repos->Get(dist_repo->String(), Expression::none_t{});
+                if (not dist_repo_entry->IsMap()) {
+                    return std::nullopt;
+                }
+                auto dist_repo_desc = dist_repo_entry->At("repository");
+                if (not dist_repo_desc) {
+                    return std::nullopt;
+                }
+                auto resolved_dist_repo_desc =
+                    JustMR::Utils::ResolveRepo(dist_repo_desc->get(), repos);
+                if (not resolved_dist_repo_desc) {
+                    return std::nullopt;
+                }
+                dist_descs.emplace_back((*resolved_dist_repo_desc)->ToJson());
+            }
+            key_desc["distdir repositories"] = std::move(dist_descs);
+        }
+        return HashFunction::ComputeHash(key_desc.dump()).HexString();
+    } catch (std::exception const& ex) {
+        Logger::Log(LogLevel::Debug,
+                    "Computing repository setup key failed with:\n{}",
+                    ex.what());
+    }
+    return std::nullopt;
+}
+
+/// \brief Check if a workspace root can be remembered and reused, i.e., it is
+/// a present root in the Git cache of the current local build root.
+[[nodiscard]] auto IsReusableSetupRoot(nlohmann::json const& root) noexcept
+    -> bool {
+    try {
+        return root.is_array() and root.size() == 3 and
+               root[0].is_string() and
+               (root[0].get<std::string>() == FileRoot::kGitTreeMarker or
+                root[0].get<std::string>() ==
+                    FileRoot::kGitTreeIgnoreSpecialMarker) and
+               root[1].is_string() and root[2].is_string() and
+               root[2].get<std::string>() == StorageConfig::GitRoot().string();
+    } catch (...) {
+        return false;
+    }
+}
+
+/// \brief Read the workspace root remembered under the given key. The root is
+/// only returned if its tree is still available in the Git cache.
+[[nodiscard]] auto ReadSetupRoot(std::string const& root_key,
+                                 GitCASPtr const& git_cas) noexcept
+    -> std::optional<nlohmann::json> {
+    if (not git_cas) {
+        return std::nullopt;
+    }
+    auto root_file = StorageUtils::GetRepoSetupRootFile(root_key);
+    if (not FileSystemManager::IsFile(root_file)) {
+        return std::nullopt;
+    }
+    auto content = FileSystemManager::ReadFile(root_file);
+    if (not content) {
+        return std::nullopt;
+    }
+    try {
+        auto root = nlohmann::json::parse(*content);
+        if (not IsReusableSetupRoot(root)) {
+            return std::nullopt;
+        }
+        auto git_repo = GitRepo::Open(git_cas);  // link fake repo to odb
+        if (not git_repo) {
+            return std::nullopt;
+        }
+        // a missing tree only means the entry is stale
+        auto silent_logger = std::make_shared<GitRepo::anon_logger_t>(
+            [](auto const& /*unused*/, auto /*unused*/) {});
+        auto tree_found = git_repo->CheckTreeExists(
+            root[1].get<std::string>(), silent_logger);
+        if (tree_found and *tree_found) {
+            return root;
+        }
+    } catch (std::exception const& ex) {
+        Logger::Log(LogLevel::Debug,
+                    "Reading repository setup file {} failed with:\n{}",
+                    root_file.string(),
+                    ex.what());
+    }
+    return std::nullopt;
+}
+
+/// \brief Remember the workspace root set up for the given key, if reusable.
+/// Failures are not fatal, as they only affect future invocations.
+void StoreSetupRoot(std::string const& root_key,
+                    nlohmann::json const& root) noexcept {
+    if (not IsReusableSetupRoot(root)) {
+        return;
+    }
+    auto root_file = StorageUtils::GetRepoSetupRootFile(root_key);
+    if (not StorageUtils::WriteTreeIDFile(root_file, root.dump())) {
+        Logger::Log(LogLevel::Warning,
+                    "Failed to write repository setup file {}",
+                    root_file.string());
+    }
+}
+
 /// \brief Updates output config with specific keys from input config.
 void SetReposTakeOver(gsl::not_null<nlohmann::json*> const& cfg,
                       ExpressionPtr const& repos,
@@ -777,6 +922,11 @@ auto CreateReposToSetupMap(
     gsl::not_null<TreeIdGitMap*> const& tree_id_git_map,
     bool fetch_absent,
     std::size_t jobs) -> ReposToSetupMap {
+    // the Git cache is only read to validate remembered roots; if it does not
+    // exist yet, there is nothing to be reused
+    auto git_cas = FileSystemManager::IsDirectory(StorageConfig::GitRoot())
+                       ? GitCAS::Open(StorageConfig::GitRoot())
+                       : nullptr;
     auto setup_repo = [config,
                        main,
                        interactive,
@@ -786,7 +936,8 @@ auto CreateReposToSetupMap(
                        fpath_git_map,
                        distdir_git_map,
                        tree_id_git_map,
-                       fetch_absent](auto ts,
+                       fetch_absent,
+                       git_cas](auto ts,
                                      auto setter,
                                      auto logger,
                                      auto /* unused */,
@@ -866,6 +1017,29 @@ auto CreateReposToSetupMap(
                     /*fatal=*/true);
                 return;
             }
+            auto checkout_type = kCheckoutTypeMap.at(repo_type_str);
+            // reuse the root of an unchanged repository description, if known
+            auto root_key = GetSetupRootKey(
+                *resolved_repo_desc, repos, checkout_type, fetch_absent);
+            if (root_key) {
+                if (auto root = ReadSetupRoot(*root_key, git_cas)) {
+                    nlohmann::json cfg({});
+                    cfg["workspace_root"] = *std::move(root);
+                    SetReposTakeOver(&cfg, repos, key);
+                    JustMRStatistics::Instance().IncrementCacheHitsCounter();
+                    (*setter)(std::move(cfg));
+                    return;
+                }
+                // remember the root once set up
+                setter = std::make_shared<ReposToSetupMap::Setter>(
+                    [setter, root_key = *std::move(root_key)](
+                        nlohmann::json&& cfg) {
+                        if (cfg.contains("workspace_root")) {
+                            StoreSetupRoot(root_key, cfg["workspace_root"]);
+                        }
+                        (*setter)(std::move(cfg));
+                    });
+            }
             // setup a wrapped_logger
             auto wrapped_logger = std::make_shared<AsyncMapConsumerLogger>(
                 [logger, repo_name = key](auto const& msg, bool fatal) {
@@ -875,7 +1049,7 @@ auto CreateReposToSetupMap(
                               fatal);
                 });
             // do checkout
-            switch (kCheckoutTypeMap.at(repo_type_str)) {
+            switch (checkout_type) {
                 case CheckoutType::Git: {
                     GitCheckout(*resolved_repo_desc,
                                 std::move(repos),
@@ -14,7 +14,7 @@
 
 #include "src/other_tools/root_maps/distdir_git_map.hpp"
 
-#include <algorithm>
+#include <unordered_map>
 
 #include "fmt/core.h"
 #include "src/buildtool/common/artifact.hpp"
@@ -34,93 +34,188 @@
 #include "src/other_tools/ops_maps/content_cas_map.hpp"
 #include "src/other_tools/ops_maps/critical_git_op_map.hpp"
 #include "src/other_tools/root_maps/root_utils.hpp"
-#include "src/utils/cpp/tmp_dir.hpp"
+#include "src/utils/cpp/hex_string.hpp"
 
 namespace {
 
-/// \brief Create links from CAS content to distdir tmp directory
-[[nodiscard]] auto LinkToCAS(
-    std::shared_ptr<std::unordered_map<std::string, std::string>> const&
-        content_list,
-    std::filesystem::path const& tmp_dir) noexcept -> bool {
+/// \brief Write the distdir tree directly into the Git cache, referencing the
+/// content blobs by their ids. Blobs not yet known to the Git cache are added
+/// from the local CAS, so no files have to be staged.
+/// Returns the hash of the tree, or nullopt on failure. It guarantees the
+/// logger is called exactly once with fatal on failure.
+[[nodiscard]] auto WriteDistdirTree(DistdirInfo const& key,
+                                    GitCASPtr const& git_cas,
+                                    DistdirGitMap::LoggerPtr const& logger)
+    -> std::optional<std::string> {
+    auto git_repo = GitRepo::Open(git_cas);  // wrap the Git cache odb
+    if (not git_repo) {
+        (*logger)(fmt::format("Could not open Git cache repository {}",
+                              StorageConfig::GitRoot().string()),
+                  /*fatal=*/true);
+        return std::nullopt;
+    }
+    auto wrapped_logger = std::make_shared<GitRepo::anon_logger_t>(
+        [logger, content_id = key.content_id](auto const& msg, bool fatal) {
+            (*logger)(fmt::format("While writing tree of distdir {} to Git "
+                                  "cache:\n{}",
+                                  content_id,
+                                  msg),
+                      fatal);
+        });
     auto const& cas = Storage::Instance().CAS();
-    return std::all_of(content_list->begin(),
-                       content_list->end(),
-                       [&cas, tmp_dir](auto const& kv) {
-                           auto content_path =
-                               cas.BlobPath(ArtifactDigest(kv.second, 0, false),
-                                            /*is_executable=*/false);
-                           if (content_path) {
-                               return FileSystemManager::CreateFileHardlink(
-                                   *content_path,  // from: cas_path/content_id
-                                   tmp_dir / kv.first);  // to: tmp_dir/name
-                           }
-                           return false;
-                       });
+    // Git blob ids of the contents already handled
+    std::unordered_map<std::string, std::string> blob_ids{};
+    GitRepo::tree_entries_t entries{};
+    entries.reserve(key.content_list->size());
+    for (auto const& [name, content] : *key.content_list) {
+        auto blob_id = blob_ids.find(content);
+        if (blob_id == blob_ids.end()) {
+            auto in_git = git_repo->CheckBlobExists(content, wrapped_logger);
+            if (not in_git) {
+                return std::nullopt;
+            }
+            auto id = content;
+            if (not *in_git) {
+                auto content_path =
+                    cas.BlobPath(ArtifactDigest(content, 0, false),
+                                 /*is_executable=*/false);
+                if (not content_path) {
+                    (*logger)(fmt::format("Failed to find content {} of "
+                                          "distdir {} in local CAS",
+                                          content,
+                                          key.content_id),
+                              /*fatal=*/true);
+                    return std::nullopt;
+                }
+                auto written_id =
+                    git_repo->WriteBlobFromFile(*content_path, wrapped_logger);
+                if (not written_id) {
+                    return std::nullopt;
+                }
+                id = *std::move(written_id);
+            }
+            blob_id = blob_ids.emplace(content, std::move(id)).first;
+        }
+        // tree_entries_t type expects raw ids
+        auto raw_id = FromHexString(blob_id->second);
+        if (not raw_id) {
+            (*logger)(fmt::format("While processing distdir {}: Unexpected "
+                                  "failure in conversion to raw id of "
+                                  "distfile content {}",
+                                  key.content_id,
+                                  blob_id->second),
+                      /*fatal=*/true);
+            return std::nullopt;
+        }
+        entries[*raw_id].emplace_back(name, ObjectType::File);
+    }
+    auto tree_raw_id = git_repo->CreateTree(entries);
+    if (not tree_raw_id) {
+        (*logger)(fmt::format("Failed to create Git tree for distdir {}",
+                              key.content_id),
+                  /*fatal=*/true);
+        return std::nullopt;
+    }
+    return ToHexString(*tree_raw_id);
 }
 
 /// \brief Called once we know we have the content blobs in local CAS in order
-/// to do the import-to-git step. Then it also sets the root.
+/// to create the distdir tree in the Git cache. Then it also sets the root.
 /// It guarantees the logger is called exactly once with fatal on failure, and
 /// the setter on success.
-void ImportFromCASAndSetRoot(
+void WriteTreeFromCASAndSetRoot(
     DistdirInfo const& key,
     std::filesystem::path const& distdir_tree_id_file,
-    gsl::not_null<ImportToGitMap*> const& import_to_git_map,
+    gsl::not_null<CriticalGitOpMap*> const& critical_git_op_map,
     gsl::not_null<TaskSystem*> const& ts,
     DistdirGitMap::SetterPtr const& setter,
     DistdirGitMap::LoggerPtr const& logger) {
-    // create the links to CAS
-    auto tmp_dir = StorageConfig::CreateTypedTmpDir("distdir");
-    if (not tmp_dir) {
-        (*logger)(fmt::format("Failed to create tmp path for "
-                              "distdir target {}",
-                              key.content_id),
-                  /*fatal=*/true);
-        return;
-    }
-    // link content from CAS into tmp dir
-    if (not LinkToCAS(key.content_list, tmp_dir->GetPath())) {
-        (*logger)(fmt::format("Failed to create links to CAS content!",
-                              key.content_id),
-                  /*fatal=*/true);
-        return;
-    }
-    // do import to git
-    CommitInfo c_info{tmp_dir->GetPath(), "distdir", key.content_id};
-    import_to_git_map->ConsumeAfterKeysReady(
+    // ensure Git cache
+    // define Git operation to be done
+    GitOpKey op_key = {.params =
+                           {
+                               StorageConfig::GitRoot(),  // target_path
+                               "",                        // git_hash
+                               "",                        // branch
+                               std::nullopt,              // message
+                               true                       // init_bare
+                           },
+                       .op_type = GitOpType::ENSURE_INIT};
+    critical_git_op_map->ConsumeAfterKeysReady(
         ts,
-        {std::move(c_info)},
-        [tmp_dir,  // keep tmp_dir alive
+        {std::move(op_key)},
+        [key,
          distdir_tree_id_file,
+         critical_git_op_map,
+         ts,
          setter,
          logger](auto const& values) {
-            // check for errors
-            if (not values[0]->second) {
-                (*logger)("Importing to git failed",
+            GitOpValue op_result = *values[0];
+            // check flag
+            if (not op_result.result) {
+                (*logger)("Git init failed",
                           /*fatal=*/true);
                 return;
             }
-            // only the tree is of interest
-            std::string distdir_tree_id = values[0]->first;
-            // write to tree id file
-            if (not StorageUtils::WriteTreeIDFile(distdir_tree_id_file,
-                                                  distdir_tree_id)) {
-                (*logger)(fmt::format("Failed to write tree id to file {}",
-                                      distdir_tree_id_file.string()),
-                          /*fatal=*/true);
+            auto distdir_tree_id =
+                WriteDistdirTree(key, op_result.git_cas, logger);
+            if (not distdir_tree_id) {
                 return;
             }
-            // set the workspace root as present
-            (*setter)(std::pair(
-                nlohmann::json::array({FileRoot::kGitTreeMarker,
-                                       distdir_tree_id,
-                                       StorageConfig::GitRoot().string()}),
-                /*is_cache_hit=*/false));
+            // keep tree alive in Git cache via a tagged commit
+            GitOpKey op_key = {
+                .params =
+                    {
+                        StorageConfig::GitRoot(),     // target_path
+                        *distdir_tree_id,             // git_hash
+                        "",                           // branch
+                        "Keep referenced tree alive"  // message
+                    },
+                .op_type = GitOpType::KEEP_TREE};
+            critical_git_op_map->ConsumeAfterKeysReady(
+                ts,
+                {std::move(op_key)},
+                [distdir_tree_id = *distdir_tree_id,
+                 distdir_tree_id_file,
+                 setter,
+                 logger](auto const& values) {
+                    GitOpValue op_result = *values[0];
+                    // check flag
+                    if (not op_result.result) {
+                        (*logger)("Keep tree failed",
+                                  /*fatal=*/true);
+                        return;
+                    }
+                    // write to tree id file
+                    if (not StorageUtils::WriteTreeIDFile(distdir_tree_id_file,
+                                                          distdir_tree_id)) {
+                        (*logger)(
+                            fmt::format("Failed to write tree id to file {}",
+                                        distdir_tree_id_file.string()),
+                            /*fatal=*/true);
+                        return;
+                    }
+                    // set the workspace root as present
+                    (*setter)(std::pair(
+                        nlohmann::json::array(
+                            {FileRoot::kGitTreeMarker,
+                             distdir_tree_id,
+                             StorageConfig::GitRoot().string()}),
+                        /*is_cache_hit=*/false));
+                },
+                [logger, target_path = StorageConfig::GitRoot()](
+                    auto const& msg, bool fatal) {
+                    (*logger)(fmt::format("While running critical Git op "
+                                          "KEEP_TREE for target {}:\n{}",
+                                          target_path.string(),
+                                          msg),
+                              fatal);
+                });
         },
-        [logger, target_path = tmp_dir->GetPath()](auto const& msg,
-                                                   bool fatal) {
-            (*logger)(fmt::format("While importing target {} to git:\n{}",
+        [logger, target_path = StorageConfig::GitRoot()](auto const& msg,
+                                                         bool fatal) {
+            (*logger)(fmt::format("While running critical Git op ENSURE_INIT "
+                                  "for target {}:\n{}",
                                   target_path.string(),
                                   msg),
                       fatal);
@@ -131,14 +226,12 @@ void ImportFromCASAndSetRoot(
 
 auto CreateDistdirGitMap(
     gsl::not_null<ContentCASMap*> const& content_cas_map,
-    gsl::not_null<ImportToGitMap*> const& import_to_git_map,
     gsl::not_null<CriticalGitOpMap*> const& critical_git_op_map,
     bool serve_api_exists,
     gsl::not_null<IExecutionApi*> const& local_api,
     std::optional<gsl::not_null<IExecutionApi*>> const& remote_api,
     std::size_t jobs) -> DistdirGitMap {
     auto distdir_to_git = [content_cas_map,
-                           import_to_git_map,
                            critical_git_op_map,
                            serve_api_exists,
                            local_api,
@@ -469,12 +562,12 @@ auto CreateDistdirGitMap(
             // if the root is not-absent, the order of checks is different;
             // first, look in the local CAS
             if (local_api->IsAvailable({digest})) {
-                ImportFromCASAndSetRoot(key,
-                                        distdir_tree_id_file,
-                                        import_to_git_map,
-                                        ts,
-                                        setter,
-                                        logger);
+                WriteTreeFromCASAndSetRoot(key,
+                                           distdir_tree_id_file,
+                                           critical_git_op_map,
+                                           ts,
+                                           setter,
+                                           logger);
                 // done
                 return;
             }
@@ -523,17 +616,17 @@ auto CreateDistdirGitMap(
                 *key.repos_to_fetch,
                 [distdir_tree_id_file,
                  key,
-                 import_to_git_map,
+                 critical_git_op_map,
                  ts,
                  setter,
                  logger]([[maybe_unused]] auto const& values) {
                     // archive blobs are in CAS
-                    ImportFromCASAndSetRoot(key,
-                                            distdir_tree_id_file,
-                                            import_to_git_map,
-                                            ts,
-                                            setter,
-                                            logger);
+                    WriteTreeFromCASAndSetRoot(key,
+                                               distdir_tree_id_file,
+                                               critical_git_op_map,
+                                               ts,
+                                               setter,
+                                               logger);
                 },
                 [logger, content_id = key.content_id](auto const& msg,
                                                       bool fatal) {
@@ -26,7 +26,7 @@
 #include "nlohmann/json.hpp"
 #include "src/buildtool/execution_api/common/execution_api.hpp"
 #include "src/other_tools/ops_maps/content_cas_map.hpp"
-#include "src/other_tools/ops_maps/import_to_git_map.hpp"
+#include "src/other_tools/ops_maps/critical_git_op_map.hpp"
 
 struct DistdirInfo {
     std::string content_id; /* key */
@@ -51,7 +51,6 @@ using DistdirGitMap =
 
 [[nodiscard]] auto CreateDistdirGitMap(
     gsl::not_null<ContentCASMap*> const& content_cas_map,
-    gsl::not_null<ImportToGitMap*> const& import_to_git_map,
     gsl::not_null<CriticalGitOpMap*> const& critical_git_op_map,
     bool serve_api_exists,
     gsl::not_null<IExecutionApi*> const& local_api,
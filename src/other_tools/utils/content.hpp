@@ -29,29 +29,42 @@
 
 // Utilities related to the content of an archive
 
+/// \brief Content fetched from the internet, together with the remote location
+/// it was actually obtained from.
+struct NetworkFetchResult {
+    std::string data{};
+    std::string mirror{};
+};
+
 /// \brief Fetches a file from the internet and stores its content in memory.
+/// If given, the progress callback is informed about the bytes received.
 /// \returns the content.
-[[nodiscard]] static auto NetworkFetch(std::string const& fetch_url,
-                                       CAInfoPtr const& ca_info) noexcept
+[[nodiscard]] static auto NetworkFetch(
+    std::string const& fetch_url,
+    CAInfoPtr const& ca_info,
+    CurlEasyHandle::progress_callback_t const& progress = {}) noexcept
     -> std::optional<std::string> {
     auto curl_handle = CurlEasyHandle::Create(
         ca_info->no_ssl_verify, ca_info->ca_bundle, LogLevel::Debug);
     if (not curl_handle) {
         return std::nullopt;
     }
-    return curl_handle->DownloadToString(fetch_url);
+    return curl_handle->DownloadToString(fetch_url, progress);
 }
 
 /// \brief Fetches a file from the internet and stores its content in memory.
 /// Tries not only a given remote, but also all associated remote locations.
+/// If given, the progress callback is informed about the bytes received from
+/// the remote location currently tried.
 /// \returns An error + data union, with the error message at index 0 and the
-/// fetched data at index 1.
+/// fetched data, together with the remote it was obtained from, at index 1.
 [[nodiscard]] static auto NetworkFetchWithMirrors(
     std::string const& fetch_url,
     std::vector<std::string> const& mirrors,
     CAInfoPtr const& ca_info,
-    MirrorsPtr const& additional_mirrors) noexcept
-    -> std::variant<std::string, std::string> {
+    MirrorsPtr const& additional_mirrors,
+    CurlEasyHandle::progress_callback_t const& progress = {}) noexcept
+    -> std::variant<std::string, NetworkFetchResult> {
     // keep all remotes tried, to report in case fetch fails
     std::string remotes_buffer{};
     std::optional<std::string> data{std::nullopt};
@@ -75,16 +88,14 @@
         all_mirrors.begin(), local_mirrors.begin(), local_mirrors.end());
 
     for (auto const& mirror : all_mirrors) {
-        if (data = NetworkFetch(mirror, ca_info); data) {
-            break;
+        if (data = NetworkFetch(mirror, ca_info, progress); data) {
+            return NetworkFetchResult{.data = *std::move(data),
+                                      .mirror = mirror};
         }
         // add local mirror to buffer
         remotes_buffer.append(fmt::format("\n> {}", mirror));
     }
-    return data ? std::variant<std::string, std::string>(std::in_place_index<1>,
-                                                         *data)
-                : std::variant<std::string, std::string>(std::in_place_index<0>,
-                                                         remotes_buffer);
+    return remotes_buffer;
 }
 
 template <Hasher::HashType type>
@@ -107,6 +107,20 @@ auto CurlEasyHandle::EasyWriteToString(gsl::owner<char*> data,
     return static_cast<std::streamsize>(actual_size);
 }
 
+auto CurlEasyHandle::EasyProgress(gsl::owner<void*> userptr,
+                                  std::int64_t /*dltotal*/,
+                                  std::int64_t dlnow,
+                                  std::int64_t /*ultotal*/,
+                                  std::int64_t /*ulnow*/) -> int {
+    try {
+        (*static_cast<progress_callback_t*>(userptr))(
+            static_cast<std::size_t>(dlnow));
+    } catch (...) {
+        // progress reporting must never abort the transfer
+    }
+    return 0;  // continue transfer
+}
+
 auto CurlEasyHandle::DownloadToFile(
     std::string const& url,
     std::filesystem::path const& file_path) noexcept -> int {
@@ -190,7 +204,9 @@ auto CurlEasyHandle::DownloadToFile(
     }
 }
 
-auto CurlEasyHandle::DownloadToString(std::string const& url) noexcept
+auto CurlEasyHandle::DownloadToString(
+    std::string const& url,
+    progress_callback_t const& progress) noexcept
     -> std::optional<std::string> {
     // create temporary file to capture curl debug output
     gsl::owner<std::FILE*> tmp_file = std::tmpfile();
@@ -223,6 +239,20 @@ auto CurlEasyHandle::DownloadToString(std::string const& url) noexcept
         // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg, hicpp-vararg)
         curl_easy_setopt(handle_.get(), CURLOPT_STDERR, tmp_file);
 
+        // set progress callback, if requested
+        if (progress) {
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg, hicpp-vararg)
+            curl_easy_setopt(
+                handle_.get(), CURLOPT_XFERINFOFUNCTION, EasyProgress);
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg, hicpp-vararg)
+            curl_easy_setopt(handle_.get(),
+                             CURLOPT_XFERINFODATA,
+                             static_cast<void*>(
+                                 const_cast<progress_callback_t*>(&progress)));
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg, hicpp-vararg)
+            curl_easy_setopt(handle_.get(), CURLOPT_NOPROGRESS, 0L);
+        }
+
         // set SSL options
         // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg, hicpp-vararg)
         curl_easy_setopt(handle_.get(),
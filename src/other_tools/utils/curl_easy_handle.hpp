@@ -16,6 +16,7 @@
 #define INCLUDED_SRC_OTHER_TOOLS_UTILS_CURL_EASY_HANDLE_HPP
 
 #include <cstddef>
+#include <cstdint>
 #include <filesystem>
 #include <functional>
 #include <memory>
@@ -37,6 +38,9 @@ void curl_easy_closer(gsl::owner<CURL*> curl);
 
 class CurlEasyHandle {
   public:
+    /// \brief Callback informed about the number of bytes received so far.
+    using progress_callback_t = std::function<void(std::size_t)>;
+
     CurlEasyHandle() noexcept = default;
     ~CurlEasyHandle() noexcept = default;
 
@@ -66,8 +70,12 @@ class CurlEasyHandle {
         std::filesystem::path const& file_path) noexcept -> int;
 
     /// \brief Download file from URL into string as binary.
+    /// If given, the progress callback is regularly informed about the number
+    /// of bytes received so far.
     /// Returns the content or nullopt if download failure.
-    [[nodiscard]] auto DownloadToString(std::string const& url) noexcept
+    [[nodiscard]] auto DownloadToString(
+        std::string const& url,
+        progress_callback_t const& progress = {}) noexcept
         -> std::optional<std::string>;
 
   private:
@@ -96,6 +104,13 @@ class CurlEasyHandle {
                                                 std::size_t nmemb,
                                                 gsl::owner<void*> userptr)
         -> std::streamsize;
+
+    /// \brief Overwrites xferinfo_callback to report the bytes received.
+    [[nodiscard]] auto static EasyProgress(gsl::owner<void*> userptr,
+                                           std::int64_t dltotal,
+                                           std::int64_t dlnow,
+                                           std::int64_t ultotal,
+                                           std::int64_t ulnow) -> int;
 };
 
 #endif  // INCLUDED_SRC_OTHER_TOOLS_UTILS_CURL_EASY_HANDLE_HPP
@@ -0,0 +1,127 @@
+// Copyright 2024 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_SRC_UTILS_CPP_GLOB_PATTERN_HPP
+#define INCLUDED_SRC_UTILS_CPP_GLOB_PATTERN_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#ifdef __unix__
+#include <fnmatch.h>
+#else
+#error "Non-unix is not supported yet"
+#endif
+
+/// \brief A glob pattern, matching names as fnmatch without flags does,
+/// compiled for matching many names. The literal prefix and suffix of the
+/// pattern are checked before calling fnmatch, and fnmatch is not called at
+/// all for patterns without wildcards or with a single star only. As every
+/// name matched starts with \ref Prefix, the candidates in a sorted list of
+/// names form a contiguous range.
+class GlobPattern {
+  public:
+    explicit GlobPattern(std::string pattern) noexcept
+        : pattern_{std::move(pattern)} {
+        Compile();
+    }
+
+    /// \brief The literal text every matching name starts with.
+    [[nodiscard]] auto Prefix() const noexcept -> std::string const& {
+        return prefix_;
+    }
+
+    [[nodiscard]] auto Matches(std::string const& name) const noexcept
+        -> bool {
+        if (name.size() < prefix_.size() + suffix_.size() or
+            not name.starts_with(prefix_) or not name.ends_with(suffix_)) {
+            return false;
+        }
+        switch (kind_) {
+            case Kind::kLiteral:
+                return name.size() == prefix_.size();
+            case Kind::kSingleStar:
+                return true;
+            case Kind::kGeneral:
+                break;
+        }
+        return fnmatch(pattern_.c_str(), name.c_str(), 0) == 0;
+    }
+
+  private:
+    enum class Kind : std::uint8_t {
+        kLiteral,     // no wildcards; prefix is the whole pattern
+        kSingleStar,  // prefix, a single star, and suffix
+        kGeneral      // anything else, decided by fnmatch
+    };
+
+    std::string pattern_;
+    std::string prefix_{};
+    std::string suffix_{};
+    Kind kind_{Kind::kLiteral};
+
+    void Compile() noexcept {
+        // Split into the literal text before the first wildcard, the
+        // wildcards, and the literal text after the last wildcard; a
+        // backslash quotes the next character.
+        std::size_t stars{};
+        bool other_wildcards{false};
+        std::string literal{};
+        bool in_prefix{true};
+        for (std::size_t i = 0; i < pattern_.size(); ++i) {
+            char c = pattern_[i];
+            if (c == '[' or (c == '\\' and i + 1 == pattern_.size())) {
+                // Bracket expressions may contain characters looking like
+                // wildcards or quotes, and a trailing backslash is left to
+                // fnmatch; so only keep the prefix found so far.
+                if (in_prefix) {
+                    prefix_ = std::move(literal);
+                }
+                kind_ = Kind::kGeneral;
+                return;
+            }
+            if (c == '\\') {
+                literal.push_back(pattern_[++i]);
+                continue;
+            }
+            if (c != '*' and c != '?') {
+                literal.push_back(c);
+                continue;
+            }
+            if (in_prefix) {
+                prefix_ = std::move(literal);
+                in_prefix = false;
+            }
+            literal.clear();
+            if (c == '*') {
+                ++stars;
+            }
+            else {
+                other_wildcards = true;
+            }
+        }
+        if (in_prefix) {
+            prefix_ = std::move(literal);
+            kind_ = Kind::kLiteral;
+            return;
+        }
+        suffix_ = std::move(literal);
+        kind_ = (stars == 1 and not other_wildcards) ? Kind::kSingleStar
+                                                     : Kind::kGeneral;
+    }
+};
+
+#endif  // INCLUDED_SRC_UTILS_CPP_GLOB_PATTERN_HPP
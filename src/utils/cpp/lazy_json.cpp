@@ -0,0 +1,366 @@
+// Copyright 2024 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/utils/cpp/lazy_json.hpp"
+
+#include <cctype>
+#include <iterator>
+#include <utility>
+
+namespace {
+
+/// \brief Iterator over a string that publishes how far the string was read,
+/// so that the SAX handler knows where the values it is handed end.
+class TrackingIterator {
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = char;
+    using difference_type = std::ptrdiff_t;
+    using pointer = char const*;
+    using reference = char const&;
+
+    TrackingIterator(char const* pos, char const** read_up_to)
+        : pos_{pos}, read_up_to_{read_up_to} {}
+
+    [[nodiscard]] auto operator*() const -> reference { return *pos_; }
+    auto operator++() -> TrackingIterator& {
+        *read_up_to_ = ++pos_;
+        return *this;
+    }
+    [[nodiscard]] auto operator==(TrackingIterator const& other) const
+        -> bool {
+        return pos_ == other.pos_;
+    }
+
+  private:
+    char const* pos_;
+    char const** read_up_to_;
+};
+
+/// \brief SAX handler recording the text ranges of the entries of the
+/// top-level object. Values of entries are only validated, not stored.
+class EntryIndexer {
+  public:
+    using number_integer_t = nlohmann::json::number_integer_t;
+    using number_unsigned_t = nlohmann::json::number_unsigned_t;
+    using number_float_t = nlohmann::json::number_float_t;
+    using string_t = nlohmann::json::string_t;
+    using binary_t = nlohmann::json::binary_t;
+    struct Entry {
+        std::string key;
+        std::size_t begin;
+        std::size_t end;
+    };
+
+    EntryIndexer(std::string const& text, char const* const* read_up_to)
+        : text_{text}, read_up_to_{read_up_to} {}
+
+    [[nodiscard]] auto null() -> bool { return Scalar(); }
+    [[nodiscard]] auto boolean(bool /*unused*/) -> bool { return Scalar(); }
+    [[nodiscard]] auto number_integer(number_integer_t /*unused*/) -> bool {
+        return Number();
+    }
+    [[nodiscard]] auto number_unsigned(number_unsigned_t /*unused*/) -> bool {
+        return Number();
+    }
+    [[nodiscard]] auto number_float(number_float_t /*unused*/,
+                                    string_t const& /*unused*/) -> bool {
+        return Number();
+    }
+    [[nodiscard]] auto string(string_t& /*unused*/) -> bool {
+        return Scalar();
+    }
+    [[nodiscard]] static auto binary(binary_t& /*unused*/) -> bool {
+        return false;  // not part of JSON text
+    }
+    [[nodiscard]] auto start_object(std::size_t /*unused*/) -> bool {
+        is_object_ = is_object_ or depth_ == 0;
+        ++depth_;
+        return true;
+    }
+    [[nodiscard]] auto key(string_t& val) -> bool {
+        if (depth_ == 1) {
+            key_ = std::move(val);
+            key_end_ = Position();
+        }
+        return true;
+    }
+    [[nodiscard]] auto end_object() -> bool { return EndContainer(); }
+    [[nodiscard]] auto start_array(std::size_t /*unused*/) -> bool {
+        ++depth_;
+        return depth_ > 1;
+    }
+    [[nodiscard]] auto end_array() -> bool { return EndContainer(); }
+    template <class Exception>
+    [[nodiscard]] static auto parse_error(std::size_t /*unused*/,
+                                          std::string const& /*unused*/,
+                                          Exception const& ex) -> bool {
+        throw ex;
+    }
+
+    [[nodiscard]] auto IsObject() const noexcept -> bool { return is_object_; }
+    [[nodiscard]] auto Result() && -> std::vector<Entry> {
+        return std::move(entries_);
+    }
+
+  private:
+    std::string const& text_;
+    char const* const* read_up_to_;
+    std::size_t depth_{};
+    bool is_object_{};
+    std::string key_{};
+    std::size_t key_end_{};
+    std::vector<Entry> entries_{};
+
+    [[nodiscard]] auto Position() const -> std::size_t {
+        return static_cast<std::size_t>(*read_up_to_ - text_.data());
+    }
+
+    [[nodiscard]] auto Scalar() -> bool {
+        if (depth_ == 1) {
+            Record(Position());
+        }
+        return depth_ > 0;
+    }
+
+    [[nodiscard]] auto Number() -> bool {
+        if (depth_ == 1) {
+            // the character terminating a number is read as well
+            auto end = Position();
+            while (std::isdigit(static_cast<unsigned char>(text_[end - 1])) ==
+                   0) {
+                --end;
+            }
+            Record(end);
+        }
+        return depth_ > 0;
+    }
+
+    [[nodiscard]] auto EndContainer() -> bool {
+        if (--depth_ == 1) {
+            Record(Position());
+        }
+        return true;
+    }
+
+    void Record(std::size_t end) {
+        // skip the separator between key and value
+        auto begin = text_.find(':', key_end_) + 1;
+        entries_.emplace_back(Entry{std::move(key_), begin, end});
+    }
+};
+
+/// \brief SAX handler building documents for the values not descended into,
+/// see ReadJsonMembers.
+class MemberReader {
+  public:
+    using number_integer_t = nlohmann::json::number_integer_t;
+    using number_unsigned_t = nlohmann::json::number_unsigned_t;
+    using number_float_t = nlohmann::json::number_float_t;
+    using string_t = nlohmann::json::string_t;
+    using binary_t = nlohmann::json::binary_t;
+
+    MemberReader(std::size_t depth, JsonMemberCallback const& callback)
+        : depth_{depth}, callback_{callback} {}
+
+    [[nodiscard]] auto null() -> bool { return Add(nullptr); }
+    [[nodiscard]] auto boolean(bool val) -> bool { return Add(val); }
+    [[nodiscard]] auto number_integer(number_integer_t val) -> bool {
+        return Add(val);
+    }
+    [[nodiscard]] auto number_unsigned(number_unsigned_t val) -> bool {
+        return Add(val);
+    }
+    [[nodiscard]] auto number_float(number_float_t val,
+                                    string_t const& /*unused*/) -> bool {
+        return Add(val);
+    }
+    [[nodiscard]] auto string(string_t& val) -> bool {
+        return Add(std::move(val));
+    }
+    [[nodiscard]] static auto binary(binary_t& /*unused*/) -> bool {
+        return false;  // not part of JSON text
+    }
+    [[nodiscard]] auto start_object(std::size_t /*unused*/) -> bool {
+        if (stack_.empty() and levels_.size() < depth_) {
+            // descend; the key of the top-level object is a placeholder
+            levels_.emplace_back(Level{std::move(key_)});
+            return true;
+        }
+        return Start(nlohmann::json::object());
+    }
+    [[nodiscard]] auto key(string_t& val) -> bool {
+        if (stack_.empty()) {
+            levels_.back().empty = false;
+            key_ = std::move(val);
+        }
+        else {
+            stack_.back().key = std::move(val);
+        }
+        return true;
+    }
+    [[nodiscard]] auto end_object() -> bool {
+        if (stack_.empty()) {
+            auto level = std::move(levels_.back());
+            levels_.pop_back();
+            if (level.empty and not levels_.empty()) {
+                // hand out empty objects, so that every member is seen
+                key_ = std::move(level.key);
+                return Add(nlohmann::json::object());
+            }
+            return true;
+        }
+        return End();
+    }
+    [[nodiscard]] auto start_array(std::size_t /*unused*/) -> bool {
+        return Start(nlohmann::json::array());
+    }
+    [[nodiscard]] auto end_array() -> bool { return End(); }
+    template <class Exception>
+    [[nodiscard]] static auto parse_error(std::size_t /*unused*/,
+                                          std::string const& /*unused*/,
+                                          Exception const& ex) -> bool {
+        throw ex;
+    }
+
+  private:
+    struct Level {
+        std::string key;
+        bool empty{true};
+    };
+    struct Frame {
+        nlohmann::json value;
+        std::string key{};
+    };
+
+    std::size_t depth_;
+    JsonMemberCallback const& callback_;
+    std::vector<Level> levels_{};
+    std::string key_{};
+    std::vector<Frame> stack_{};
+
+    [[nodiscard]] auto Start(nlohmann::json&& value) -> bool {
+        if (levels_.empty()) {
+            return false;  // not an object
+        }
+        stack_.emplace_back(Frame{std::move(value)});
+        return true;
+    }
+
+    [[nodiscard]] auto End() -> bool {
+        auto value = std::move(stack_.back().value);
+        stack_.pop_back();
+        return Add(std::move(value));
+    }
+
+    [[nodiscard]] auto Add(nlohmann::json&& value) -> bool {
+        if (stack_.empty()) {
+            if (levels_.empty()) {
+                return false;  // not an object
+            }
+            // keys of the objects descended into, without the top-level one
+            std::vector<std::string> keys{};
+            keys.reserve(levels_.size());
+            for (auto it = levels_.begin() + 1; it != levels_.end(); ++it) {
+                keys.emplace_back(it->key);
+            }
+            keys.emplace_back(std::move(key_));
+            return callback_(keys, std::move(value));
+        }
+        auto& top = stack_.back();
+        if (top.value.is_object()) {
+            top.value[std::move(top.key)] = std::move(value);
+        }
+        else {
+            top.value.emplace_back(std::move(value));
+        }
+        return true;
+    }
+};
+
+template <class T>
+[[nodiscard]] auto ReadJsonMembersFrom(T&& input,
+                                       std::size_t depth,
+                                       JsonMemberCallback const& callback)
+    -> bool {
+    MemberReader reader{depth, callback};
+    return nlohmann::json::sax_parse(std::forward<T>(input), &reader);
+}
+
+}  // namespace
+
+LazyJsonObject::LazyJsonObject() : data_{std::make_shared<Data const>()} {}
+
+auto LazyJsonObject::Parse(std::string text) -> std::optional<LazyJsonObject> {
+    auto data = std::make_shared<Data>();
+    data->text = std::move(text);
+    auto const& content = data->text;
+    char const* read_up_to = content.data();
+    EntryIndexer indexer{content, &read_up_to};
+    nlohmann::json::sax_parse(
+        TrackingIterator{content.data(), &read_up_to},
+        TrackingIterator{content.data() + content.size(), &read_up_to},
+        &indexer);
+    if (not indexer.IsObject()) {
+        return std::nullopt;
+    }
+    // later duplicates overwrite earlier ones
+    for (auto& [key, begin, end] : std::move(indexer).Result()) {
+        auto& entry = data->entries[std::move(key)];
+        entry.begin = begin;
+        entry.end = end;
+    }
+    return LazyJsonObject{std::move(data)};
+}
+
+auto LazyJsonObject::Keys() const -> std::vector<std::string> {
+    std::vector<std::string> keys{};
+    keys.reserve(data_->entries.size());
+    for (auto const& [key, _] : data_->entries) {
+        keys.emplace_back(key);
+    }
+    return keys;
+}
+
+auto LazyJsonObject::Find(std::string const& key) const
+    -> nlohmann::json const* {
+    auto it = data_->entries.find(key);
+    if (it == data_->entries.end()) {
+        return nullptr;
+    }
+    auto const& entry = it->second;
+    std::call_once(entry.parsed, [this, &entry]() {
+        auto const& text = data_->text;
+        entry.value =
+            nlohmann::json::parse(text.begin() + entry.begin,
+                                  text.begin() + entry.end);
+    });
+    return &entry.value;
+}
+
+auto LazyJsonObject::ToJson() const -> nlohmann::json {
+    return nlohmann::json::parse(data_->text);
+}
+
+auto ReadJsonMembers(std::string const& text,
+                     std::size_t depth,
+                     JsonMemberCallback const& callback) -> bool {
+    return ReadJsonMembersFrom(text, depth, callback);
+}
+
+auto ReadJsonMembers(std::istream& stream,
+                     std::size_t depth,
+                     JsonMemberCallback const& callback) -> bool {
+    return ReadJsonMembersFrom(stream, depth, callback);
+}
@@ -0,0 +1,117 @@
+// Copyright 2024 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INCLUDED_SRC_UTILS_CPP_LAZY_JSON_HPP
+#define INCLUDED_SRC_UTILS_CPP_LAZY_JSON_HPP
+
+#include <cstddef>
+#include <functional>
+#include <istream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "nlohmann/json.hpp"
+
+/// \brief A JSON object whose entries are only parsed when looked up. The
+/// text is validated once, recording where each top-level entry is, but no
+/// document is built for it. Each entry is parsed on its first lookup and
+/// kept from then on. Copies share the text and the parsed entries; lookups
+/// can be done concurrently. As for nlohmann::json, the last of duplicate
+/// keys takes precedence.
+class LazyJsonObject {
+  public:
+    /// \brief Create an empty object.
+    LazyJsonObject();
+
+    /// \brief Index the given JSON text.
+    /// \throws nlohmann::json::exception if the text is not valid JSON.
+    /// \returns std::nullopt if the text is valid JSON, but not an object.
+    [[nodiscard]] static auto Parse(std::string text)
+        -> std::optional<LazyJsonObject>;
+
+    [[nodiscard]] auto Size() const noexcept -> std::size_t {
+        return data_->entries.size();
+    }
+
+    [[nodiscard]] auto Empty() const noexcept -> bool {
+        return data_->entries.empty();
+    }
+
+    [[nodiscard]] auto Contains(std::string const& key) const noexcept
+        -> bool {
+        return data_->entries.contains(key);
+    }
+
+    /// \brief Get the keys of all entries, in sorted order.
+    [[nodiscard]] auto Keys() const -> std::vector<std::string>;
+
+    /// \brief Get the value of an entry, parsing it on first lookup.
+    /// \returns nullptr if there is no entry with the given key.
+    [[nodiscard]] auto Find(std::string const& key) const
+        -> nlohmann::json const*;
+
+    /// \brief The JSON text the object was created from.
+    [[nodiscard]] auto Text() const noexcept -> std::string const& {
+        return data_->text;
+    }
+
+    /// \brief Parse the whole object into a document.
+    [[nodiscard]] auto ToJson() const -> nlohmann::json;
+
+  private:
+    struct Entry {
+        std::size_t begin{};
+        std::size_t end{};
+        mutable std::once_flag parsed{};
+        mutable nlohmann::json value{};
+    };
+    struct Data {
+        std::string text{"{}"};
+        std::map<std::string, Entry> entries{};
+    };
+
+    std::shared_ptr<Data const> data_;
+
+    explicit LazyJsonObject(std::shared_ptr<Data const> data)
+        : data_{std::move(data)} {}
+};
+
+/// \brief Callback for the values read by \ref ReadJsonMembers, given with
+/// the keys leading to them. Returning false stops reading.
+using JsonMemberCallback =
+    std::function<bool(std::vector<std::string> const& keys,
+                       nlohmann::json&& value)>;
+
+/// \brief Read a JSON object member by member, without building a document
+/// for it. Object values are descended into up to the given depth, the
+/// object read being at depth 1. Every other value, as well as every empty
+/// object descended into, is handed to the callback as soon as it is
+/// complete, and dropped afterwards.
+/// \throws nlohmann::json::exception if the input is not valid JSON.
+/// \returns false if the input is not an object or reading was stopped.
+[[nodiscard]] auto ReadJsonMembers(std::string const& text,
+                                   std::size_t depth,
+                                   JsonMemberCallback const& callback) -> bool;
+
+/// \brief Read a JSON object member by member from a stream; see above.
+[[nodiscard]] auto ReadJsonMembers(std::istream& stream,
+                                   std::size_t depth,
+                                   JsonMemberCallback const& callback) -> bool;
+
+#endif  // INCLUDED_SRC_UTILS_CPP_LAZY_JSON_HPP
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstddef>
 #include <filesystem>
 #include <functional>
 #include <memory>
@@ -19,7 +20,10 @@
 #include <utility>  // std::move
 
 #include "catch2/catch_test_macros.hpp"
+#include "gsl/gsl"
+#include "src/buildtool/build_engine/base_maps/analysis_profile.hpp"
 #include "src/buildtool/build_engine/base_maps/entity_name_data.hpp"
+#include "src/buildtool/build_engine/base_maps/expression_call_memo.hpp"
 #include "src/buildtool/build_engine/base_maps/expression_map.hpp"
 #include "src/buildtool/build_engine/base_maps/json_file_map.hpp"
 #include "src/buildtool/build_engine/expression/expression.hpp"
@@ -135,6 +139,79 @@ TEST_CASE("Simple call of imported expression", "[expression_map]") {
     }
 }
 
+TEST_CASE("Memoised call of imported expression", "[expression_map]") {
+    auto& memo = ExpressionCallMemo::Instance();
+    memo.Enable(1024);  // NOLINT
+    auto const disable = gsl::finally([&memo]() { memo.Disable(); });
+    auto name = EntityName{"", ".", "test_call_import"};
+    auto consumer = [&memo](auto values) {
+        REQUIRE(*values[0]);
+        auto hits = memo.Hits();
+        auto misses = memo.Misses();
+        for (auto const& value : {"bar", "baz", "bar", "baz"}) {
+            auto expr = (*values[0])
+                            ->Evaluate(Configuration{Expression::FromJson(
+                                           nlohmann::json{{"FOO", value}})},
+                                       {});
+            REQUIRE(expr);
+            CHECK(expr == Expression{std::string{value}});
+        }
+        // functions are loaded anew, so only the repeated calls are hits
+        CHECK(memo.Misses() == misses + 2);
+        CHECK(memo.Hits() == hits + 2);
+    };
+
+    SECTION("via file") {
+        CHECK(ReadExpressionFunction(name, consumer, /*use_git=*/false));
+    }
+
+    SECTION("via git tree") {
+        CHECK(ReadExpressionFunction(name, consumer, /*use_git=*/true));
+    }
+}
+
+TEST_CASE("Profiled call of imported expression", "[expression_map]") {
+    auto& profile = AnalysisProfile::Instance();
+    profile.Enable();
+    auto const disable = gsl::finally([&profile]() { profile.Disable(); });
+    auto evaluations = [&profile](EntityName const& id) -> std::size_t {
+        auto const report = profile.ToJson();
+        for (auto const& entry : report["expressions"]) {
+            if (entry["expression"] == id.ToString()) {
+                return entry["evaluations"];
+            }
+        }
+        return 0;
+    };
+    auto name = EntityName{"", ".", "test_call_import"};
+    // expressions are accounted to their normalized names
+    auto callee = EntityName{"", "", "test_call_import"};
+    auto import = EntityName{"", "readers", "real_foo_reader"};
+    auto consumer = [&evaluations, &callee, &import](auto values) {
+        REQUIRE(*values[0]);
+        auto calls = evaluations(callee);
+        auto imported_calls = evaluations(import);
+        for (auto const& value : {"bar", "baz"}) {
+            auto expr = (*values[0])
+                            ->Evaluate(Configuration{Expression::FromJson(
+                                           nlohmann::json{{"FOO", value}})},
+                                       {});
+            REQUIRE(expr);
+            CHECK(expr == Expression{std::string{value}});
+        }
+        CHECK(evaluations(callee) == calls + 2);
+        CHECK(evaluations(import) == imported_calls + 2);
+    };
+
+    SECTION("via file") {
+        CHECK(ReadExpressionFunction(name, consumer, /*use_git=*/false));
+    }
+
+    SECTION("via git tree") {
+        CHECK(ReadExpressionFunction(name, consumer, /*use_git=*/true));
+    }
+}
+
 TEST_CASE("Overwrite import in nested expression", "[expression_map]") {
     auto name = EntityName{"", ".", "test_overwrite_import"};
     auto consumer = [](auto values) {
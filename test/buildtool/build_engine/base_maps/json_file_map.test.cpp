@@ -19,8 +19,10 @@
 
 #include "catch2/catch_test_macros.hpp"
 #include "src/buildtool/build_engine/base_maps/json_file_map.hpp"
+#include "src/buildtool/build_engine/base_maps/targets_file_map.hpp"
 #include "src/buildtool/common/repository_config.hpp"
 #include "src/buildtool/file_system/file_root.hpp"
+#include "src/buildtool/file_system/file_system_manager.hpp"
 #include "src/buildtool/multithreading/task_system.hpp"
 #include "test/buildtool/build_engine/base_maps/test_repo.hpp"
 
@@ -77,7 +79,8 @@ TEST_CASE("simple usage") {
     bool as_expected{false};
     auto name = ModuleName{"", "data_json"};
     auto consumer = [&as_expected](auto values) {
-        if ((*values[0])["foo"] == "bar") {
+        auto const* foo = values[0]->Find("foo");
+        if (foo != nullptr and *foo == "bar") {
             as_expected = true;
         };
     };
@@ -100,7 +103,7 @@ TEST_CASE("non existent") {
     auto consumer = [&as_expected](auto values) {
         // Missing optional files are expected to result in empty objects with
         // no entries in it.
-        if (values[0]->is_object() && values[0]->empty()) {
+        if (values[0]->Empty()) {
             as_expected = true;
         };
     };
@@ -153,3 +156,56 @@ TEST_CASE("Bad syntax") {
         [&failcont_counter]() { failcont_counter++; }));
     CHECK(failcont_counter == 1);
 }
+
+TEST_CASE("Targets files of referenced modules are read ahead") {
+    auto root_path = GetTestDir() / "read_ahead";
+    REQUIRE(FileSystemManager::RemoveDirectory(root_path, true));
+    auto write_targets = [&root_path](std::string const& module,
+                                      std::string const& content) {
+        REQUIRE(FileSystemManager::CreateDirectory(root_path / module));
+        REQUIRE(FileSystemManager::WriteFile(content,
+                                             root_path / module / "TARGETS"));
+    };
+    write_targets(
+        "a",
+        R"({"x": {"type": "t", "srcs": ["d", "w"], "deps": [["b", "y"]]}})");
+    write_targets("b", R"({"y": {"type": "t", "deps": [["./", "c", "z"]]}})");
+    write_targets("b/c", R"({"z": {"type": ["@", "r", "m", "t"]}})");
+    write_targets("d", R"({"w": {"type": "t"}})");
+
+    RepositoryConfig repo_config{};
+    repo_config.SetInfo("",
+                        RepositoryConfig::RepositoryInfo{FileRoot{root_path}});
+    auto targets_files = CreateTargetsFileMap(&repo_config, 0);
+    {
+        TaskSystem ts;
+        targets_files.ConsumeAfterKeysReady(
+            &ts,
+            {ModuleName{"", "a"}},
+            [](auto values) { CHECK(values[0]->Contains("x")); },
+            [](std::string const& /*unused*/, bool /*unused*/) {
+                CHECK(false);
+            });
+    }
+
+    // only the file of the module referred to as a target was read along with
+    // the first; files are not read ahead transitively, and lists of plain
+    // strings are not taken as target references
+    write_targets("b", "{}");
+    write_targets("b/c", "{}");
+    write_targets("d", "{}");
+    {
+        TaskSystem ts;
+        targets_files.ConsumeAfterKeysReady(
+            &ts,
+            {ModuleName{"", "b"}, ModuleName{"", "b/c"}, ModuleName{"", "d"}},
+            [](auto values) {
+                CHECK(values[0]->Contains("y"));
+                CHECK(values[1]->Empty());
+                CHECK(values[2]->Empty());
+            },
+            [](std::string const& /*unused*/, bool /*unused*/) {
+                CHECK(false);
+            });
+    }
+}
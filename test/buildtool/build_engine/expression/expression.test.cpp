@@ -12,6 +12,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <cstddef>
 #include <filesystem>
 #include <sstream>
 #include <string>
@@ -20,6 +22,7 @@
 #include "catch2/catch_test_macros.hpp"
 #include "catch2/matchers/catch_matchers_all.hpp"
 #include "src/buildtool/build_engine/expression/configuration.hpp"
+#include "src/buildtool/build_engine/expression/evaluator.hpp"
 #include "src/buildtool/build_engine/expression/expression.hpp"
 #include "src/buildtool/build_engine/expression/function_map.hpp"
 #include "test/utils/container_matchers.hpp"
@@ -264,6 +267,51 @@ TEST_CASE("Expression from JSON", "[expression]") {
     CHECK(map->Map().empty());
 }
 
+TEST_CASE("Expression from JSON text", "[expression]") {
+    auto const text = std::string{R"(
+        { "null": null
+        , "bool": [true, false]
+        , "numbers": [0, -42, 18446744073709551615, 3.25, 1e3]
+        , "strings": ["", "foo", "\u00e4\n\"bar\""]
+        , "nested": {"list": [[], {}, [{"a": [1, {"b": null}]}]]}
+        , "dup": "first"
+        , "dup": "last"
+        })"};
+
+    auto expected = Expression::FromJson(nlohmann::json::parse(text));
+    REQUIRE(expected);
+
+    SECTION("from string") {
+        auto expr = Expression::ParseJson(text);
+        REQUIRE(expr);
+        CHECK(expr == expected);
+        CHECK(expr["dup"] == Expression::FromJson(R"("last")"_json));
+    }
+
+    SECTION("from stream") {
+        auto stream = std::istringstream{text};
+        auto expr = Expression::ParseJson(stream);
+        REQUIRE(expr);
+        CHECK(expr == expected);
+    }
+
+    SECTION("scalar values") {
+        auto none = Expression::ParseJson("null");
+        REQUIRE(none);
+        CHECK(none->IsNone());
+        CHECK(Expression::ParseJson("4711") ==
+              Expression::FromJson("4711"_json));
+        CHECK(Expression::ParseJson(R"("foo")") ==
+              Expression::FromJson(R"("foo")"_json));
+    }
+
+    SECTION("malformed text") {
+        CHECK_THROWS(Expression::ParseJson(""));
+        CHECK_THROWS(Expression::ParseJson(R"({"foo": )"));
+        CHECK_THROWS(Expression::ParseJson("[1, 2] 3"));
+    }
+}
+
 namespace {
 auto TestToJson(nlohmann::json const& json) -> void {
     auto expr = Expression::FromJson(json);
@@ -1684,6 +1732,107 @@ TEST_CASE("Expression Assertions", "[expression]") {
     }
 }
 
+TEST_CASE("Compiled expression evaluation", "[expression]") {
+    using namespace std::string_literals;
+    auto env = Configuration{};
+    auto fcts = FunctionMap::MakePtr(
+        "concat", [](auto&& eval, auto const& expr, auto const& env) {
+            auto p1 = eval(expr->Get("$1", ""s), env);
+            auto p2 = eval(expr->Get("$2", ""s), env);
+            return ExpressionPtr{p1->String() + p2->String()};
+        });
+
+    auto expr = Expression::FromJson(R"(
+        { "type": "foreach"
+        , "var": "x"
+        , "range": {"type": "var", "name": "xs"}
+        , "body": { "type": "concat"
+                  , "$1": {"type": "var", "name": "x"}
+                  , "$2": {"type": "join", "$1": ["-", "y"]} }})"_json);
+    REQUIRE(expr);
+    auto compiled = Evaluator::CompiledExpression::Compile(expr);
+    REQUIRE(compiled);
+
+    SECTION("same result as direct evaluation") {
+        for (auto const& xs : {R"(["foo", "bar"])"_json, R"([])"_json}) {
+            auto config = env.Update("xs", Expression::FromJson(xs));
+            auto direct = expr.Evaluate(config, fcts);
+            REQUIRE(direct);
+            auto result = Evaluator::EvaluateExpression(
+                *compiled, config, fcts, [](auto const& /*unused*/) {});
+            CHECK(result == direct);
+        }
+    }
+
+    SECTION("errors are reported") {
+        std::stringstream log{};
+        auto result = Evaluator::EvaluateExpression(
+            *compiled,
+            env.Update("xs", Expression::FromJson(R"([1])"_json)),
+            fcts,
+            [&log](auto const& msg) { log << msg; });
+        CHECK_FALSE(result);
+        CHECK(log.str().find(R"("concat"-expression)") != std::string::npos);
+    }
+
+    SECTION("unknown provider functions") {
+        std::stringstream log{};
+        auto result = Evaluator::EvaluateExpression(
+            *compiled,
+            env.Update("xs", Expression::FromJson(R"(["foo"])"_json)),
+            FunctionMapPtr{},
+            [&log](auto const& msg) { log << msg; });
+        CHECK_FALSE(result);
+        CHECK(log.str().find("Unknown syntactical construct concat") !=
+              std::string::npos);
+    }
+
+    SECTION("provider functions shadow built-in ones") {
+        auto shadowing = FunctionMap::MakePtr(
+            fcts,
+            "join",
+            [](auto&& /*eval*/, auto const& /*expr*/, auto const& /*env*/) {
+                return ExpressionPtr{"shadowed"s};
+            });
+        auto config = env.Update(
+            "xs", Expression::FromJson(R"(["foo", "bar"])"_json));
+        auto direct = expr.Evaluate(config, shadowing);
+        REQUIRE(direct);
+        CHECK(direct == Expression::FromJson(
+                            R"(["fooshadowed", "barshadowed"])"_json));
+        auto result = Evaluator::EvaluateExpression(
+            *compiled, config, shadowing, [](auto const& /*unused*/) {});
+        CHECK(result == direct);
+    }
+}
+
+TEST_CASE("Deep let* chains", "[expression]") {
+    // every binding extends the environment by one map, using the previous
+    // binding
+    constexpr int kBindings{4000};
+    auto bindings = nlohmann::json::array();
+    bindings.push_back({"x0", 0});
+    for (int i{1}; i < kBindings; ++i) {
+        bindings.push_back(
+            {"x" + std::to_string(i),
+             {{"type", "+"},
+              {"$1",
+               {{{"type", "var"}, {"name", "x" + std::to_string(i - 1)}},
+                1}}}});
+    }
+    auto expr = Expression::FromJson(nlohmann::json{
+        {"type", "let*"},
+        {"bindings", bindings},
+        {"body",
+         {{"type", "var"}, {"name", "x" + std::to_string(kBindings - 1)}}}});
+    REQUIRE(expr);
+
+    auto result = expr.Evaluate(Configuration{}, FunctionMapPtr{});
+    REQUIRE(result);
+    REQUIRE(result->IsNumber());
+    CHECK(result->Number() == kBindings - 1);
+}
+
 TEST_CASE("Expression hash computation", "[expression]") {
     using namespace std::string_literals;
     using path = std::filesystem::path;
@@ -1746,3 +1895,189 @@ TEST_CASE("Expression hash computation", "[expression]") {
         }
     }
 }
+
+TEST_CASE("Expression comparison by structural hash", "[expression]") {
+    using namespace std::string_literals;
+    using path = std::filesystem::path;
+    using artifact_t = Expression::artifact_t;
+    using map_t = Expression::map_t;
+
+    auto const values = std::vector<nlohmann::json>{
+        nullptr,
+        false,
+        true,
+        0,
+        1.5,  // NOLINT
+        "",
+        "a",
+        "null",
+        R"(["a", "b"])"_json,
+        R"(["b", "a"])"_json,
+        R"([["a"], "b"])"_json,
+        R"({"a": 1, "b": ["x"]})"_json,
+        R"({"a": 1, "b": ["y"]})"_json,
+        R"({"a": 1})"_json};
+    auto create = [&values]() {
+        auto exprs = std::vector<ExpressionPtr>{};
+        for (auto const& value : values) {
+            exprs.emplace_back(Expression::FromJson(value));
+        }
+        exprs.emplace_back(artifact_t{path{"x"}});
+        exprs.emplace_back(artifact_t{path{"y"}});
+        // same entries as {"a": 1, "b": ["x"]}, but as overlay
+        exprs.emplace_back(map_t{
+            Expression::FromJson(R"({"a": 1, "b": ["y"]})"_json),
+            Expression::FromJson(R"({"b": ["x"]})"_json)});
+        return exprs;
+    };
+
+    auto left = create();
+    auto right = create();
+    for (auto const& l : left) {
+        for (auto const& r : right) {
+            INFO(l->ToString() << " vs. " << r->ToString());
+            auto equal = l->ToHash() == r->ToHash();
+            CHECK((l == r) == equal);
+            if (equal) {
+                CHECK(l->StructuralHash() == r->StructuralHash());
+                CHECK(std::hash<ExpressionPtr>{}(l) ==
+                      std::hash<ExpressionPtr>{}(r));
+            }
+            // exactly one of less, greater, and equal holds
+            CHECK((l < r) + (r < l) + (l == r) == 1);
+        }
+    }
+
+    // comparison does not depend on whether the hashes are known already
+    auto unhashed_left = create();
+    auto unhashed_right = create();
+    for (std::size_t i{}; i < left.size(); ++i) {
+        for (std::size_t j{}; j < right.size(); ++j) {
+            auto equal = left[i] == right[j];
+            CHECK((unhashed_left[i] == unhashed_right[j]) == equal);
+            CHECK((left[i] == unhashed_right[j]) == equal);
+        }
+    }
+}
+
+TEST_CASE("Parallel foreach evaluation", "[expression]") {
+    auto fcts = FunctionMapPtr{};
+    auto range =
+        R"({"type": "range", "$1": {"type": "var", "name": "n"}})"_json;
+    auto range_map = R"(
+        { "type": "map_union"
+        , "$1":
+          { "type": "foreach"
+          , "range": {"type": "range", "$1": {"type": "var", "name": "n"}}
+          , "body":
+            { "type": "singleton_map"
+            , "key": {"type": "var", "name": "_"}
+            , "value": {"type": "var", "name": "_"}
+            }
+          }
+        })"_json;
+    // joins the element with the elements of a nested loop, failing for two
+    // of the elements
+    auto body = R"(
+        { "type": "case"
+        , "expr": {"type": "var", "name": "_"}
+        , "case":
+          { "42": {"type": "fail", "msg": "failed at 42"}
+          , "77": {"type": "fail", "msg": "failed at 77"}
+          }
+        , "default":
+          { "type": "join"
+          , "$1":
+            { "type": "foreach"
+            , "var": "y"
+            , "range": ["a", "b", {"type": "var", "name": "_"}]
+            , "body": {"type": "var", "name": "y"}
+            }
+          }
+        })"_json;
+    auto foreach = nlohmann::json{
+        {"type", "foreach"}, {"range", range}, {"body", body}};
+    auto foreach_map = nlohmann::json{{"type", "foreach_map"},
+                                      {"range", range_map},
+                                      {"var_key", "_"},
+                                      {"body", body}};
+    auto evaluate = [&fcts](nlohmann::json const& json, std::size_t n) {
+        auto expr = Expression::FromJson(json);
+        REQUIRE(expr);
+        auto env = Configuration{Expression::FromJson(
+            nlohmann::json{{"n", static_cast<Expression::number_t>(n)}})};
+        std::stringstream log{};
+        auto result = expr.Evaluate(
+            env, fcts, [&log](auto const& msg) { log << msg; });
+        return std::make_pair(result, log.str());
+    };
+
+    for (auto const& expr : {foreach, foreach_map}) {
+        for (std::size_t n : {10, 50, 100}) {  // NOLINT
+            Evaluator::SetParallelForeach(0, 0);
+            auto [expected, expected_log] = evaluate(expr, n);
+            Evaluator::SetParallelForeach(2, 4);  // NOLINT
+            auto [result, log] = evaluate(expr, n);
+            Evaluator::SetParallelForeach(0, 0);
+
+            CHECK(static_cast<bool>(result) == (n < 50));  // NOLINT
+            if (expected) {
+                REQUIRE(result);
+                CHECK(result == expected);
+                CHECK(result->List().size() == n);
+            }
+            else {
+                CHECK(log == expected_log);
+                CHECK_THAT(log, Catch::Matchers::ContainsSubstring("at 42"));
+            }
+        }
+    }
+}
+
+TEST_CASE("Parallel foreach with provided functions", "[expression]") {
+    // records its argument as side effect, like ACTION records actions
+    std::vector<std::string> recorded{};
+    auto fcts = FunctionMap::MakePtr(
+        "RECORD", [&recorded](auto&& eval, auto const& expr, auto const& env) {
+            auto value = eval(expr["$1"], env);
+            Evaluator::Effect([&recorded, value]() {
+                recorded.emplace_back(value->String());
+            });
+            return value;
+        });
+    auto expr = Expression::FromJson(R"(
+        { "type": "foreach"
+        , "range": {"type": "range", "$1": {"type": "var", "name": "n"}}
+        , "body":
+          { "type": "RECORD"
+          , "$1":
+            { "type": "case"
+            , "expr": {"type": "var", "name": "_"}
+            , "case": {"42": {"type": "fail", "msg": "failed at 42"}}
+            , "default": {"type": "var", "name": "_"}
+            }
+          }
+        })"_json);
+    REQUIRE(expr);
+    auto evaluate = [&expr, &fcts, &recorded](std::size_t n) {
+        recorded.clear();
+        auto env = Configuration{Expression::FromJson(
+            nlohmann::json{{"n", static_cast<Expression::number_t>(n)}})};
+        auto result = expr.Evaluate(env, fcts, [](auto const& /*unused*/) {});
+        return std::make_pair(result, recorded);
+    };
+
+    for (std::size_t n : {10, 50, 100}) {  // NOLINT
+        Evaluator::SetParallelForeach(0, 0);
+        auto [expected, expected_recorded] = evaluate(n);
+        Evaluator::SetParallelForeach(2, 4);  // NOLINT
+        auto [result, result_recorded] = evaluate(n);
+        Evaluator::SetParallelForeach(0, 0);
+
+        CHECK(static_cast<bool>(result) == (n < 50));  // NOLINT
+        CHECK(result == expected);
+        // effects happen in order, up to the first failing element
+        CHECK(result_recorded == expected_recorded);
+        CHECK(result_recorded.size() == std::min(n, std::size_t{42}));
+    }
+}
@@ -15,8 +15,10 @@
 #include <algorithm>
 #include <cstddef>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>  // std::move
+#include <vector>
 
 #include "catch2/catch_test_macros.hpp"
 #include "src/buildtool/build_engine/expression/linked_map.hpp"
@@ -244,6 +246,76 @@ TEST_CASE("Custom NextPtr", "[linked_map]") {
     }
 }
 
+TEST_CASE("Lookup in large unions", "[linked_map]") {
+    using map_t = LinkedMap<std::string, int>;
+    constexpr int kCount{10000};
+
+    // Unite singleton maps pairwise, as map_union does; the key "shadowed"
+    // is present in every map, the one in the last map taking precedence.
+    auto maps = std::vector<map_t::Ptr>{};
+    maps.reserve(kCount);
+    for (int i{0}; i < kCount; ++i) {
+        maps.emplace_back(map_t::MakePtr(map_t::underlying_map_t{
+            {std::to_string(i), i}, {"shadowed", i}}));
+    }
+    while (maps.size() > 1) {
+        auto united = std::vector<map_t::Ptr>{};
+        united.reserve((maps.size() + 1) / 2);
+        for (std::size_t i{0}; i + 1 < maps.size(); i += 2) {
+            united.emplace_back(map_t::MakePtr(maps[i], maps[i + 1]));
+        }
+        if (maps.size() % 2 == 1) {
+            united.emplace_back(maps.back());
+        }
+        maps = std::move(united);
+    }
+    auto const& map = maps.front();
+    REQUIRE(map);
+    CHECK(map->size() == static_cast<std::size_t>(kCount) + 1);
+
+    for (int i{0}; i < kCount; ++i) {
+        auto key = std::to_string(i);
+        REQUIRE(map->contains(key));
+        CHECK(map->at(key) == i);
+    }
+    CHECK(map->at("shadowed") == kCount - 1);
+    CHECK_FALSE(map->contains("missing"));
+
+    auto shadowed = std::find_if(map->begin(), map->end(), [](auto const& e) {
+        return e.first == "shadowed";
+    });
+    REQUIRE(shadowed != map->end());
+    CHECK(shadowed->second == kCount - 1);
+}
+
+TEST_CASE("Lookup in deep chains", "[linked_map]") {
+    using map_t = LinkedMap<std::string, int>;
+    constexpr int kCount{10000};
+    constexpr int kUnited{100};
+
+    // A union of singleton maps, extended entry by entry, as environments
+    // are during evaluation; every extension shadows the key "shadowed".
+    auto united = map_t::MakePtr("u0", 0);
+    for (int i{1}; i < kUnited; ++i) {
+        united = map_t::MakePtr(united,
+                                map_t::MakePtr("u" + std::to_string(i), i));
+    }
+    auto map = united;
+    for (int i{0}; i < kCount; ++i) {
+        map = map_t::MakePtr(map, std::to_string(i), i);
+        map = map_t::MakePtr(map, "shadowed", i);
+        // look up recent entries, as the body of a let* binding does
+        REQUIRE(map->contains(std::to_string(i)));
+        CHECK(map->at("shadowed") == i);
+        // as does a lookup in a temporary, e.g., via Expression::At() &&
+        CHECK(map_t{map, "new", i}.Find("shadowed") == std::optional<int>{i});
+    }
+    for (int i{0}; i < kUnited; ++i) {
+        CHECK(map->at("u" + std::to_string(i)) == i);
+    }
+    CHECK_FALSE(map->contains("missing"));
+}
+
 TEST_CASE("Hash computation", "[linked_map]") {
     using map_t = LinkedMap<std::string, int>;
 
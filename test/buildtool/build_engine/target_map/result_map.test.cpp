@@ -15,18 +15,24 @@
 #include <cstdlib>
 #include <filesystem>
 #include <fstream>
+#include <iomanip>
 #include <memory>
+#include <sstream>
 #include <string>
 #include <vector>
 
 #include "catch2/catch_test_macros.hpp"
 #include "nlohmann/json.hpp"
 #include "src/buildtool/build_engine/analysed_target/analysed_target.hpp"
+#include "src/buildtool/build_engine/expression/configuration.hpp"
+#include "src/buildtool/build_engine/expression/expression.hpp"
 #include "src/buildtool/build_engine/expression/target_result.hpp"
 #include "src/buildtool/build_engine/target_map/result_map.hpp"
 #include "src/buildtool/common/action_description.hpp"
+#include "src/buildtool/common/binary_graph.hpp"
 #include "src/buildtool/common/statistics.hpp"
 #include "src/buildtool/file_system/file_system_manager.hpp"
+#include "src/buildtool/multithreading/task_system.hpp"
 #include "src/buildtool/progress_reporting/progress.hpp"
 
 namespace {
@@ -179,3 +185,188 @@ TEST_CASE("blobs uniqueness", "[result_map]") {
                                       {"blobs", {"bar", "baz", "foo"}},
                                       {"trees", nlohmann::json::object()}});
 }
+
+TEST_CASE("taking the result releases targets", "[result_map]") {
+    using BuildMaps::Base::EntityName;
+    using BuildMaps::Target::ResultTargetMap;
+
+    auto foo = std::make_shared<ActionDescription>(
+        ActionDescription::outputs_t{},
+        ActionDescription::outputs_t{},
+        Action{"run_foo", {"touch", "foo"}, {}},
+        ActionDescription::inputs_t{});
+
+    ResultTargetMap map{0};
+    std::weak_ptr<AnalysedTarget const> foobar{};
+    {
+        auto target = CreateAnalysedTarget(
+            {}, std::vector<ActionDescription::Ptr>{foo}, {"foo", "bar"});
+        foobar = target;
+        CHECK(map.Add(EntityName{"", ".", "foobar"}, {}, target));
+    }
+    auto barbaz = CreateAnalysedTarget({}, {}, {"bar", "baz"});
+    CHECK(map.Add(EntityName{"", ".", "barbaz"}, {}, barbaz));
+
+    Statistics stats{};
+    Progress progress{};
+    CHECK(not foobar.expired());
+
+    ResultTargetMap::ResultType<> result{};
+    {
+        TaskSystem ts{};
+        result = map.TakeResult(&ts, &stats, &progress);
+    }
+    REQUIRE(result.actions.size() == 1);
+    CHECK(result.actions[0]->Id() == foo->Id());
+    CHECK(result.blobs == std::vector<std::string>{"bar", "baz", "foo"});
+    CHECK(progress.OriginMap().contains(foo->Id()));
+
+    // only targets still referenced elsewhere survive
+    CHECK(foobar.expired());
+    CHECK(barbaz.use_count() == 1);
+    CHECK(map.ToJson(&stats, &progress) ==
+          nlohmann::json{{"actions", nlohmann::json::object()},
+                         {"blobs", nlohmann::json::array()},
+                         {"trees", nlohmann::json::object()}});
+}
+
+TEST_CASE("blobs consumer", "[result_map]") {
+    using BuildMaps::Base::EntityName;
+    using BuildMaps::Target::ResultTargetMap;
+
+    std::vector<std::vector<std::string>> consumed{};
+    ResultTargetMap map{0};
+    map.SetBlobsConsumer([&consumed](auto const& blobs) {
+        consumed.emplace_back(blobs);
+    });
+
+    CHECK(map.Add(EntityName{"", ".", "foobar"},
+                  {},
+                  CreateAnalysedTarget({}, {}, {"foo", "bar"})));
+    REQUIRE(consumed.size() == 1);
+    CHECK(consumed[0] == std::vector<std::string>{"foo", "bar"});
+
+    // Adding the same target again does not report its blobs again
+    CHECK(map.Add(EntityName{"", ".", "foobar"},
+                  {},
+                  CreateAnalysedTarget({}, {}, {"foo", "bar"})));
+    CHECK(consumed.size() == 1);
+
+    // Targets without blobs are not reported
+    CHECK(map.Add(EntityName{"", ".", "empty"},
+                  {},
+                  CreateAnalysedTarget({}, {}, {})));
+    CHECK(consumed.size() == 1);
+
+    CHECK(map.Add(EntityName{"", ".", "barbaz"},
+                  {},
+                  CreateAnalysedTarget({}, {}, {"bar", "baz"})));
+    REQUIRE(consumed.size() == 2);
+    CHECK(consumed[1] == std::vector<std::string>{"bar", "baz"});
+}
+
+TEST_CASE("lookup by effective configuration", "[result_map]") {
+    using BuildMaps::Base::EntityName;
+    using BuildMaps::Target::ResultTargetMap;
+
+    ResultTargetMap map{0};
+    auto target = EntityName{"", ".", "foobar"};
+    auto added = map.Add(
+        target,
+        Configuration{Expression::FromJson(R"({"FOO": "bar"})"_json)},
+        CreateAnalysedTarget({}, {}, {}));
+
+    // Variables the target does not depend on are irrelevant
+    CHECK(map.LookupEffective(
+              target,
+              Configuration{Expression::FromJson(
+                  R"({"FOO": "bar", "OTHER": "value"})"_json)}) == added);
+    CHECK(map.LookupEffective(
+              target,
+              Configuration{Expression::FromJson(R"({"FOO": "bar"})"_json)}) ==
+          added);
+
+    // ... but those it depends on are not
+    CHECK(map.LookupEffective(
+              target,
+              Configuration{Expression::FromJson(R"({"FOO": "baz"})"_json)}) ==
+          nullptr);
+    CHECK(map.LookupEffective(target, Configuration{}) == nullptr);
+    CHECK(map.LookupEffective(
+              EntityName{"", ".", "other"},
+              Configuration{Expression::FromJson(R"({"FOO": "bar"})"_json)}) ==
+          nullptr);
+
+    // Analyses depending on different sets of variables are all considered
+    auto unset = map.Add(
+        target,
+        Configuration{Expression::FromJson(R"({"BAR": null})"_json)},
+        CreateAnalysedTarget({}, {}, {}));
+    CHECK(map.LookupEffective(
+              target,
+              Configuration{Expression::FromJson(R"({"FOO": "baz"})"_json)}) ==
+          unset);
+}
+
+TEST_CASE("streamed graph", "[result_map]") {
+    using BuildMaps::Base::EntityName;
+    using BuildMaps::Target::ResultTargetMap;
+
+    auto foo = std::make_shared<ActionDescription>(
+        ActionDescription::outputs_t{"foo"},
+        ActionDescription::outputs_t{},
+        Action{"run_foo", {"touch", "foo"}, {{"PATH", "/bin"}}},
+        ActionDescription::inputs_t{});
+    auto bar = std::make_shared<ActionDescription>(
+        ActionDescription::outputs_t{"bar"},
+        ActionDescription::outputs_t{},
+        Action{"run_bar", {"sh", "-c", "echo \"b\\na\u00e4r\" > bar"}, {}},
+        ActionDescription::inputs_t{
+            {"foo",
+             ArtifactDescription{std::string{"run_foo"},
+                                 std::filesystem::path{"foo"}}}});
+    auto tree = std::make_shared<Tree>(ActionDescription::inputs_t{
+        {"bar",
+         ArtifactDescription{std::string{"run_bar"},
+                             std::filesystem::path{"bar"}}}});
+
+    ResultTargetMap map{0};
+    CHECK(map.Add(EntityName{"", ".", "foobar"},
+                  {},
+                  std::make_shared<AnalysedTarget const>(
+                      TargetResult{},
+                      std::vector<ActionDescription::Ptr>{foo, bar},
+                      std::vector<std::string>{"blob"},
+                      std::vector<Tree::Ptr>{tree},
+                      std::unordered_set<std::string>{},
+                      std::set<std::string>{},
+                      std::set<std::string>{},
+                      TargetGraphInformation::kSource)));
+    CHECK(map.Add(EntityName{"", ".", "foo"},
+                  Configuration{Expression::FromJson(R"({"x": "y"})"_json)},
+                  CreateAnalysedTarget(
+                      {}, std::vector<ActionDescription::Ptr>{foo}, {"b"})));
+
+    Statistics stats{};
+    Progress progress{};
+    for (int indent : {2, 4, 0}) {
+        std::ostringstream expected{};
+        expected << std::setw(indent) << map.ToJson<true>(&stats, &progress);
+        std::ostringstream streamed{};
+        map.ToStream(&streamed, &stats, &progress, indent);
+        CHECK(streamed.str() == expected.str());
+    }
+
+    auto filename = (GetTestDir() / "test_streamed.graph").string();
+    REQUIRE(map.ToBinaryFile(filename, &stats, &progress));
+    auto content = FileSystemManager::ReadFile(filename);
+    REQUIRE(content);
+    CHECK(BinaryGraph::Decode(*content) == map.ToJson<true>(&stats, &progress));
+
+    ResultTargetMap empty{0};
+    std::ostringstream expected{};
+    expected << std::setw(2) << empty.ToJson<true>(&stats, &progress);
+    std::ostringstream streamed{};
+    empty.ToStream(&streamed, &stats, &progress);
+    CHECK(streamed.str() == expected.str());
+}
@@ -590,6 +590,89 @@ TEST_CASE_METHOD(HermeticLocalTestFixture,
     CHECK(analysis_result.actions.size() == 2);
 }
 
+TEST_CASE_METHOD(HermeticLocalTestFixture,
+                 "configuration collapsing",
+                 "[target_map]") {
+    auto repo_config = SetupConfig();
+    auto directory_entries =
+        BuildMaps::Base::CreateDirectoryEntriesMap(&repo_config);
+    auto source = BuildMaps::Base::CreateSourceTargetMap(&directory_entries,
+                                                         &repo_config);
+    auto targets_file_map =
+        BuildMaps::Base::CreateTargetsFileMap(&repo_config, 0);
+    auto rule_file_map = BuildMaps::Base::CreateRuleFileMap(&repo_config, 0);
+    static auto expressions_file_map =
+        BuildMaps::Base::CreateExpressionFileMap(&repo_config, 0);
+    auto expr_map = BuildMaps::Base::CreateExpressionMap(&expressions_file_map,
+                                                         &repo_config);
+    auto rule_map =
+        BuildMaps::Base::CreateRuleMap(&rule_file_map, &expr_map, &repo_config);
+    BuildMaps::Target::ResultTargetMap result_map{0};
+    Statistics stats{};
+    Progress exports_progress{};
+    auto absent_target_variables_map =
+        BuildMaps::Target::CreateAbsentTargetVariablesMap(0);
+    auto absent_target_map =
+        BuildMaps::Target::CreateAbsentTargetMap(&result_map,
+                                                 &absent_target_variables_map,
+                                                 &repo_config,
+                                                 &stats,
+                                                 &exports_progress,
+                                                 0);
+    auto target_map =
+        BuildMaps::Target::CreateTargetMap(&source,
+                                           &targets_file_map,
+                                           &rule_map,
+                                           &directory_entries,
+                                           &absent_target_map,
+                                           &result_map,
+                                           &repo_config,
+                                           Storage::Instance().TargetCache(),
+                                           &stats,
+                                           &exports_progress);
+
+    auto config = Configuration{Expression::FromJson(
+        R"({"foo" : "bar", "irrelevant": "ignore me"})"_json)};
+    auto alternative_config = Configuration{Expression::FromJson(
+        R"({"foo" : "bar", "irrelevant": "other value"})"_json)};
+
+    auto indirect_target = BuildMaps::Base::EntityName{
+        "", "config_targets", "indirect dependency"};
+    auto analyse = [&target_map](BuildMaps::Target::ConfiguredTarget const& key)
+        -> AnalysedTargetPtr {
+        AnalysedTargetPtr result{};
+        bool error{false};
+        {
+            TaskSystem ts;
+            target_map.ConsumeAfterKeysReady(
+                &ts,
+                {key},
+                [&result](auto values) { result = *values[0]; },
+                [&error](std::string const& /*unused*/, bool /*unused*/) {
+                    error = true;
+                });
+        }
+        CHECK(not error);
+        return result;
+    };
+
+    auto first = analyse(BuildMaps::Target::ConfiguredTarget{
+        .target = indirect_target, .config = config});
+    REQUIRE(first);
+    CHECK(stats.AnalysesCollapsedCounter() == 0);
+
+    // The second configuration only differs in a variable the target does
+    // not depend on, so the finished analysis is reused.
+    auto second = analyse(BuildMaps::Target::ConfiguredTarget{
+        .target = indirect_target, .config = alternative_config});
+    CHECK(second == first);
+    CHECK(stats.AnalysesCollapsedCounter() == 1);
+
+    Progress progress{};
+    auto analysis_result = result_map.ToResult(&stats, &progress);
+    CHECK(analysis_result.actions.size() == 1);
+}
+
 TEST_CASE_METHOD(HermeticLocalTestFixture,
                  "generator functions in string arguments",
                  "[target_map]") {
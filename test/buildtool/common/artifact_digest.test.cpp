@@ -0,0 +1,71 @@
+// Copyright 2024 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/buildtool/common/artifact_digest.hpp"
+
+#include <functional>
+#include <string>
+#include <unordered_set>
+
+#include "catch2/catch_test_macros.hpp"
+#include "src/buildtool/common/bazel_types.hpp"
+#include "src/buildtool/file_system/object_type.hpp"
+
+TEST_CASE("Hash representation", "[artifact_digest]") {
+    SECTION("Hex hashes") {
+        std::string const sha1{"e69de29bb2d1d6434b8b29ae775ad8c2e48c5391"};
+        std::string const sha256{
+            "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"};
+        CHECK(ArtifactDigest{sha1, 0, false}.hash() == sha1);
+        CHECK(ArtifactDigest{sha256, 0, false}.hash() == sha256);
+        CHECK(ArtifactDigest{}.hash().empty());
+
+        auto digest = ArtifactDigest::Create<ObjectType::File>("");
+        CHECK(ArtifactDigest{digest.hash(), 0, false} == digest);
+        // the hex string is kept, not produced on every call
+        CHECK(&digest.hash() == &digest.hash());
+    }
+
+    SECTION("Other strings are kept as given") {
+        for (std::string const hash :
+             {"known.cpp",
+              "E69DE29BB2D1D6434B8B29AE775AD8C2E48C5391",
+              "e69de29bb2d1d6434b8b29ae775ad8c2e48c539",
+              "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"
+              "00"}) {
+            CHECK(ArtifactDigest{hash, 0, false}.hash() == hash);
+        }
+    }
+}
+
+TEST_CASE("Comparison and hashing", "[artifact_digest]") {
+    auto foo = ArtifactDigest::Create<ObjectType::File>("foo");
+    auto bar = ArtifactDigest::Create<ObjectType::File>("bar");
+    auto foo_copy = ArtifactDigest{foo.hash(), foo.size(), false};
+    auto other = ArtifactDigest{"not a hash", 0, false};
+
+    CHECK(foo == foo_copy);
+    CHECK(std::hash<ArtifactDigest>{}(foo) ==
+          std::hash<ArtifactDigest>{}(foo_copy));
+    CHECK_FALSE(foo == bar);
+    CHECK_FALSE(foo == other);
+    CHECK(other == ArtifactDigest{"not a hash", 0, false});
+
+    std::unordered_set<ArtifactDigest> digests{foo, bar, foo_copy, other};
+    CHECK(digests.size() == 3);
+
+    // Round trip through the wire format
+    CHECK(ArtifactDigest{static_cast<bazel_re::Digest>(foo)} == foo);
+    CHECK(ArtifactDigest{static_cast<bazel_re::Digest>(foo)}.size() == 3);
+}
@@ -0,0 +1,130 @@
+// Copyright 2024 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/buildtool/common/binary_graph.hpp"
+
+#include <sstream>
+#include <string>
+#include <utility>  // std::move
+
+#include "catch2/catch_test_macros.hpp"
+#include "nlohmann/json.hpp"
+
+namespace {
+
+auto const kGraph = R"({
+  "actions": {
+    "0ba3bb2a7d7e9b2b7b1dd8a4b10e1c0f6cd1b4a61f37d63b6e1b3e6a2c6a2c11": {
+      "command": ["sh", "-c", "echo \"hällo\" > out"],
+      "env": {"PATH": "/bin:/usr/bin"},
+      "input": {
+        "in": { "type": "KNOWN"
+              , "data": { "id": "e69de29bb2d1d6434b8b29ae775ad8c2e48c5391"
+                        , "size": 0
+                        , "file_type": "f"}}},
+      "output": ["out"],
+      "timeout scaling": 2.5,
+      "origins": [{"target": ["@", "", "", "x"], "subtask": 0,
+                   "config": {"N": -42, "HEX": "E69DE29BB2D1D6434B8B29AE775AD8C2E48C5391"}}]
+    }
+  },
+  "blobs": ["", "blob", "0123456789"],
+  "trees": {
+    "4b825dc642cb6eb9a060e54bf8d69288fbee4904": {},
+    "abcdef0123456789abcdef0123456789abcdef012": {"x": null, "y": true}
+  }
+})"_json;
+
+}  // namespace
+
+TEST_CASE("Round trip", "[binary_graph]") {
+    auto encoded = BinaryGraph::Encode(kGraph);
+    REQUIRE(encoded);
+    CHECK(BinaryGraph::IsBinary(*encoded));
+    CHECK(encoded->size() < kGraph.dump().size());
+
+    auto decoded = BinaryGraph::Decode(*encoded);
+    REQUIRE(decoded);
+    CHECK(*decoded == kGraph);
+    CHECK(decoded->dump(2) == kGraph.dump(2));
+}
+
+TEST_CASE("Incremental reading", "[binary_graph]") {
+    std::ostringstream out{};
+    BinaryGraph::Writer writer{&out};
+    writer.BeginObject(2);
+    writer.Key("blobs");
+    writer.Value(kGraph["blobs"]);
+    writer.Key("trees");
+    writer.BeginObject(kGraph["trees"].size());
+    for (auto const& [id, tree] : kGraph["trees"].items()) {
+        writer.Key(id);
+        writer.Value(tree);
+    }
+    REQUIRE(std::move(writer).Finish());
+    auto encoded = std::move(out).str();
+
+    auto reader = BinaryGraph::Reader::Create(encoded);
+    REQUIRE(reader);
+    CHECK(reader->ReadObject() == 2);
+    CHECK(reader->ReadKey() == "blobs");
+    CHECK(reader->ReadValue() == kGraph["blobs"]);
+    CHECK(reader->ReadKey() == "trees");
+    REQUIRE(reader->ReadObject() == kGraph["trees"].size());
+    for (auto const& [id, tree] : kGraph["trees"].items()) {
+        CHECK(reader->ReadKey() == id);
+        CHECK(reader->ReadValue() == tree);
+    }
+    CHECK(reader->AtEnd());
+
+    CHECK(BinaryGraph::Decode(encoded) ==
+          nlohmann::json{{"blobs", kGraph["blobs"]},
+                         {"trees", kGraph["trees"]}});
+}
+
+TEST_CASE("Streamed writing", "[binary_graph]") {
+    constexpr std::size_t kEntries = 100000;
+    std::ostringstream out{};
+    BinaryGraph::Writer writer{&out};
+    writer.BeginArray(kEntries);
+    auto expected = nlohmann::json::array();
+    for (std::size_t i = 0; i < kEntries; ++i) {
+        auto entry = nlohmann::json{{"blob", std::to_string(i)}};
+        writer.Value(entry);
+        expected.emplace_back(std::move(entry));
+    }
+    // The encoding of the value is written before the string table is.
+    auto const written = out.str().size();
+    CHECK(written > 0);
+    REQUIRE(std::move(writer).Finish());
+    auto encoded = std::move(out).str();
+    CHECK(encoded.starts_with(BinaryGraph::kMagic));
+    CHECK(encoded.size() > written);
+
+    CHECK(BinaryGraph::Decode(encoded) == expected);
+}
+
+TEST_CASE("Malformed data", "[binary_graph]") {
+    auto encoded = BinaryGraph::Encode(kGraph);
+    REQUIRE(encoded);
+
+    CHECK_FALSE(BinaryGraph::Decode(kGraph.dump()));
+    CHECK_FALSE(BinaryGraph::Decode(encoded->substr(0, encoded->size() - 1)));
+    CHECK_FALSE(BinaryGraph::Decode(*encoded + "x"));
+    CHECK_FALSE(BinaryGraph::Decode(std::string{BinaryGraph::kMagic}));
+
+    auto reader = BinaryGraph::Reader::Create(*encoded);
+    REQUIRE(reader);
+    CHECK_FALSE(reader->ReadArray());
+}
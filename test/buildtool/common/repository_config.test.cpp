@@ -27,6 +27,7 @@
 #include "src/buildtool/common/repository_config.hpp"
 #include "src/buildtool/file_system/file_root.hpp"
 #include "src/buildtool/file_system/file_system_manager.hpp"
+#include "src/buildtool/storage/config.hpp"
 #include "src/buildtool/storage/storage.hpp"
 #include "test/utils/hermeticity/local.hpp"
 
@@ -256,3 +257,46 @@ TEST_CASE_METHOD(HermeticLocalTestFixture,
               BuildGraph({config.Info("foo")}, {{{"dep", "0"}}}));
     }
 }
+
+TEST_CASE_METHOD(HermeticLocalTestFixture,
+                 "Reuse keys of unchanged configuration",
+                 "[repository_config]") {
+    auto setup = [](RepositoryConfig* config, std::string const& tfn) {
+        config->SetInfo("foo", CreateFixedRepoInfo({{"dep", "bar"}}));
+        config->SetInfo("bar", CreateFixedRepoInfo({}, tfn));
+    };
+
+    RepositoryConfig config{};
+    setup(&config, "TARGETS");
+    auto key = config.RepositoryKey("foo");
+    REQUIRE(key);
+
+    // replace all remembered keys by the id of another blob in CAS
+    auto other = Storage::Instance().CAS().StoreBlob(std::string{"other"});
+    REQUIRE(other);
+    auto other_key = ArtifactDigest{*other}.hash();
+    std::size_t num_files{};
+    for (auto const& entry : std::filesystem::recursive_directory_iterator(
+             StorageConfig::BuildRoot() / "repository-key-map")) {
+        if (entry.is_regular_file()) {
+            REQUIRE(FileSystemManager::WriteFile(other_key, entry.path()));
+            ++num_files;
+        }
+    }
+    CHECK(num_files > 0);
+
+    SECTION("same configuration") {
+        RepositoryConfig same{};
+        setup(&same, "TARGETS");
+        CHECK(same.RepositoryKey("foo") == other_key);
+    }
+
+    SECTION("changed configuration") {
+        RepositoryConfig changed{};
+        setup(&changed, "TARGETS.changed");
+        auto changed_key = changed.RepositoryKey("foo");
+        REQUIRE(changed_key);
+        CHECK(*changed_key != other_key);
+        CHECK(*changed_key != *key);
+    }
+}
@@ -14,6 +14,7 @@
 
 #include <cstddef>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -22,6 +23,7 @@
 #include "src/buildtool/common/action_description.hpp"
 #include "src/buildtool/common/artifact_factory.hpp"
 #include "src/buildtool/common/identifier.hpp"
+#include "src/buildtool/common/tree.hpp"
 #include "src/buildtool/execution_engine/dag/dag.hpp"
 #include "test/utils/container_matchers.hpp"
 
@@ -311,3 +313,131 @@ TEST_CASE("Error when adding conflicting output files and directories",
     DependencyGraph g;
     CHECK_FALSE(g.AddAction(action_desc));
 }
+
+TEST_CASE("Nodes keep their address while the graph grows", "[dag]") {
+    constexpr std::size_t kBatches = 4;
+    constexpr std::size_t kBatchSize = 50;
+
+    DependencyGraph g;
+    std::vector<DependencyGraph::ArtifactNode const*> first_outputs{};
+    for (std::size_t batch = 0; batch < kBatches; ++batch) {
+        std::vector<ActionDescription> actions{};
+        actions.reserve(kBatchSize);
+        for (std::size_t i = 0; i < kBatchSize; ++i) {
+            auto const n = (batch * kBatchSize) + i;
+            auto const id = "action" + std::to_string(n);
+            ActionDescription::inputs_t inputs{};
+            if (n > 0) {
+                inputs.emplace(
+                    "dep",
+                    ArtifactDescription{"action" + std::to_string(n - 1),
+                                        "out"});
+            }
+            actions.emplace_back(ActionDescription{
+                {"out"}, {}, Action{id, {"touch", "out"}, {}}, inputs});
+        }
+        REQUIRE(g.Add(actions));
+        first_outputs.push_back(g.ArtifactNodeWithId(
+            ArtifactDescription{"action" + std::to_string(batch * kBatchSize),
+                                "out"}
+                .Id()));
+    }
+    CHECK(g.IsValid());
+
+    for (std::size_t batch = 0; batch < kBatches; ++batch) {
+        auto const id = "action" + std::to_string(batch * kBatchSize);
+        auto const* node = first_outputs[batch];
+        REQUIRE(node != nullptr);
+        CHECK(node == g.ArtifactNodeWithId(ArtifactDescription{id, "out"}.Id()));
+        REQUIRE(node->HasBuilderAction());
+        CHECK(node->BuilderActionNode() == g.ActionNodeWithId(id));
+        CHECK(node->BuilderActionNode()->Content().Id() == id);
+    }
+}
+
+TEST_CASE("Traversal state flags are independent", "[dag]") {
+    std::string const action_id = "id";
+    auto const action_desc = ActionDescription{
+        {"out"},
+        {},
+        Action{action_id, {"touch", "out"}, {}},
+        {{"dep", ArtifactDescription{std::filesystem::path{"dep"}, ""}}}};
+
+    DependencyGraph g;
+    REQUIRE(g.AddAction(action_desc));
+    auto const* artifact =
+        g.ArtifactNodeWithId(ArtifactDescription{action_id, "out"}.Id());
+    auto const* action = g.ActionNodeWithId(action_id);
+    REQUIRE(artifact != nullptr);
+    REQUIRE(action != nullptr);
+
+    auto* state = artifact->TraversalState();
+    state->MarkRequired();
+    CHECK(state->IsRequired());
+    CHECK_FALSE(state->IsAvailable());
+    CHECK_FALSE(state->GetAndMarkDiscovered());
+    CHECK(state->GetAndMarkDiscovered());
+    CHECK_FALSE(state->GetAndMarkQueuedToBeProcessed());
+    CHECK(state->GetAndMarkQueuedToBeProcessed());
+    state->MakeAvailable();
+    CHECK(state->IsAvailable());
+
+    auto* action_state = action->TraversalState();
+    CHECK_FALSE(action_state->IsRequired());
+    CHECK_FALSE(action_state->IsReady());
+    CHECK(action_state->NotifyAvailableDepAndCheckReady());
+    CHECK(action_state->IsReady());
+    CHECK_FALSE(action_state->GetAndMarkDiscovered());
+}
+
+TEST_CASE("Adding actions in parallel", "[dag]") {
+    constexpr std::size_t kNumActions = 2000;
+
+    std::vector<ActionDescription::Ptr> actions{};
+    actions.reserve(kNumActions + 1);
+    for (std::size_t i = 0; i < kNumActions; ++i) {
+        ActionDescription::inputs_t inputs{};
+        if (i > 0) {
+            inputs.emplace(
+                "dep",
+                ArtifactDescription{"action" + std::to_string(i / 2), "out"});
+        }
+        actions.emplace_back(std::make_shared<ActionDescription>(
+            ActionDescription::outputs_t{"out", "log"},
+            ActionDescription::outputs_t{},
+            Action{"action" + std::to_string(i), {"touch", "out", "log"}, {}},
+            inputs));
+    }
+    auto tree_inputs = ActionDescription::inputs_t{
+        {"tree", ArtifactDescription{std::string{"action0"}, "out"}}};
+    actions.emplace_back(std::make_shared<ActionDescription>(
+        Tree{std::move(tree_inputs)}.Action()));
+
+    DependencyGraph sequential;
+    REQUIRE(sequential.Add(actions));
+    DependencyGraph parallel;
+    REQUIRE(parallel.Add(actions, 4));
+    CHECK(parallel.IsValid());
+
+    CHECK(parallel.ArtifactIdentifiers() == sequential.ArtifactIdentifiers());
+    for (std::size_t i = 0; i < kNumActions; ++i) {
+        auto const action_id = "action" + std::to_string(i);
+        CheckOutputNodesCorrectlyAdded(parallel, action_id, {"out", "log"});
+        if (i > 0) {
+            CheckInputNodesCorrectlyAdded(
+                parallel,
+                action_id,
+                {ArtifactDescription{"action" + std::to_string(i / 2), "out"}
+                     .Id()});
+        }
+    }
+    auto const tree_id = actions.back()->Id();
+    REQUIRE(parallel.ActionNodeWithId(tree_id) != nullptr);
+    CHECK(parallel.ActionNodeWithId(tree_id)->OutputDirIds() ==
+          std::vector<ArtifactIdentifier>{ArtifactDescription{tree_id}.Id()});
+
+    // Failures are reported the same way as when adding sequentially
+    DependencyGraph conflicting;
+    CHECK(conflicting.Add(actions, 4));
+    CHECK_FALSE(conflicting.Add(actions, 4));
+}
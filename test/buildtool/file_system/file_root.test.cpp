@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <atomic>
 #include <cstdlib>
 #include <filesystem>
@@ -128,6 +129,16 @@ void TestFileRootReadEntries(FileRoot const& root,
         CHECK(with_symlinks == entries.ContainsBlob("bar_l"));
     }
     CHECK_FALSE(entries.ContainsBlob("does_not_exist"));
+
+    auto const& names = entries.SortedBlobNames();
+    CHECK(std::is_sorted(names.begin(), names.end()));
+    CHECK(std::binary_search(names.begin(), names.end(), "foo"));
+    CHECK(std::binary_search(names.begin(), names.end(), "bar"));
+    if (has_baz) {
+        CHECK_FALSE(std::binary_search(names.begin(), names.end(), "baz"));
+        CHECK(with_symlinks ==
+              std::binary_search(names.begin(), names.end(), "baz_l"));
+    }
 }
 
 void TestFileRootReadDirectory(FileRoot const& root, bool with_symlinks) {
@@ -371,6 +382,12 @@ TEST_CASE("Creating artifact descriptions", "[file_root]") {
               ArtifactDescription(std::filesystem::path{"baz/foo"}, "repo"));
 
         CHECK(root.ToArtifactDescription("does_not_exist", "repo"));
+
+        // Directory entries describe their blobs the same way
+        auto entries = root.ReadDirectory("baz");
+        CHECK(entries.ToArtifactDescription("baz", "foo", "repo") == desc);
+        CHECK_FALSE(
+            entries.ToArtifactDescription("baz", "does_not_exist", "repo"));
     }
 
     SECTION("git root") {
@@ -395,6 +412,13 @@ TEST_CASE("Creating artifact descriptions", "[file_root]") {
 
         CHECK_FALSE(root->ToArtifactDescription("baz", "repo"));
         CHECK_FALSE(root->ToArtifactDescription("does_not_exist", "repo"));
+
+        // Directory entries describe their blobs the same way
+        auto entries = root->ReadDirectory("baz");
+        CHECK(entries.ToArtifactDescription("baz", "foo", "repo") == foo);
+        CHECK(entries.ToArtifactDescription("baz", "bar", "repo") == bar);
+        CHECK_FALSE(root->ReadDirectory(".").ToArtifactDescription(
+            ".", "baz", "repo"));
     }
 
     SECTION("local root ignore-special") {
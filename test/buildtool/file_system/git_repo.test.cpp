@@ -355,6 +355,20 @@ TEST_CASE("Single-threaded fake repository operations -- batch 1",
             CHECK(w == kFooId);
         }
 
+        SECTION("New blobs from file") {
+            auto file_path = TestUtils::GetRepoPath() / "blob_file";
+            REQUIRE(FileSystemManager::WriteFile("foobar", file_path));
+
+            auto w = repo->WriteBlobFromFile(file_path, logger);
+            REQUIRE(w);
+            CHECK(w == repo->WriteBlob("foobar", logger));
+
+            auto r = repo->TryReadBlob(*w, logger);
+            REQUIRE(r.first);
+            REQUIRE(r.second);
+            CHECK(r.second == "foobar");
+        }
+
         SECTION("New blobs in bare repo") {
             // make blank repo
             auto repo_path = TestUtils::GetRepoPath();
@@ -18,6 +18,7 @@
 #include <optional>
 #include <string>
 #include <thread>
+#include <utility>
 #include <vector>
 
 #include "catch2/catch_test_macros.hpp"
@@ -107,6 +108,53 @@ auto const kBazId = std::string{"27b32561185c2825150893774953906c6daa6798"};
     return std::nullopt;
 }
 
+/// \brief Create a repository with many relative symlinks, all pointing into
+/// a shared directory, as in vendored environments.
+/// \returns the path of the repository and the id of its tree.
+[[nodiscard]] auto CreateTestRepoManySymlinks(int num_envs, int num_files)
+    -> std::optional<std::pair<std::filesystem::path, std::string>> {
+    auto repo_path = GetTestDir() / "test_repo_many_symlinks";
+    auto pkg_dir = std::filesystem::path{"common/lib/pkg"};
+    if (not FileSystemManager::RemoveDirectory(repo_path, true) or
+        not FileSystemManager::CreateDirectory(repo_path / pkg_dir)) {
+        return std::nullopt;
+    }
+    for (int i = 0; i < num_files; ++i) {
+        auto name = fmt::format("file{}", i);
+        if (not FileSystemManager::WriteFile(std::to_string(i),
+                                             repo_path / pkg_dir / name)) {
+            return std::nullopt;
+        }
+    }
+    for (int j = 0; j < num_envs; ++j) {
+        auto lib_dir = std::filesystem::path{fmt::format("env{}/lib", j)};
+        if (not FileSystemManager::CreateDirectory(repo_path / lib_dir)) {
+            return std::nullopt;
+        }
+        for (int i = 0; i < num_files; ++i) {
+            auto target = fmt::format("../../common/lib/pkg/file{}", i);
+            if (not FileSystemManager::CreateSymlink(
+                    target, repo_path / lib_dir / fmt::format("link{}", i))) {
+                return std::nullopt;
+            }
+        }
+    }
+    auto tree_id_file = GetTestDir() / "test_repo_many_symlinks.tree";
+    auto cmd = fmt::format(
+        "cd {} && git init > /dev/null 2>&1 && git add -A && git write-tree "
+        "> {}",
+        QuoteForShell(repo_path.string()),
+        QuoteForShell(tree_id_file.string()));
+    if (std::system(cmd.c_str()) != 0) {
+        return std::nullopt;
+    }
+    auto tree_id = FileSystemManager::ReadFile(tree_id_file);
+    if (not tree_id or tree_id->size() < 40) {
+        return std::nullopt;
+    }
+    return std::make_pair(repo_path, tree_id->substr(0, 40));
+}
+
 }  // namespace
 
 TEST_CASE("Resolve symlinks", "[resolve_symlinks_map]") {
@@ -225,3 +273,51 @@ TEST_CASE("Resolve symlinks", "[resolve_symlinks_map]") {
         CHECK(error_msg == "NONE");
     }
 }
+
+TEST_CASE("Resolve many symlinks", "[resolve_symlinks_map]") {
+    constexpr auto kNumEnvs = 20;
+    constexpr auto kNumFiles = 50;
+    auto repo = CreateTestRepoManySymlinks(kNumEnvs, kNumFiles);
+    REQUIRE(repo);
+    auto const& [repo_path, tree_id] = *repo;
+    auto cas = GitCAS::Open(repo_path);
+    REQUIRE(cas);
+
+    auto resolve_symlinks_map = CreateResolveSymlinksMap();
+    std::optional<ResolvedGitObject> resolved{};
+    auto error = false;
+    {
+        TaskSystem ts;
+        resolve_symlinks_map.ConsumeAfterKeysReady(
+            &ts,
+            {GitObjectToResolve(tree_id,
+                                ".",
+                                PragmaSpecial::ResolveCompletely,
+                                /*known_info=*/std::nullopt,
+                                cas,
+                                cas)},
+            [&resolved](auto const& values) { resolved = *values[0]; },
+            [&error](std::string const& /*unused*/, bool /*unused*/) {
+                error = true;
+            });
+    }
+    REQUIRE_FALSE(error);
+    REQUIRE(resolved);
+    CHECK(resolved->type == ObjectType::Tree);
+
+    // every link is replaced by the file it points to
+    auto git_repo = GitRepo::Open(cas);
+    REQUIRE(git_repo);
+    for (int i = 0; i < kNumFiles; ++i) {
+        auto file = git_repo->GetObjectByPathFromTree(
+            resolved->id, fmt::format("common/lib/pkg/file{}", i));
+        REQUIRE(file);
+        for (int j = 0; j < kNumEnvs; ++j) {
+            auto link = git_repo->GetObjectByPathFromTree(
+                resolved->id, fmt::format("env{}/lib/link{}", j, i));
+            REQUIRE(link);
+            CHECK(link->type == ObjectType::File);
+            CHECK(link->id == file->id);
+        }
+    }
+}
@@ -362,6 +362,73 @@ static void TestBlobsUploadedAndUsed(bool is_hermetic = true) {
     }
 }
 
+static void TestBlobsUploadedAhead(bool is_hermetic = true) {
+    TestProject p("use_uploaded_blobs");
+    auto const clargs = p.CmdLineArgs();
+
+    SetLauncher();
+    Statistics stats{};
+    Progress progress{};
+    GraphTraverser gt{clargs.gtargs,
+                      p.GetRepoConfig(),
+                      RemoteExecutionConfig::PlatformProperties(),
+                      RemoteExecutionConfig::DispatchList(),
+                      &stats,
+                      &progress};
+    CHECK_FALSE(gt.GetAheadUploadStats().uploading);
+
+    // the blobs of the graph description do not fill a batch
+    std::vector<std::string> const blobs{"test to check if blobs are uploaded",
+                                         "this"};
+    gt.UploadBlobsAhead(blobs);
+    CHECK_FALSE(gt.GetAheadUploadStats().uploading);
+
+    // a full batch starts the uploader thread
+    std::vector<std::string> filler{};
+    filler.reserve(GraphTraverser::kAheadUploadBatchSize);
+    for (std::size_t i = 0; i < GraphTraverser::kAheadUploadBatchSize; ++i) {
+        filler.emplace_back("blob uploaded ahead " + std::to_string(i));
+    }
+    gt.UploadBlobsAhead(filler);
+    CHECK(gt.GetAheadUploadStats().uploading);
+
+    auto const num_blobs = blobs.size() + filler.size();
+    using namespace std::chrono_literals;
+    for (int i = 0; i < 1000 and gt.GetAheadUploadStats().uploaded < num_blobs;
+         ++i) {
+        std::this_thread::sleep_for(10ms);
+    }
+    REQUIRE(gt.GetAheadUploadStats().uploaded == num_blobs);
+    CHECK(gt.GetAheadUploadStats().skipped == 0);
+
+    // building stops the uploader and does not upload the blobs again
+    auto const result =
+        gt.BuildAndStage(clargs.graph_description, clargs.artifacts);
+
+    REQUIRE(result);
+    REQUIRE(result->output_paths.size() == 1);
+    auto const contents =
+        FileSystemManager::ReadFile(result->output_paths.at(0));
+    CHECK(contents == "this is a test to check if blobs are uploaded");
+
+    auto const stats_after_build = gt.GetAheadUploadStats();
+    CHECK_FALSE(stats_after_build.uploading);
+    CHECK(stats_after_build.uploaded == num_blobs);
+    CHECK(stats_after_build.skipped == blobs.size());
+
+    // once stopped, blobs are no longer collected
+    gt.UploadBlobsAhead(filler);
+    CHECK_FALSE(gt.GetAheadUploadStats().uploading);
+
+    if (is_hermetic) {
+        CHECK(stats.ActionsQueuedCounter() == 1);
+        CHECK(stats.ActionsCachedCounter() == 0);
+    }
+    else {
+        CHECK(stats.ActionsQueuedCounter() >= 1);
+    }
+}
+
 static void TestEnvironmentVariablesSetAndUsed(bool is_hermetic = true) {
     TestProject p("use_env_variables");
     auto const clargs = p.CmdLineArgs();
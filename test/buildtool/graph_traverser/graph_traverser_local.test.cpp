@@ -46,6 +46,12 @@ TEST_CASE_METHOD(HermeticLocalTestFixture,
     TestBlobsUploadedAndUsed();
 }
 
+TEST_CASE_METHOD(HermeticLocalTestFixture,
+                 "Local: Blobs uploaded ahead of building",
+                 "[graph_traverser]") {
+    TestBlobsUploadedAhead();
+}
+
 TEST_CASE_METHOD(HermeticLocalTestFixture,
                  "Local: Environment variables are set and used",
                  "[graph_traverser]") {
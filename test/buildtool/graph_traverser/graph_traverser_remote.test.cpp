@@ -37,6 +37,10 @@ TEST_CASE("Remote: Blobs uploaded and correctly used", "[graph_traverser]") {
     TestBlobsUploadedAndUsed(false /* not hermetic */);
 }
 
+TEST_CASE("Remote: Blobs uploaded ahead of building", "[graph_traverser]") {
+    TestBlobsUploadedAhead(false /* not hermetic */);
+}
+
 TEST_CASE("Remote: Environment variables are set and used",
           "[graph_traverser]") {
     TestEnvironmentVariablesSetAndUsed(false /* not hermetic */);
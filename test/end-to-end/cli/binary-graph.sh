@@ -0,0 +1,63 @@
+#!/bin/sh
+# Copyright 2024 Huawei Cloud Computing Technology Co., Ltd.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+set -e
+
+TOOL=$(realpath ./bin/tool-under-test)
+CONVERT=$(realpath ./bin/convert-graph-under-test)
+BUILDROOT="${TEST_TMPDIR}/build-root"
+OUT="${TEST_TMPDIR}/out"
+mkdir -p "${OUT}"
+
+mkdir src
+cd src
+touch ROOT
+cat > TARGETS <<'EOF'
+{ "":
+  { "type": "generic"
+  , "outs": ["out.txt"]
+  , "cmds": ["cat in.txt in.txt > out.txt"]
+  , "deps": ["in.txt"]
+  }
+}
+EOF
+echo 'Hällo World' > in.txt
+
+"${TOOL}" analyse --local-build-root "${BUILDROOT}" \
+          --dump-graph "${OUT}/graph.json" \
+          --dump-graph-binary "${OUT}/graph.bin" \
+          --dump-artifacts-to-build "${OUT}/artifacts.json" 2>&1
+[ "$(head -c 6 "${OUT}/graph.bin")" = "JUSTBG" ]
+
+# Converting the binary graph gives the JSON graph
+"${CONVERT}" "${OUT}/graph.bin" "${OUT}/converted.json"
+[ "$(jq -S . "${OUT}/converted.json")" = "$(jq -S . "${OUT}/graph.json")" ]
+
+# ... and converting back gives the binary graph
+"${CONVERT}" "${OUT}/converted.json" "${OUT}/reconverted.bin"
+cmp "${OUT}/graph.bin" "${OUT}/reconverted.bin"
+
+# The binary graph can be traversed
+"${TOOL}" traverse --local-build-root "${BUILDROOT}" \
+          -g "${OUT}/graph.bin" -a "$(cat "${OUT}/artifacts.json")" \
+          -o "${OUT}/from-binary" 2>&1
+"${TOOL}" traverse --local-build-root "${BUILDROOT}" \
+          -g "${OUT}/graph.json" -a "$(cat "${OUT}/artifacts.json")" \
+          -o "${OUT}/from-json" 2>&1
+cat "${OUT}/from-binary/out.txt"
+cmp "${OUT}/from-binary/out.txt" "${OUT}/from-json/out.txt"
+[ "$(grep -c World "${OUT}/from-binary/out.txt")" -eq 2 ]
+
+echo OK
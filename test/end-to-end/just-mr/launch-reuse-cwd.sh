@@ -0,0 +1,69 @@
+#!/bin/sh
+# Copyright 2024 Huawei Cloud Computing Technology Co., Ltd.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+
+set -eu
+
+readonly JUST="${PWD}/bin/tool-under-test"
+readonly JUST_MR="${PWD}/bin/mr-tool-under-test"
+readonly LBR="${TEST_TMPDIR}/local-build-root"
+readonly LOG_DIR="${TEST_TMPDIR}/logs"
+readonly OUT="${TEST_TMPDIR}/out"
+readonly REUSE_MSG="Reusing setup configuration"
+
+mkdir -p "${LOG_DIR}"
+
+# Two workspaces, both described by the same configuration with a relative
+# file root
+for ws in a b
+do
+  mkdir -p "${ws}"
+  touch "${ws}/ROOT"
+  cat > "${ws}/TARGETS" <<EOF2
+{"": {"type": "generic", "outs": ["out.txt"], "cmds": ["echo ${ws} > out.txt"]}}
+EOF2
+done
+cat > repos.json <<'EOF2'
+{"repositories": {"": {"repository": {"type": "file", "path": "."}}}}
+EOF2
+
+# run just-mr install from the given directory
+run_install() {
+  ws="$1"
+  log="$2"
+  ( cd "${ws}"
+    "${JUST_MR}" --norc --local-build-root "${LBR}" --just "${JUST}" \
+                 -C ../repos.json -f "${log}" \
+                 install -o "${OUT}/${ws}" 2>&1
+  )
+}
+
+echo "Install from the first workspace"
+run_install a "${LOG_DIR}/a.log"
+grep -q -F "${REUSE_MSG}" "${LOG_DIR}/a.log" && exit 1 || :
+[ "$(cat "${OUT}/a/out.txt")" = "a" ]
+
+echo "Install again from the first workspace"
+rm -rf "${OUT}/a"
+run_install a "${LOG_DIR}/a-again.log"
+grep -F "${REUSE_MSG}" "${LOG_DIR}/a-again.log"
+[ "$(cat "${OUT}/a/out.txt")" = "a" ]
+
+echo "Install from the second workspace"
+run_install b "${LOG_DIR}/b.log"
+grep -q -F "${REUSE_MSG}" "${LOG_DIR}/b.log" && exit 1 || :
+[ "$(cat "${OUT}/b/out.txt")" = "b" ]
+
+echo OK
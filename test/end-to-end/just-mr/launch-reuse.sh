@@ -0,0 +1,99 @@
+#!/bin/sh
+# Copyright 2024 Huawei Cloud Computing Technology Co., Ltd.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+
+set -eu
+
+readonly JUST="${PWD}/bin/tool-under-test"
+readonly JUST_MR="${PWD}/bin/mr-tool-under-test"
+readonly DISTDIR="${TEST_TMPDIR}/distfiles"
+readonly LBR="${TEST_TMPDIR}/local-build-root"
+readonly LOG_DIR="${TEST_TMPDIR}/logs"
+readonly REUSE_MSG="Reusing setup configuration"
+
+mkdir -p "${DISTDIR}" "${LOG_DIR}"
+
+# Set up sample archive
+mkdir -p foo
+cat > foo/TARGETS <<'EOF2'
+{"data": {"type": "generic", "outs": ["data.txt"], "cmds": ["echo foo > data.txt"]}}
+EOF2
+tar cf "${DISTDIR}/foo-1.2.3.tar" foo 2>&1
+foocontent=$(git hash-object "${DISTDIR}/foo-1.2.3.tar")
+rm -rf foo
+
+# Setup sample repository config
+touch ROOT
+cat > repos.json <<EOF2
+{ "repositories":
+  { "foo":
+    { "repository":
+      { "type": "archive"
+      , "content": "${foocontent}"
+      , "fetch": "http://non-existent.example.org/foo-1.2.3.tar"
+      , "subdir": "foo"
+      }
+    }
+  , "":
+    { "repository": {"type": "file", "path": "."}
+    , "bindings": {"foo": "foo"}
+    }
+  }
+}
+EOF2
+cat > TARGETS <<'EOF2'
+{"": {"type": "install", "deps": [["@", "foo", "", "data"]]}}
+EOF2
+
+now_ms() {
+  echo $(( $(date +%s%N) / 1000000 ))
+}
+
+# run just-mr build, reporting its wall time
+run_build() {
+  log="$1"
+  shift
+  start=$(now_ms)
+  "${JUST_MR}" --norc --local-build-root "${LBR}" --just "${JUST}" \
+               --distdir "${DISTDIR}" -f "${log}" "$@" build 2>&1
+  end=$(now_ms)
+  echo "just-mr build took $(( end - start ))ms"
+}
+
+echo "First build, full setup"
+run_build "${LOG_DIR}/first.log"
+grep -q -F "${REUSE_MSG}" "${LOG_DIR}/first.log" && exit 1 || :
+
+echo "Second build, unchanged inputs"
+run_build "${LOG_DIR}/second.log"
+grep -F "${REUSE_MSG}" "${LOG_DIR}/second.log"
+
+echo "Third build, changed effective arguments"
+run_build "${LOG_DIR}/third.log" --main ""
+grep -q -F "${REUSE_MSG}" "${LOG_DIR}/third.log" && exit 1 || :
+
+echo "Fourth build, changed repository configuration"
+sed -i 's|"path": "."|"path": "./"|' repos.json
+run_build "${LOG_DIR}/fourth.log"
+grep -q -F "${REUSE_MSG}" "${LOG_DIR}/fourth.log" && exit 1 || :
+
+echo "Fifth build, after removing the Git cache"
+run_build "${LOG_DIR}/fifth-pre.log"
+grep -F "${REUSE_MSG}" "${LOG_DIR}/fifth-pre.log"
+rm -rf "${LBR}/git"
+run_build "${LOG_DIR}/fifth.log"
+grep -q -F "${REUSE_MSG}" "${LOG_DIR}/fifth.log" && exit 1 || :
+
+echo OK
@@ -0,0 +1,91 @@
+#!/bin/sh
+# Copyright 2024 Huawei Cloud Computing Technology Co., Ltd.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+
+set -eu
+
+readonly JUST_MR="${PWD}/bin/mr-tool-under-test"
+readonly DISTDIR="${TEST_TMPDIR}/distfiles"
+readonly LBR="${TEST_TMPDIR}/local-build-root"
+
+mkdir -p "${DISTDIR}"
+mkdir -p foo/bar
+echo "test data" > foo/bar/data.txt
+tar cf "${TEST_TMPDIR}/foo-1.2.3.tar" foo 2>&1
+cp "${TEST_TMPDIR}/foo-1.2.3.tar" "${DISTDIR}/foo-1.2.3.tar"
+foocontent=$(git hash-object "${DISTDIR}/foo-1.2.3.tar")
+echo "Foo archive has content ${foocontent}"
+
+# get the tree identifiers for later sanity check
+cd foo
+git init
+git config user.name 'N.O.Body'
+git config user.email 'nobody@example.org'
+git add -f .
+git commit -m 'Just care about the tree' 2>&1
+tree_id=$(git log -n 1 --format='%T')
+subtree_id=$(git rev-parse HEAD:bar)
+cd ..
+rm -rf foo
+echo "foo as tree ${tree_id}, foo/bar as tree ${subtree_id}"
+
+# Setup sample repository config
+touch ROOT
+cat > repos.json <<EOF2
+{ "repositories":
+  { "foo":
+    { "repository":
+      { "type": "archive"
+      , "content": "${foocontent}"
+      , "fetch": "http://non-existent.example.org/foo-1.2.3.tar"
+      , "subdir": "foo"
+      }
+    }
+  , "":
+    { "repository": {"type": "file", "path": "."}
+    , "bindings": {"foo": "foo"}
+    }
+  }
+}
+EOF2
+echo "Repository configuration:"
+cat repos.json
+
+# Call just-mr with distdir present
+FIRST_CONFIG=$("${JUST_MR}" --norc --local-build-root "${LBR}" \
+                 --distdir "${DISTDIR}" setup)
+cat "${FIRST_CONFIG}"
+[ $(jq '."repositories"."foo"."workspace_root" | .[1]' "${FIRST_CONFIG}") = "\"${tree_id}\"" ]
+
+# The set-up root has to be remembered
+[ -n "$(ls -A "${LBR}/repo-setup-map")" ]
+
+# Remove CAS, distfiles, and the archive-specific tree map; as the description
+# is unchanged, the remembered root has to be reused
+rm -rf "${LBR}/protocol-dependent" "${LBR}/tree-map"
+rm -rf "${DISTDIR}"
+SECOND_CONFIG=$("${JUST_MR}" --norc --local-build-root "${LBR}" setup)
+[ "${FIRST_CONFIG}" = "${SECOND_CONFIG}" ]
+
+# A changed description must not reuse the previous root
+sed -i 's|"subdir": "foo"|"subdir": "foo/bar"|' repos.json
+mkdir -p "${DISTDIR}"
+cp "${TEST_TMPDIR}/foo-1.2.3.tar" "${DISTDIR}/foo-1.2.3.tar"
+THIRD_CONFIG=$("${JUST_MR}" --norc --local-build-root "${LBR}" \
+                 --distdir "${DISTDIR}" setup)
+cat "${THIRD_CONFIG}"
+[ $(jq '."repositories"."foo"."workspace_root" | .[1]' "${THIRD_CONFIG}") = "\"${subtree_id}\"" ]
+
+echo OK
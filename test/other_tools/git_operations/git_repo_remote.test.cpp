@@ -19,6 +19,7 @@
 #include <optional>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "catch2/catch_test_macros.hpp"
 #include "fmt/core.h"
@@ -290,6 +291,84 @@ TEST_CASE("Single-threaded fake repository operations", "[git_repo_remote]") {
         REQUIRE(fetched_commit);
         CHECK(*fetched_commit == kRootCommit);
     }
+
+    SECTION("Update commits of several branches from one remote") {
+        // do a single remote ls for all branches; no tmp repository needed
+        auto fetched_commits = repo->UpdateCommits(
+            *repo_path, {"master", "master"}, {}, "git", {}, logger);
+
+        REQUIRE(fetched_commits);
+        REQUIRE(fetched_commits->size() == 2);
+        CHECK(fetched_commits->at(0) == kRootCommit);
+        CHECK(fetched_commits->at(1) == kRootCommit);
+
+        // unknown branches are reported as failure
+        CHECK_FALSE(repo->UpdateCommits(
+            *repo_path, {"master", "no-such-branch"}, {}, "git", {}, logger));
+    }
+}
+
+TEST_CASE("Parse ls-remote output", "[git_repo_remote]") {
+    // output of a single shelled-out ls-remote query for several branches
+    auto const output = std::string{
+        "1111111111111111111111111111111111111111\tHEAD\n"
+        "2222222222222222222222222222222222222222\trefs/heads/notmaster\n"
+        "3333333333333333333333333333333333333333\trefs/heads/master\n"
+        "4444444444444444444444444444444444444444\trefs/heads/feature/x\n"
+        "\n"
+        "5555555555555555555555555555555555555555\trefs/heads/x\n"
+        "6666666666666666666666666666666666666666\trefs/tags/v1.0\n"};
+
+    bool failed{};
+    auto logger = std::make_shared<GitRepoRemote::anon_logger_t>(
+        [&failed](auto const& msg, bool fatal) {
+            Logger::Log(fatal ? LogLevel::Error : LogLevel::Progress,
+                        std::string(msg));
+            failed = failed or fatal;
+        });
+
+    SECTION("Distinct branches") {
+        auto commits = GitRepoRemote::ParseLsRemoteOutput(
+            output,
+            {"master", "v1.0", "refs/heads/x", "HEAD", "feature/x"},
+            logger);
+        REQUIRE(commits);
+        CHECK(*commits ==
+              std::vector<std::string>{
+                  "3333333333333333333333333333333333333333",
+                  "6666666666666666666666666666666666666666",
+                  "5555555555555555555555555555555555555555",
+                  "1111111111111111111111111111111111111111",
+                  "4444444444444444444444444444444444444444"});
+        CHECK_FALSE(failed);
+    }
+
+    SECTION("First matching reference") {
+        // "x" is a path tail of both refs/heads/feature/x and refs/heads/x
+        auto commits =
+            GitRepoRemote::ParseLsRemoteOutput(output, {"x", "x"}, logger);
+        REQUIRE(commits);
+        CHECK(*commits ==
+              std::vector<std::string>{
+                  "4444444444444444444444444444444444444444",
+                  "4444444444444444444444444444444444444444"});
+        CHECK_FALSE(failed);
+    }
+
+    SECTION("Unlisted branch") {
+        // only full path components match
+        CHECK_FALSE(GitRepoRemote::ParseLsRemoteOutput(
+            output, {"master", "aster"}, logger));
+        CHECK(failed);
+    }
+
+    SECTION("Malformed output") {
+        CHECK_FALSE(GitRepoRemote::ParseLsRemoteOutput(
+            output + "7777777777777777777777777777777777777777 refs/heads/y\n",
+            {"master"},
+            logger));
+        CHECK(failed);
+    }
 }
 
 TEST_CASE("Multi-threaded fake repository operations", "[git_repo_remote]") {
@@ -0,0 +1,134 @@
+// Copyright 2023 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/other_tools/just_mr/fetch_order.hpp"
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "catch2/catch_test_macros.hpp"
+#include "src/buildtool/crypto/hash_function.hpp"
+#include "src/buildtool/file_system/file_system_manager.hpp"
+#include "src/buildtool/storage/fs_utils.hpp"
+#include "src/buildtool/storage/storage.hpp"
+#include "test/utils/hermeticity/local.hpp"
+
+namespace {
+
+[[nodiscard]] auto Archives(std::vector<std::string> const& contents)
+    -> std::vector<ArchiveContent> {
+    std::vector<ArchiveContent> archives{};
+    archives.reserve(contents.size());
+    for (auto const& content : contents) {
+        archives.emplace_back(ArchiveContent{.content = content});
+    }
+    return archives;
+}
+
+[[nodiscard]] auto Contents(std::vector<ArchiveContent> const& archives)
+    -> std::vector<std::string> {
+    std::vector<std::string> contents{};
+    contents.reserve(archives.size());
+    for (auto const& archive : archives) {
+        contents.emplace_back(archive.content);
+    }
+    return contents;
+}
+
+}  // namespace
+
+TEST_CASE("Archives are ordered largest first", "[fetch_order]") {
+    std::map<std::string, std::uintmax_t> const sizes{
+        {"small", 10}, {"medium", 100}, {"large", 1000}, {"other_small", 10}};
+    auto size_of = [&sizes](std::string const& content)
+        -> std::optional<std::uintmax_t> {
+        if (auto it = sizes.find(content); it != sizes.end()) {
+            return it->second;
+        }
+        return std::nullopt;
+    };
+
+    SECTION("known sizes") {
+        auto archives = Archives({"small", "large", "other_small", "medium"});
+        JustMR::Utils::SortLargestFirst(&archives, size_of);
+        CHECK(Contents(archives) ==
+              std::vector<std::string>{
+                  "large", "medium", "small", "other_small"});
+    }
+
+    SECTION("unknown sizes keep their order after known ones") {
+        auto archives =
+            Archives({"unknown_b", "small", "unknown_a", "large", "unknown_c"});
+        JustMR::Utils::SortLargestFirst(&archives, size_of);
+        CHECK(Contents(archives) ==
+              std::vector<std::string>{
+                  "large", "small", "unknown_b", "unknown_a", "unknown_c"});
+    }
+
+    SECTION("sizes are queried once per content") {
+        std::map<std::string, int> queries{};
+        auto archives = Archives({"small", "large", "small", "medium"});
+        JustMR::Utils::SortLargestFirst(
+            &archives, [&](std::string const& content) {
+                ++queries[content];
+                return size_of(content);
+            });
+        CHECK(Contents(archives) ==
+              std::vector<std::string>{"large", "medium", "small", "small"});
+        CHECK(queries == std::map<std::string, int>{
+                             {"large", 1}, {"medium", 1}, {"small", 1}});
+    }
+}
+
+TEST_CASE_METHOD(HermeticLocalTestFixture,
+                 "Known content sizes",
+                 "[fetch_order]") {
+    std::string const in_cas(42, 'x');  // NOLINT
+    auto cas_content = HashFunction::ComputeBlobHash(in_cas).HexString();
+    REQUIRE(Storage::Instance().CAS().StoreBlob(in_cas));
+
+    auto recorded = HashFunction::ComputeBlobHash("recorded").HexString();
+    REQUIRE(StorageUtils::WriteTreeIDFile(
+        StorageUtils::GetContentSizeFile(recorded), "4096"));
+
+    auto malformed = HashFunction::ComputeBlobHash("malformed").HexString();
+    REQUIRE(StorageUtils::WriteTreeIDFile(
+        StorageUtils::GetContentSizeFile(malformed), "many bytes"));
+
+    auto unknown = HashFunction::ComputeBlobHash("unknown").HexString();
+
+    SECTION("sizes from CAS and from size records") {
+        CHECK(JustMR::Utils::KnownContentSize(cas_content) == 42);
+        CHECK(JustMR::Utils::KnownContentSize(recorded) == 4096);
+        CHECK_FALSE(JustMR::Utils::KnownContentSize(malformed));
+        CHECK_FALSE(JustMR::Utils::KnownContentSize(unknown));
+    }
+
+    SECTION("CAS takes precedence over size records") {
+        REQUIRE(StorageUtils::WriteTreeIDFile(
+            StorageUtils::GetContentSizeFile(cas_content), "1"));
+        CHECK(JustMR::Utils::KnownContentSize(cas_content) == 42);
+    }
+
+    SECTION("ordering by known sizes") {
+        auto archives = Archives({unknown, cas_content, malformed, recorded});
+        JustMR::Utils::SortLargestFirst(&archives);
+        CHECK(Contents(archives) ==
+              std::vector<std::string>{
+                  recorded, cas_content, unknown, malformed});
+    }
+}
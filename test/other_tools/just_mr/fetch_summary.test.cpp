@@ -0,0 +1,76 @@
+// Copyright 2023 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "catch2/catch_test_macros.hpp"
+#include "src/other_tools/just_mr/progress_reporting/progress_reporter.hpp"
+#include "src/other_tools/just_mr/progress_reporting/statistics.hpp"
+
+TEST_CASE("Fetched bytes are accounted per mirror", "[fetch_summary]") {
+    auto& stats = JustMRStatistics::Instance();
+    stats.Reset();
+    CHECK(stats.FetchedBytes().empty());
+
+    SECTION("sequential transfers") {
+        stats.AddFetchedBytes("mirror.example.org", 100);  // NOLINT
+        stats.AddFetchedBytes("origin.example.org", 7);    // NOLINT
+        stats.AddFetchedBytes("mirror.example.org", 23);   // NOLINT
+        CHECK(stats.FetchedBytes() ==
+              std::map<std::string, std::size_t>{{"mirror.example.org", 123},
+                                                 {"origin.example.org", 7}});
+    }
+
+    SECTION("concurrent transfers") {
+        constexpr std::size_t kThreads{8};
+        constexpr std::size_t kTransfers{1000};
+        std::vector<std::thread> threads{};
+        threads.reserve(kThreads);
+        for (std::size_t t{}; t < kThreads; ++t) {
+            threads.emplace_back([&stats, t]() {
+                for (std::size_t i{}; i < kTransfers; ++i) {
+                    stats.AddFetchedBytes(t % 2 == 0 ? "even" : "odd", 2);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        CHECK(stats.FetchedBytes() == std::map<std::string, std::size_t>{
+                                          {"even", kThreads * kTransfers},
+                                          {"odd", kThreads * kTransfers}});
+    }
+
+    stats.Reset();
+    CHECK(stats.FetchedBytes().empty());
+}
+
+TEST_CASE("Byte counts are formatted for the summary", "[fetch_summary]") {
+    CHECK(JustMRProgressReporter::FormatBytes(0) == "0 B");
+    CHECK(JustMRProgressReporter::FormatBytes(1023) == "1023 B");  // NOLINT
+    CHECK(JustMRProgressReporter::FormatBytes(1024) == "1.0 KiB");  // NOLINT
+    CHECK(JustMRProgressReporter::FormatBytes(1536) == "1.5 KiB");  // NOLINT
+    CHECK(JustMRProgressReporter::FormatBytes(5UL << 20U) ==  // NOLINT
+          "5.0 MiB");
+    CHECK(JustMRProgressReporter::FormatBytes(3UL << 30U) ==  // NOLINT
+          "3.0 GiB");
+    CHECK(JustMRProgressReporter::FormatBytes(2048UL << 30U) ==  // NOLINT
+          "2.0 TiB");
+    CHECK(JustMRProgressReporter::FormatBytes(4UL << 50U) ==  // NOLINT
+          "4096.0 TiB");
+}
@@ -0,0 +1,54 @@
+// Copyright 2024 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/utils/cpp/glob_pattern.hpp"
+
+#include <fnmatch.h>
+
+#include <string>
+#include <vector>
+
+#include "catch2/catch_test_macros.hpp"
+
+TEST_CASE("Literal prefix", "[glob_pattern]") {
+    CHECK(GlobPattern{"foo.txt"}.Prefix() == "foo.txt");
+    CHECK(GlobPattern{"foo*.txt"}.Prefix() == "foo");
+    CHECK(GlobPattern{"foo?.txt"}.Prefix() == "foo");
+    CHECK(GlobPattern{"foo[ab].txt"}.Prefix() == "foo");
+    CHECK(GlobPattern{"*.txt"}.Prefix().empty());
+    CHECK(GlobPattern{R"(f\*o*)"}.Prefix() == "f*o");
+}
+
+TEST_CASE("Matching agrees with fnmatch", "[glob_pattern]") {
+    std::vector<std::string> const patterns{
+        "", "*", "foo", "foo*", "*.txt", "f*.txt", "f*o*.txt", "f?o.txt", "*o?",
+        "[fb]oo", "[!f]*", "foo[].txt", "foo[.txt", "x\\*y", "x\\?y*", "x\\",
+        "\\[a]", "a*a", "*.*", ".*", "foo.txt", "fo\\o.txt", "**", "f**t",
+        "[*]*"};
+    std::vector<std::string> const names{
+        "", "foo", "foo.txt", "fo.txt", "f.txt", "foo.c", "boo", "zoo", "x*y",
+        "x?y", "xzy", "x?yz", "x\\", "[a]", "a", "aa", "aba", ".hidden", "foo]",
+        "*star", "foo[.txt", "foo].txt", "ft", "fast"};
+    for (auto const& pattern : patterns) {
+        auto glob = GlobPattern{pattern};
+        for (auto const& name : names) {
+            INFO("pattern " << pattern << ", name " << name);
+            auto expected = fnmatch(pattern.c_str(), name.c_str(), 0) == 0;
+            CHECK(glob.Matches(name) == expected);
+            if (expected) {
+                CHECK(name.starts_with(glob.Prefix()));
+            }
+        }
+    }
+}
@@ -0,0 +1,116 @@
+// Copyright 2024 Huawei Cloud Computing Technology Co., Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "catch2/catch_test_macros.hpp"
+#include "nlohmann/json.hpp"
+#include "src/utils/cpp/lazy_json.hpp"
+
+TEST_CASE("Lazy object entries", "[lazy_json]") {
+    auto const text = std::string{R"( {"a": 1, "b" :[true, {"x": null}],
+        "c": {"y": "}\"{"}, "d":-2.5e3,"e": "s", "a": {}, "f": 42})"};
+    auto obj = LazyJsonObject::Parse(text);
+    REQUIRE(obj);
+    CHECK(obj->Size() == 6);
+    CHECK(obj->Keys() ==
+          std::vector<std::string>{"a", "b", "c", "d", "e", "f"});
+    CHECK(obj->Contains("c"));
+    CHECK_FALSE(obj->Contains("x"));
+    CHECK(obj->Find("x") == nullptr);
+
+    // entries agree with the document, including duplicate keys
+    auto json = nlohmann::json::parse(text);
+    for (auto const& key : obj->Keys()) {
+        auto const* value = obj->Find(key);
+        REQUIRE(value != nullptr);
+        CHECK(*value == json[key]);
+        CHECK(obj->Find(key) == value);  // parsed once
+    }
+    CHECK(obj->ToJson() == json);
+
+    // copies share the parsed entries
+    auto copy = *obj;
+    CHECK(copy.Find("b") == obj->Find("b"));
+}
+
+TEST_CASE("Lazy object validation", "[lazy_json]") {
+    CHECK(LazyJsonObject{}.Empty());
+    CHECK(LazyJsonObject{}.ToJson() == nlohmann::json::object());
+    REQUIRE(LazyJsonObject::Parse("{}"));
+    CHECK(LazyJsonObject::Parse("{}")->Empty());
+
+    CHECK_FALSE(LazyJsonObject::Parse("[1, 2]"));
+    CHECK_FALSE(LazyJsonObject::Parse("\"foo\""));
+    CHECK_FALSE(LazyJsonObject::Parse("12"));
+
+    // values not looked up are validated nevertheless
+    CHECK_THROWS(LazyJsonObject::Parse(R"({"a": 1, "b": [1,]})"));
+    CHECK_THROWS(LazyJsonObject::Parse(R"({"a": 1} [])"));
+    CHECK_THROWS(LazyJsonObject::Parse(R"({"a": 1)"));
+}
+
+TEST_CASE("Read JSON members", "[lazy_json]") {
+    auto const text = std::string{R"({"blobs": ["x", "y"], "actions":
+        {"a": {"cmd": ["true"]}, "b": {"cmd": []}}, "n": 3, "e": {}})"};
+    auto read = [](auto& input, std::size_t depth) {
+        std::vector<std::pair<std::vector<std::string>, nlohmann::json>>
+            values{};
+        auto complete = ReadJsonMembers(
+            input, depth, [&values](auto const& keys, auto&& value) {
+                values.emplace_back(keys, std::move(value));
+                return true;
+            });
+        CHECK(complete);
+        return values;
+    };
+    using Keys = std::vector<std::string>;
+
+    SECTION("Descending into nested objects") {
+        auto values = read(text, 2);
+        REQUIRE(values.size() == 5);
+        CHECK(values[0].first == Keys{"blobs"});
+        CHECK(values[0].second == nlohmann::json{"x", "y"});
+        CHECK(values[1].first == Keys{"actions", "a"});
+        CHECK(values[1].second == nlohmann::json::parse(R"({"cmd":["true"]})"));
+        CHECK(values[2].first == Keys{"actions", "b"});
+        CHECK(values[3].first == Keys{"n"});
+        CHECK(values[3].second == 3);
+        CHECK(values[4].first == Keys{"e"});
+        CHECK(values[4].second == nlohmann::json::object());
+    }
+
+    SECTION("Top-level members from a stream") {
+        auto stream = std::istringstream{text};
+        auto values = read(stream, 1);
+        REQUIRE(values.size() == 4);
+        CHECK(values[1].first == Keys{"actions"});
+        CHECK(values[1].second == nlohmann::json::parse(text)["actions"]);
+    }
+
+    SECTION("Stopping and invalid input") {
+        std::size_t count{};
+        CHECK_FALSE(ReadJsonMembers(text, 2, [&count](auto&&, auto&&) {
+            return ++count < 2;
+        }));
+        CHECK(count == 2);
+        auto any = [](auto&&, auto&&) { return true; };
+        CHECK_FALSE(ReadJsonMembers("[1]", 2, any));
+        CHECK_FALSE(ReadJsonMembers("null", 2, any));
+        CHECK_THROWS(ReadJsonMembers(R"({"a": {"b": [}})", 2, any));
+    }
+}